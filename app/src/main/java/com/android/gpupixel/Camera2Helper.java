@@ -49,6 +49,8 @@ public class Camera2Helper {
     private Semaphore mCameraOpenCloseLock = new Semaphore(1);
     private int mSensorOrientation;
     private FrameCallback mFrameCallback;
+    // Reused for every frame, the callback consumes it synchronously
+    private byte[] mRgbaBuffer;
 
     private boolean mIsCameraOpened = false;
 
@@ -297,9 +299,9 @@ public class Camera2Helper {
 
                         if (mFrameCallback != null) {
                             // Use GPUPixel for format conversion
-                            byte[] rgbaData = GPUPixel.YUV_420_888toRGBA(image);
+                            mRgbaBuffer = GPUPixel.YUV_420_888toRGBA(image, mRgbaBuffer);
                             mFrameCallback.onFrameAvailable(
-                                    rgbaData, image.getWidth(), image.getHeight());
+                                    mRgbaBuffer, image.getWidth(), image.getHeight());
                         }
                     } catch (Exception e) {
                         Log.e(TAG, "Failed to process image", e);
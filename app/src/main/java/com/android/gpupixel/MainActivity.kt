@@ -21,6 +21,7 @@ import com.pixpark.gpupixel.GPUPixel
 import com.pixpark.gpupixel.GPUPixelFilter
 import com.pixpark.gpupixel.GPUPixelSinkRawData
 import com.pixpark.gpupixel.GPUPixelSourceRawData
+import java.nio.ByteBuffer
 
 
 class MainActivity : AppCompatActivity() {
@@ -32,9 +33,10 @@ class MainActivity : AppCompatActivity() {
     private var mSourceRawData: GPUPixelSourceRawData? = null
     private var mBeautyFilter: GPUPixelFilter? = null
     private var mFaceReshapeFilter: GPUPixelFilter? = null
-    private var mLipstickFilter: GPUPixelFilter? = null
+    private var mMakeupFilter: GPUPixelFilter? = null
     private var mFaceDetector: FaceDetector? = null
     private var mSinkRawData: GPUPixelSinkRawData? = null
+    private var mOutputBuffer: ByteBuffer? = null
 
     private var mSmoothSeekbar: SeekBar? = null
     private var mWhitenessSeekbar: SeekBar? = null
@@ -132,7 +134,7 @@ class MainActivity : AppCompatActivity() {
         lipstickSeekbar = binding.lipstickSeekbar
         lipstickSeekbar?.setOnSeekBarChangeListener(object : OnSeekBarChangeListener {
             override fun onProgressChanged(seekBar: SeekBar, progress: Int, fromUser: Boolean) {
-                mLipstickFilter?.SetProperty("blend_level", progress / 10.0f)
+                mMakeupFilter?.SetProperty("lipstick_level", progress / 10.0f)
             }
 
             override fun onStartTrackingTouch(seekBar: SeekBar) {}
@@ -151,13 +153,15 @@ class MainActivity : AppCompatActivity() {
         // Create filters
         mBeautyFilter = GPUPixelFilter.Create(GPUPixelFilter.BEAUTY_FACE_FILTER)
         mFaceReshapeFilter = GPUPixelFilter.Create(GPUPixelFilter.FACE_RESHAPE_FILTER)
-        mLipstickFilter = GPUPixelFilter.Create(GPUPixelFilter.LIPSTICK_FILTER)
+        mMakeupFilter = GPUPixelFilter.Create(GPUPixelFilter.FACE_MAKEUP_LAYERS_FILTER)
 
         // Create output sink
         mSinkRawData = GPUPixelSinkRawData.Create()
 
         // Initialize face detection
         mFaceDetector = FaceDetector.Create()
+        mFaceDetector?.setDetectSize(480)
+        mFaceDetector?.setMaxFaces(4)
 
         // Set camera frame callback
         mCamera2Helper?.setFrameCallback(Camera2Helper.FrameCallback { rgbaData, width, height ->
@@ -172,49 +176,45 @@ class MainActivity : AppCompatActivity() {
                 this@MainActivity, sensorOrientation, isFrontCamera
             )
 
-            // Rotate RGBA data using GPUPixel
-            val rotatedData = GPUPixel.rotateRgbaImage(rgbaData, width, height, rotation)
-
-            // Width and height may be swapped after rotation
-            val outWidth = if ((rotation == 90 || rotation == 270)) height else width
-            val outHeight = if ((rotation == 90 || rotation == 270)) width else height
-
-            // Perform face detection (using rotated data)
-            val landmarks = mFaceDetector?.detect(
-                rotatedData, outWidth, outHeight,
-                outWidth * 4, FaceDetector.GPUPIXEL_MODE_FMT_VIDEO,
-                FaceDetector.GPUPIXEL_FRAME_TYPE_RGBA
+            // Detect in the background on the unrotated frame, the detector
+            // downscales and rotates internally and returns upright landmarks
+            val timestampUs = System.nanoTime() / 1000
+            mFaceDetector?.detectAsync(
+                rgbaData, width, height,
+                width * 4, FaceDetector.GPUPIXEL_MODE_FMT_VIDEO,
+                FaceDetector.GPUPIXEL_FRAME_TYPE_RGBA, rotation, timestampUs
+            )
+            // Share the newest landmarks with the face filters natively
+            mFaceDetector?.applyLandmarksAt(
+                timestampUs, mFaceReshapeFilter, mMakeupFilter
             )
 
-            if (landmarks != null && landmarks.size > 0) {
-                Log.d(TAG, "Face landmarks detected: " + landmarks.size)
-                mFaceReshapeFilter?.SetProperty("face_landmark", landmarks)
-                mLipstickFilter?.SetProperty("face_landmark", landmarks)
-            }
-
-            // Process the rotated RGBA data with GPUPixelSourceRawData
+            // Upload the camera frame as-is, rotation is applied on the GPU
             mSourceRawData?.ProcessData(
-                rotatedData, outWidth, outHeight, outWidth * 4,
-                GPUPixelSourceRawData.FRAME_TYPE_RGBA
+                rgbaData, width, height, width * 4,
+                GPUPixelSourceRawData.FRAME_TYPE_RGBA, rotation, false
             )
 
-            // Get processed RGBA data
-            val processedRgba = mSinkRawData?.GetRgbaBuffer()
+            // Read the processed frame into a reused direct buffer
+            val rgbaWidth = mSinkRawData?.GetWidth() ?: 0
+            val rgbaHeight = mSinkRawData?.GetHeight() ?: 0
+            val outputSize = rgbaWidth * rgbaHeight * 4
+            if (mOutputBuffer == null || mOutputBuffer!!.capacity() != outputSize) {
+                mOutputBuffer = ByteBuffer.allocateDirect(outputSize)
+            }
 
             // Set texture data and request redraw
-            if (processedRgba != null && mRenderer != null) {
-                val rgbaWidth = mSinkRawData?.GetWidth()
-                val rgbaHeight = mSinkRawData?.GetHeight()
-
-                mRenderer?.updateTextureData(processedRgba, rgbaWidth!!, rgbaHeight!!, 0)
+            if (outputSize > 0 && mRenderer != null &&
+                mSinkRawData!!.ReadRgbaInto(mOutputBuffer, 0)) {
+                mRenderer?.updateTextureData(mOutputBuffer!!, rgbaWidth, rgbaHeight, 0)
 
                 // Request GLSurfaceView to redraw
                 mGLSurfaceView!!.requestRender()
             }
         })
 
-        mSourceRawData?.AddSink(mLipstickFilter)
-        mLipstickFilter?.AddSink(mBeautyFilter)
+        mSourceRawData?.AddSink(mMakeupFilter)
+        mMakeupFilter?.AddSink(mBeautyFilter)
         mBeautyFilter?.AddSink(mFaceReshapeFilter)
         mFaceReshapeFilter?.AddSink(mSinkRawData)
 
@@ -295,9 +295,9 @@ class MainActivity : AppCompatActivity() {
         }
 
         // Release GPUPixel resources
-        if (mLipstickFilter != null) {
-            mLipstickFilter!!.Destroy()
-            mLipstickFilter = null
+        if (mMakeupFilter != null) {
+            mMakeupFilter!!.Destroy()
+            mMakeupFilter = null
         }
 
         if (mSourceRawData != null) {
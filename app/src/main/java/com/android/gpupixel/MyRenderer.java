@@ -301,6 +301,10 @@ class MyRenderer implements GLSurfaceView.Renderer {
 
     // Update texture data and handle rotation
     public void updateTextureData(byte[] data, int width, int height, int sensorOrientation) {
+        updateTextureData(ByteBuffer.wrap(data), width, height, sensorOrientation);
+    }
+
+    public void updateTextureData(ByteBuffer data, int width, int height, int sensorOrientation) {
         synchronized (mLock) {
             boolean sizeChanged = (mTextureWidth != width || mTextureHeight != height);
 
@@ -312,6 +316,8 @@ class MyRenderer implements GLSurfaceView.Renderer {
             }
 
             mTextureData.clear();
+            data.position(0);
+            data.limit(width * height * 4);
             mTextureData.put(data);
             mTextureData.position(0);
             mTextureNeedsUpdate = true;
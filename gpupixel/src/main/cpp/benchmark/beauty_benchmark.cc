@@ -0,0 +1,148 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+// Runs BeautyFaceFilter skin smoothing with the box high pass and the guided
+// filter engine, and BilateralFilter next to them, over a synthetic noisy
+// RGBA frame. Reports the time each adds to an unfiltered upload and
+// readback, how much of the noise is removed inside flat patches and how far
+// the pixels next to hard edges move.
+//
+//   gpupixel_beauty_benchmark [width] [height] [frames]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "benchmark/pipeline_benchmark.h"
+#include "gpupixel/gpupixel.h"
+
+namespace {
+
+const int kPatchSize = 64;
+
+// Standard deviation of the red channel inside the patches, away from the
+// edges, and the mean change of the pixels right next to an edge
+void Measure(const std::vector<uint8_t>& input,
+             const std::vector<uint8_t>& output,
+             int width,
+             int height,
+             double* flat_noise,
+             double* edge_change) {
+  double sum = 0;
+  double square_sum = 0;
+  size_t flat_samples = 0;
+  double change_sum = 0;
+  size_t edge_samples = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      size_t i = ((size_t)y * width + x) * 4;
+      if (i >= output.size()) {
+        continue;
+      }
+      int dx = std::min(x % kPatchSize, kPatchSize - 1 - x % kPatchSize);
+      int dy = std::min(y % kPatchSize, kPatchSize - 1 - y % kPatchSize);
+      int distance = std::min(dx, dy);
+      bool check = ((x / kPatchSize) + (y / kPatchSize)) % 2 == 0;
+      if (distance >= kPatchSize / 4 && check) {
+        sum += output[i];
+        square_sum += (double)output[i] * output[i];
+        flat_samples++;
+      } else if (distance < 2) {
+        change_sum += std::abs((int)output[i] - (int)input[i]);
+        edge_samples++;
+      }
+    }
+  }
+  double mean = flat_samples ? sum / flat_samples : 0;
+  *flat_noise =
+      flat_samples
+          ? std::sqrt(std::max(0.0, square_sum / flat_samples - mean * mean))
+          : 0;
+  *edge_change = edge_samples ? change_sum / edge_samples : 0;
+}
+
+}  // namespace
+
+using benchmark::RunFrames;
+
+int main(int argc, char** argv) {
+  int width = 0;
+  int height = 0;
+  int frames = 0;
+  if (!benchmark::ParseFrameArgs(argc, argv, &width, &height, &frames)) {
+    return 1;
+  }
+  // Skin-like flat patches with noise, separated by hard edges
+  std::vector<uint8_t> frame = benchmark::MakeFrame(
+      width, height, [](int x, int y, uint32_t random, uint8_t* rgb) {
+        int noise = (int)(random >> 27) - 16;
+        bool check = ((x / kPatchSize) + (y / kPatchSize)) % 2 == 0;
+        rgb[0] = benchmark::ToByte((check ? 220 : 90) + noise);
+        rgb[1] = benchmark::ToByte((check ? 170 : 60) + noise);
+        rgb[2] = benchmark::ToByte((check ? 150 : 50) + noise);
+      });
+
+  auto source = gpupixel::SourceRawData::Create();
+  auto sink = gpupixel::SinkRawData::Create();
+  auto beauty = gpupixel::BeautyFaceFilter::Create();
+  auto bilateral = gpupixel::BilateralFilter::Create();
+  if (!source || !sink || !beauty || !bilateral) {
+    fprintf(stderr, "cannot create the pipeline\n");
+    return 1;
+  }
+  beauty->SetBlurAlpha(0.8);
+
+  std::vector<uint8_t> unfiltered;
+  source->AddSink(sink);
+  double baseline_ms =
+      RunFrames(source, sink, frame, width, height, frames, &unfiltered);
+  double input_noise = 0;
+  double unused = 0;
+  Measure(frame, unfiltered, width, height, &input_noise, &unused);
+
+  printf("%dx%d, %d frames, upload + readback %.2f ms\n", width, height,
+         frames, baseline_ms);
+  printf("input noise %.2f\n", input_noise);
+  printf("%-16s %12s %12s %12s\n", "engine", "time", "flat noise",
+         "edge change");
+
+  struct Run {
+    const char* name;
+    std::shared_ptr<gpupixel::Filter> filter;
+    int engine;
+  };
+  const Run runs[] = {
+      {"box high pass", beauty, gpupixel::BeautyFaceFilter::BOX_HIGH_PASS},
+      {"guided", beauty, gpupixel::BeautyFaceFilter::GUIDED},
+      {"bilateral", bilateral, -1},
+  };
+  for (const auto& run : runs) {
+    if (run.engine >= 0) {
+      auto engine = (gpupixel::BeautyFaceFilter::SmoothingEngine)run.engine;
+      beauty->SetSmoothingEngine(engine);
+      if (beauty->GetSmoothingEngine() != engine) {
+        printf("%-16s %12s\n", run.name, "unsupported");
+        continue;
+      }
+    }
+    source->RemoveAllSinks();
+    beauty->RemoveAllSinks();
+    bilateral->RemoveAllSinks();
+    source->AddSink(run.filter)->AddSink(sink);
+
+    std::vector<uint8_t> output;
+    double ms = RunFrames(source, sink, frame, width, height, frames,
+                          &output) -
+                baseline_ms;
+    double flat_noise = 0;
+    double edge_change = 0;
+    Measure(frame, output, width, height, &flat_noise, &edge_change);
+    printf("%-16s %9.2f ms %12.2f %12.2f\n", run.name, ms, flat_noise,
+           edge_change);
+  }
+  return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+// Runs GaussianBlurFilter with the separable and the pyramid engine over a
+// synthetic RGBA frame for radii 4 to 64 and reports the time each engine
+// adds to an unblurred upload and readback, and how far the pyramid output
+// is from the separable reference.
+//
+//   gpupixel_blur_benchmark [width] [height] [frames]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "benchmark/pipeline_benchmark.h"
+#include "gpupixel/gpupixel.h"
+
+using benchmark::RunFrames;
+
+int main(int argc, char** argv) {
+  int width = 0;
+  int height = 0;
+  int frames = 0;
+  if (!benchmark::ParseFrameArgs(argc, argv, &width, &height, &frames)) {
+    return 1;
+  }
+  // Flat patches, hard edges, a gradient and noise, so both the smooth parts
+  // and the edges of the blur are compared
+  std::vector<uint8_t> frame = benchmark::MakeFrame(
+      width, height, [&](int x, int y, uint32_t random, uint8_t* rgb) {
+        int noise = (int)(random >> 26) - 32;
+        bool check = ((x / 48) + (y / 48)) % 2 == 0;
+        rgb[0] = benchmark::ToByte((check ? 200 : 40) + noise);
+        rgb[1] = benchmark::ToByte(x * 255 / width + noise / 2);
+        rgb[2] = (x * x + y * y) % 512 < 256 ? 220 : 30;
+      });
+
+  auto source = gpupixel::SourceRawData::Create();
+  auto sink = gpupixel::SinkRawData::Create();
+  auto blur = gpupixel::GaussianBlurFilter::Create();
+  if (!source || !sink || !blur) {
+    fprintf(stderr, "cannot create the pipeline\n");
+    return 1;
+  }
+
+  source->AddSink(sink);
+  double baseline_ms =
+      RunFrames(source, sink, frame, width, height, frames, nullptr);
+  source->RemoveAllSinks();
+  source->AddSink(blur)->AddSink(sink);
+
+  printf("%dx%d, %d frames, upload + readback %.2f ms\n", width, height,
+         frames, baseline_ms);
+  printf("%6s %6s %12s %12s %8s %10s %10s %8s\n", "radius", "sigma",
+         "separable", "pyramid", "speedup", "mean err", "max err", "psnr");
+
+  for (int radius = 4; radius <= 64; radius *= 2) {
+    float sigma = radius / 2.0f;
+    blur->setSigma(sigma);
+    blur->SetRadius(radius);
+
+    std::vector<uint8_t> reference;
+    std::vector<uint8_t> pyramid;
+    blur->SetEngine(gpupixel::GaussianBlurFilter::SEPARABLE);
+    double separable_ms =
+        RunFrames(source, sink, frame, width, height, frames, &reference) -
+        baseline_ms;
+    blur->SetEngine(gpupixel::GaussianBlurFilter::PYRAMID);
+    double pyramid_ms =
+        RunFrames(source, sink, frame, width, height, frames, &pyramid) -
+        baseline_ms;
+
+    // Color channels only, alpha stays opaque in both
+    double abs_sum = 0;
+    double square_sum = 0;
+    int max_error = 0;
+    size_t samples = 0;
+    for (size_t i = 0; i < reference.size() && i < pyramid.size(); i++) {
+      if (i % 4 == 3) {
+        continue;
+      }
+      int error = std::abs((int)reference[i] - (int)pyramid[i]);
+      abs_sum += error;
+      square_sum += (double)error * error;
+      max_error = std::max(max_error, error);
+      samples++;
+    }
+    double mse = samples ? square_sum / samples : 0;
+    double psnr = mse > 0 ? 10 * std::log10(255.0 * 255.0 / mse) : 99;
+
+    printf("%6d %6.1f %9.2f ms %9.2f ms %7.1fx %10.2f %10d %5.1f dB\n",
+           radius, sigma, separable_ms, pyramid_ms,
+           pyramid_ms > 0 ? separable_ms / pyramid_ms : 0.0,
+           samples ? abs_sum / samples : 0.0, max_error, psnr);
+  }
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+// Runs CannyEdgeDetectionFilter with separate passes and with the fused
+// blur and Sobel front end over a synthetic RGBA frame, and reports the time
+// each adds to an unfiltered upload and readback and how many edge pixels
+// the two engines disagree on.
+//
+//   gpupixel_canny_benchmark [width] [height] [frames]
+
+#include <cstdio>
+#include <vector>
+#include "benchmark/pipeline_benchmark.h"
+#include "gpupixel/gpupixel.h"
+
+using benchmark::RunFrames;
+
+int main(int argc, char** argv) {
+  int width = 0;
+  int height = 0;
+  int frames = 0;
+  if (!benchmark::ParseFrameArgs(argc, argv, &width, &height, &frames)) {
+    return 1;
+  }
+  // Circles, hard edges, a gradient and noise, so edges of every direction
+  // and weak edges are compared
+  std::vector<uint8_t> frame = benchmark::MakeFrame(
+      width, height, [&](int x, int y, uint32_t random, uint8_t* rgb) {
+        int noise = (int)(random >> 28) - 8;
+        bool check = ((x / 80) + (y / 80)) % 2 == 0;
+        int dx = x - width / 2;
+        int dy = y - height / 2;
+        bool ring = (dx * dx + dy * dy) / 4096 % 2 == 0;
+        rgb[0] = benchmark::ToByte((check ? 180 : 60) + noise);
+        rgb[1] = benchmark::ToByte((ring ? 200 : 50) + noise);
+        rgb[2] = (uint8_t)(x * 255 / width);
+      });
+
+  auto source = gpupixel::SourceRawData::Create();
+  auto sink = gpupixel::SinkRawData::Create();
+  auto canny = gpupixel::CannyEdgeDetectionFilter::Create();
+  if (!source || !sink || !canny) {
+    fprintf(stderr, "cannot create the pipeline\n");
+    return 1;
+  }
+
+  source->AddSink(sink);
+  double baseline_ms =
+      RunFrames(source, sink, frame, width, height, frames, nullptr);
+  source->RemoveAllSinks();
+  source->AddSink(canny)->AddSink(sink);
+
+  std::vector<uint8_t> reference;
+  std::vector<uint8_t> fused;
+  canny->SetEngine(gpupixel::CannyEdgeDetectionFilter::SEPARATE_PASSES);
+  double separate_ms =
+      RunFrames(source, sink, frame, width, height, frames, &reference) -
+      baseline_ms;
+  canny->SetEngine(gpupixel::CannyEdgeDetectionFilter::FUSED);
+  if (canny->GetEngine() != gpupixel::CannyEdgeDetectionFilter::FUSED) {
+    fprintf(stderr, "the fused engine needs float render targets\n");
+    return 1;
+  }
+  double fused_ms =
+      RunFrames(source, sink, frame, width, height, frames, &fused) -
+      baseline_ms;
+
+  // Edge pixels are white, compare the red channel against half way
+  size_t edges = 0;
+  size_t only_separate = 0;
+  size_t only_fused = 0;
+  for (size_t i = 0; i < reference.size() && i < fused.size(); i += 4) {
+    bool separate_edge = reference[i] >= 128;
+    bool fused_edge = fused[i] >= 128;
+    edges += separate_edge;
+    only_separate += separate_edge && !fused_edge;
+    only_fused += fused_edge && !separate_edge;
+  }
+
+  printf("%dx%d, %d frames, upload + readback %.2f ms\n", width, height,
+         frames, baseline_ms);
+  printf("%-16s %9.2f ms\n", "separate passes", separate_ms);
+  printf("%-16s %9.2f ms %7.1fx\n", "fused", fused_ms,
+         fused_ms > 0 ? separate_ms / fused_ms : 0.0);
+  printf("edge pixels %zu, only separate %zu, only fused %zu\n", edges,
+         only_separate, only_fused);
+  return 0;
+}
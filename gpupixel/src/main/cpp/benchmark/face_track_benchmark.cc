@@ -0,0 +1,120 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+// Runs FaceDetector over a recorded sequence of raw RGBA frames, once with a
+// full-frame search on every frame and once in tracking mode, and reports
+// the per-frame detection time and how far the tracked landmarks drift from
+// the full search.
+//
+// Record a sequence with e.g.
+//   ffmpeg -i clip.mp4 -f rawvideo -pix_fmt rgba clip.rgba
+// and run
+//   gpupixel_face_track_benchmark clip.rgba 720 1280 <resource_dir> [interval]
+// where <resource_dir> contains the models/ directory.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "gpupixel/face_detector/face_detector.h"
+#include "gpupixel/gpupixel.h"
+
+namespace {
+
+struct PassResult {
+  double total_ms = 0;
+  int frames = 0;
+  int full_searches = 0;
+  std::vector<std::vector<float>> landmarks;
+};
+
+bool RunPass(const char* path, int width, int height, int interval,
+             PassResult& result) {
+  FILE* file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return false;
+  }
+
+  auto detector = gpupixel::FaceDetector::Create();
+  detector->SetDetectInterval(interval);
+
+  std::vector<uint8_t> frame((size_t)width * height * 4);
+  while (fread(frame.data(), 1, frame.size(), file) == frame.size()) {
+    auto start = std::chrono::steady_clock::now();
+    auto landmarks = detector->Detect(frame.data(), width, height, width * 4,
+                                      gpupixel::GPUPIXEL_MODE_FMT_VIDEO,
+                                      gpupixel::GPUPIXEL_FRAME_TYPE_RGBA);
+    auto end = std::chrono::steady_clock::now();
+
+    result.total_ms +=
+        std::chrono::duration<double, std::milli>(end - start).count();
+    result.frames++;
+    result.full_searches += detector->IsLastDetectFull() ? 1 : 0;
+    result.landmarks.push_back(std::move(landmarks));
+  }
+  fclose(file);
+  return result.frames > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 5) {
+    fprintf(stderr,
+            "usage: %s <frames.rgba> <width> <height> <resource_dir> "
+            "[interval]\n",
+            argv[0]);
+    return 1;
+  }
+  const char* path = argv[1];
+  int width = atoi(argv[2]);
+  int height = atoi(argv[3]);
+  int interval = argc > 5 ? atoi(argv[5]) : 10;
+  gpupixel::GPUPixel::SetResourcePath(argv[4]);
+
+  PassResult full;
+  PassResult tracked;
+  if (!RunPass(path, width, height, 1, full) ||
+      !RunPass(path, width, height, interval, tracked)) {
+    return 1;
+  }
+
+  // Landmark drift against the full search, in pixels
+  double drift_sum = 0;
+  double drift_max = 0;
+  int drift_points = 0;
+  int presence_mismatch = 0;
+  for (int i = 0; i < full.frames; i++) {
+    const auto& a = full.landmarks[i];
+    const auto& b = tracked.landmarks[i];
+    if (a.size() != b.size()) {
+      presence_mismatch++;
+      continue;
+    }
+    for (size_t j = 0; j + 1 < a.size(); j += 2) {
+      double dx = (a[j] - b[j]) * width;
+      double dy = (a[j + 1] - b[j + 1]) * height;
+      double d = std::sqrt(dx * dx + dy * dy);
+      drift_sum += d;
+      drift_max = d > drift_max ? d : drift_max;
+      drift_points++;
+    }
+  }
+
+  printf("%d frames %dx%d\n", full.frames, width, height);
+  printf("%-16s %10s %14s\n", "mode", "ms/frame", "full searches");
+  printf("%-16s %10.2f %14d\n", "full", full.total_ms / full.frames,
+         full.full_searches);
+  printf("%-16s %10.2f %14d\n", "track", tracked.total_ms / tracked.frames,
+         tracked.full_searches);
+  printf("speedup %.1fx\n", full.total_ms / tracked.total_ms);
+  printf("landmark drift mean %.2f px, max %.2f px, presence mismatch %d\n",
+         drift_points ? drift_sum / drift_points : 0.0, drift_max,
+         presence_mismatch);
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+// Loads an image N times with SourceImage::Create and reports the resident
+// memory the images add, before and after their CPU copies are read back
+// with GetRgbaImageBuffer. Resident memory is read from /proc/self/statm,
+// drivers that keep textures in process memory count those too.
+//
+//   gpupixel_image_memory_benchmark <image> [count]
+
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include "gpupixel/gpupixel.h"
+
+namespace {
+
+// Resident bytes of this process, 0 where /proc is not available
+size_t ResidentBytes() {
+  FILE* file = fopen("/proc/self/statm", "r");
+  if (!file) {
+    return 0;
+  }
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  int read = fscanf(file, "%lu %lu", &size, &resident);
+  fclose(file);
+  return read == 2 ? (size_t)resident * sysconf(_SC_PAGESIZE) : 0;
+}
+
+// Signed, resident memory can also shrink
+double ToMegabytes(double bytes) {
+  return bytes / (1024.0 * 1024.0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <image> [count]\n", argv[0]);
+    return 1;
+  }
+  int count = argc > 2 ? atoi(argv[2]) : 8;
+  if (count <= 0) {
+    fprintf(stderr, "usage: %s <image> [count]\n", argv[0]);
+    return 1;
+  }
+
+  // Load once so the context and the decoder are set up before measuring
+  auto warmup = gpupixel::SourceImage::Create(argv[1]);
+  if (!warmup) {
+    fprintf(stderr, "cannot load %s\n", argv[1]);
+    return 1;
+  }
+  size_t image_bytes = (size_t)warmup->GetWidth() * warmup->GetHeight() * 4;
+  warmup.reset();
+
+  size_t start = ResidentBytes();
+  std::vector<std::shared_ptr<gpupixel::SourceImage>> images;
+  for (int i = 0; i < count; i++) {
+    images.push_back(gpupixel::SourceImage::Create(argv[1]));
+  }
+  size_t loaded = ResidentBytes();
+
+  for (const auto& image : images) {
+    image->GetRgbaImageBuffer();
+  }
+  size_t read_back = ResidentBytes();
+
+  printf("%d images of %.2f MB RGBA\n", count,
+         ToMegabytes((double)image_bytes));
+  printf("%-24s %10.2f MB\n", "loaded", ToMegabytes((double)loaded - start));
+  printf("%-24s %10.2f MB\n", "after GetRgbaImageBuffer",
+         ToMegabytes((double)read_back - start));
+  printf("%-24s %10.2f MB\n", "CPU copies expected",
+         ToMegabytes((double)image_bytes * count));
+  return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "benchmark/pipeline_benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace benchmark {
+
+bool ParseFrameArgs(int argc,
+                    char** argv,
+                    int* width,
+                    int* height,
+                    int* frames) {
+  *width = argc > 1 ? atoi(argv[1]) : 1280;
+  *height = argc > 2 ? atoi(argv[2]) : 720;
+  *frames = argc > 3 ? atoi(argv[3]) : 30;
+  if (*width <= 0 || *height <= 0 || *frames <= 0) {
+    fprintf(stderr, "usage: %s [width] [height] [frames]\n", argv[0]);
+    return false;
+  }
+  return true;
+}
+
+uint8_t ToByte(int value) {
+  return (uint8_t)std::max(0, std::min(255, value));
+}
+
+std::vector<uint8_t> MakeFrame(
+    int width,
+    int height,
+    const std::function<void(int x, int y, uint32_t random, uint8_t* rgb)>&
+        pixel) {
+  std::vector<uint8_t> frame((size_t)width * height * 4);
+  uint32_t seed = 12345;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      seed = seed * 1664525 + 1013904223;
+      uint8_t* p = &frame[((size_t)y * width + x) * 4];
+      pixel(x, y, seed, p);
+      p[3] = 255;
+    }
+  }
+  return frame;
+}
+
+double RunFrames(const std::shared_ptr<gpupixel::SourceRawData>& source,
+                 const std::shared_ptr<gpupixel::SinkRawData>& sink,
+                 const std::vector<uint8_t>& frame,
+                 int width,
+                 int height,
+                 int frames,
+                 std::vector<uint8_t>* output) {
+  source->ProcessData(frame.data(), width, height, width * 4,
+                      gpupixel::GPUPIXEL_FRAME_TYPE_RGBA);
+  sink->GetRgbaBuffer();
+
+  auto start = std::chrono::steady_clock::now();
+  const uint8_t* rgba = nullptr;
+  for (int i = 0; i < frames; i++) {
+    source->ProcessData(frame.data(), width, height, width * 4,
+                        gpupixel::GPUPIXEL_FRAME_TYPE_RGBA);
+    rgba = sink->GetRgbaBuffer();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  if (output && rgba) {
+    output->assign(rgba, rgba + (size_t)width * height * 4);
+  }
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         frames;
+}
+
+}  // namespace benchmark
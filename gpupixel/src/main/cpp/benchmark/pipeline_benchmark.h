@@ -0,0 +1,51 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+// Shared harness of the filter benchmarks: a synthetic RGBA frame is pushed
+// through SourceRawData -> filters -> SinkRawData and timed per frame.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "gpupixel/gpupixel.h"
+
+namespace benchmark {
+
+// Reads [width] [height] [frames] from the command line, 1280x720 and 30
+// frames by default. Prints the usage and returns false for invalid values.
+bool ParseFrameArgs(int argc,
+                    char** argv,
+                    int* width,
+                    int* height,
+                    int* frames);
+
+// Clamps a channel value to 0..255
+uint8_t ToByte(int value);
+
+// A width x height RGBA frame with opaque alpha. |pixel| fills the rgb of
+// each pixel from its position and a pseudo random value that is the same on
+// every run.
+std::vector<uint8_t> MakeFrame(
+    int width,
+    int height,
+    const std::function<void(int x, int y, uint32_t random, uint8_t* rgb)>&
+        pixel);
+
+// Milliseconds per frame through source -> ... -> sink, after one frame that
+// compiles shaders and allocates framebuffers. The last output is copied to
+// |output| when given.
+double RunFrames(const std::shared_ptr<gpupixel::SourceRawData>& source,
+                 const std::shared_ptr<gpupixel::SinkRawData>& sink,
+                 const std::vector<uint8_t>& frame,
+                 int width,
+                 int height,
+                 int frames,
+                 std::vector<uint8_t>* output);
+
+}  // namespace benchmark
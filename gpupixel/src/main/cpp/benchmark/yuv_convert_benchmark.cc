@@ -0,0 +1,163 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+// Compares ImageConverter::Android420ToRGBA with the conversion formerly in
+// GPUPixel.nativeYUV420ToRGBA, for the chroma layouts cameras deliver:
+// planar (pixel stride 1) and semi-planar NV21 (pixel stride 2).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "libyuv/convert_argb.h"
+#include "utils/image_converter.h"
+
+namespace {
+
+// The conversion formerly used by GPUPixel.nativeYUV420ToRGBA
+void LegacyYUV420ToRGBA(const uint8_t* y_data,
+                        const uint8_t* u_data,
+                        const uint8_t* v_data,
+                        int width,
+                        int height,
+                        int y_row_stride,
+                        int u_row_stride,
+                        int v_row_stride,
+                        int y_pixel_stride,
+                        int u_pixel_stride,
+                        int v_pixel_stride,
+                        uint8_t* rgba_data) {
+  if (y_pixel_stride == 1 && u_pixel_stride == 1 && v_pixel_stride == 1) {
+    uint8_t* nv21_data = new uint8_t[width * height * 3 / 2];
+    for (int i = 0; i < height; i++) {
+      memcpy(nv21_data + i * width, y_data + i * y_row_stride, width);
+    }
+    uint8_t* nv21_vu_data = nv21_data + width * height;
+    for (int i = 0; i < height / 2; i++) {
+      for (int j = 0; j < width / 2; j++) {
+        int offset = i * u_row_stride + j;
+        nv21_vu_data[i * width + j * 2] = v_data[offset];
+        nv21_vu_data[i * width + j * 2 + 1] = u_data[offset];
+      }
+    }
+    libyuv::NV21ToABGR(nv21_data, width, nv21_data + width * height, width,
+                       rgba_data, width * 4, width, height);
+    delete[] nv21_data;
+    return;
+  }
+
+  uint8_t* y_plane = new uint8_t[width * height];
+  uint8_t* u_plane = new uint8_t[width * height / 4];
+  uint8_t* v_plane = new uint8_t[width * height / 4];
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      y_plane[i * width + j] = y_data[i * y_row_stride + j * y_pixel_stride];
+    }
+  }
+  int uv_width = width / 2;
+  for (int i = 0; i < height / 2; i++) {
+    for (int j = 0; j < uv_width; j++) {
+      u_plane[i * uv_width + j] = u_data[i * u_row_stride + j * u_pixel_stride];
+      v_plane[i * uv_width + j] = v_data[i * v_row_stride + j * v_pixel_stride];
+    }
+  }
+  libyuv::I420ToABGR(y_plane, width, u_plane, uv_width, v_plane, uv_width,
+                     rgba_data, width * 4, width, height);
+  delete[] y_plane;
+  delete[] u_plane;
+  delete[] v_plane;
+}
+
+template <typename Fn>
+double AverageMs(int iterations, Fn fn) {
+  fn();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    fn();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         iterations;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  struct Size {
+    const char* name;
+    int width;
+    int height;
+  };
+  const Size sizes[] = {
+      {"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4K", 3840, 2160}};
+  const int iterations = argc > 1 ? atoi(argv[1]) : 20;
+
+  printf("%-6s %-7s %12s %12s %8s\n", "size", "layout", "legacy ms", "new ms",
+         "speedup");
+  for (const Size& size : sizes) {
+    int w = size.width;
+    int h = size.height;
+    // Camera planes usually carry row padding
+    int y_stride = w + 64;
+    std::vector<uint8_t> y(y_stride * h);
+    for (size_t i = 0; i < y.size(); i++) {
+      y[i] = static_cast<uint8_t>(i * 13 + (i >> 10));
+    }
+
+    // Planar: separate U and V planes
+    int planar_stride = w / 2 + 32;
+    std::vector<uint8_t> u(planar_stride * h / 2);
+    std::vector<uint8_t> v(planar_stride * h / 2);
+    for (size_t i = 0; i < u.size(); i++) {
+      u[i] = static_cast<uint8_t>(i * 5);
+      v[i] = static_cast<uint8_t>(i * 3 + 7);
+    }
+
+    // Semi-planar NV21: V first, U one byte after it
+    int vu_stride = y_stride;
+    std::vector<uint8_t> vu(vu_stride * h / 2);
+    for (size_t i = 0; i < vu.size(); i++) {
+      vu[i] = static_cast<uint8_t>(i * 11 + 3);
+    }
+
+    std::vector<uint8_t> legacy(w * h * 4);
+    std::vector<uint8_t> converted(w * h * 4);
+
+    struct Layout {
+      const char* name;
+      const uint8_t* u;
+      const uint8_t* v;
+      int row_stride;
+      int pixel_stride;
+    };
+    const Layout layouts[] = {
+        {"I420", u.data(), v.data(), planar_stride, 1},
+        {"NV21", vu.data() + 1, vu.data(), vu_stride, 2},
+    };
+    for (const Layout& layout : layouts) {
+      double legacy_ms = AverageMs(iterations, [&] {
+        LegacyYUV420ToRGBA(y.data(), layout.u, layout.v, w, h, y_stride,
+                           layout.row_stride, layout.row_stride, 1,
+                           layout.pixel_stride, layout.pixel_stride,
+                           legacy.data());
+      });
+      double new_ms = AverageMs(iterations, [&] {
+        gpupixel::ImageConverter::Android420ToRGBA(
+            y.data(), y_stride, 1, layout.u, layout.row_stride, layout.v,
+            layout.row_stride, layout.pixel_stride, converted.data(), w * 4, w,
+            h);
+      });
+      if (memcmp(legacy.data(), converted.data(), legacy.size()) != 0) {
+        printf("%s %s: output mismatch\n", size.name, layout.name);
+        return 1;
+      }
+      printf("%-6s %-7s %12.2f %12.2f %7.1fx\n", size.name, layout.name,
+             legacy_ms, new_ms, legacy_ms / new_ms);
+    }
+  }
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include "gpupixel/gpupixel.h"
+#include "utils/thread_pool.h"
 #include "utils/util.h"
 
 namespace gpupixel {
@@ -6,4 +7,10 @@ namespace gpupixel {
 void GPUPixel::SetResourcePath(const std::string& path) {
   Util::SetResourcePath(fs::path(path));
 }
+
+void GPUPixel::SetCpuThreads(int thread_count,
+                             CpuAffinity affinity /* = ANY_CORES*/) {
+  ThreadPool::GetInstance()->Configure(
+      thread_count, static_cast<ThreadPool::CoreAffinity>(affinity));
+}
 }  // namespace gpupixel
@@ -5,6 +5,7 @@
  */
 
 #include "core/gpupixel_context.h"
+#include <cstring>
 #include "utils/dispatch_queue.h"
 #include "utils/logging.h"
 #include "utils/util.h"
@@ -15,6 +16,11 @@
 
 namespace gpupixel {
 
+#if defined(GPUPIXEL_ANDROID)
+// EGL_OPENGL_ES3_BIT_KHR, not declared by every egl.h
+static const EGLint kEglOpenGLES3Bit = 0x00000040;
+#endif
+
 GPUPixelContext* GPUPixelContext::instance_ = 0;
 std::mutex GPUPixelContext::mutex_;
 
@@ -135,41 +141,58 @@ void GPUPixelContext::CreateContext() {
   }
   LOG_DEBUG("EGL initialized: version major:{} minor:{}", major, minor);
 
-  // Configure EGL
-  const EGLint configAttribs[] = {EGL_RED_SIZE,
-                                  8,
-                                  EGL_GREEN_SIZE,
-                                  8,
-                                  EGL_BLUE_SIZE,
-                                  8,
-                                  EGL_ALPHA_SIZE,
-                                  8,
-                                  EGL_DEPTH_SIZE,
-                                  16,
-                                  EGL_STENCIL_SIZE,
-                                  0,
-                                  EGL_SURFACE_TYPE,
-                                  EGL_PBUFFER_BIT,
-                                  EGL_RENDERABLE_TYPE,
-                                  EGL_OPENGL_ES2_BIT,
-                                  EGL_NONE};
-
-  EGLint numConfigs;
+  // Configure EGL, preferring an ES 3.0 capable config
+  EGLint configAttribs[] = {EGL_RED_SIZE,
+                            8,
+                            EGL_GREEN_SIZE,
+                            8,
+                            EGL_BLUE_SIZE,
+                            8,
+                            EGL_ALPHA_SIZE,
+                            8,
+                            EGL_DEPTH_SIZE,
+                            16,
+                            EGL_STENCIL_SIZE,
+                            0,
+                            EGL_SURFACE_TYPE,
+                            EGL_PBUFFER_BIT,
+                            EGL_RENDERABLE_TYPE,
+                            kEglOpenGLES3Bit,
+                            EGL_NONE};
+
+  EGLint numConfigs = 0;
+  int client_version = 3;
   if (!eglChooseConfig(egl_display_, configAttribs, &egl_config_, 1,
-                       &numConfigs)) {
-    LOG_ERROR("Failed to choose EGL config");
-    return;
+                       &numConfigs) ||
+      numConfigs < 1) {
+    LOG_DEBUG("No ES 3.0 EGL config, falling back to ES 2.0");
+    configAttribs[15] = EGL_OPENGL_ES2_BIT;
+    client_version = 2;
+    if (!eglChooseConfig(egl_display_, configAttribs, &egl_config_, 1,
+                         &numConfigs)) {
+      LOG_ERROR("Failed to choose EGL config");
+      return;
+    }
   }
 
   // Create EGL context
-  const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 2, EGL_NONE};
+  EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, client_version,
+                             EGL_NONE};
 
   egl_context_ = eglCreateContext(egl_display_, egl_config_, EGL_NO_CONTEXT,
                                   contextAttribs);
+  if (egl_context_ == EGL_NO_CONTEXT && client_version == 3) {
+    LOG_DEBUG("Failed to create ES 3.0 context, falling back to ES 2.0");
+    client_version = 2;
+    contextAttribs[1] = client_version;
+    egl_context_ = eglCreateContext(egl_display_, egl_config_, EGL_NO_CONTEXT,
+                                    contextAttribs);
+  }
   if (egl_context_ == EGL_NO_CONTEXT) {
     LOG_ERROR("Failed to create EGL context");
     return;
   }
+  gl3_available_ = client_version >= 3;
 
   // Create offscreen rendering surface
   const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
@@ -212,6 +235,7 @@ void GPUPixelContext::CreateContext() {
     LOG_ERROR("Failed to initialize GLAD");
     return;
   }
+  gl3_available_ = true;
   LOG_INFO("Windows/Linux OpenGL context created successfully");
 #elif defined(GPUPIXEL_WASM)
   LOG_DEBUG("Creating WebGL context");
@@ -227,6 +251,18 @@ void GPUPixelContext::CreateContext() {
   emscripten_webgl_make_context_current(wasm_context_);
   LOG_INFO("WebGL context created successfully");
 #endif
+
+  // Float color attachments are core in desktop GL 3.0, ES 3.0 needs an
+  // extension for them
+#if defined(GPUPIXEL_WIN) || defined(GPUPIXEL_LINUX)
+  float_render_target_available_ = gl3_available_;
+#elif defined(GPUPIXEL_GL3_API)
+  if (gl3_available_) {
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    float_render_target_available_ =
+        extensions && strstr(extensions, "GL_EXT_color_buffer_float");
+  }
+#endif
 }
 
 void GPUPixelContext::UseAsCurrent() {
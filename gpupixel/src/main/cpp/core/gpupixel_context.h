@@ -31,6 +31,14 @@ class GPUPIXEL_API GPUPixelContext {
   void UseAsCurrent(void);
   void PresentBufferForDisplay();
 
+  // True when the context is ES 3.0 / GL 3.0 or newer, so pixel buffer
+  // objects and fences can be used.
+  bool IsGL3Available() const { return gl3_available_; }
+  // True when 32-bit float textures can be rendered to
+  bool IsFloatRenderTargetAvailable() const {
+    return float_render_target_available_;
+  }
+
 #if defined(GPUPIXEL_IOS)
   EAGLContext* GetEglContext() const { return egl_context_; };
 #elif defined(GPUPIXEL_MAC)
@@ -60,6 +68,8 @@ class GPUPIXEL_API GPUPixelContext {
   FramebufferFactory* framebuffer_factory_;
   GPUPixelGLProgram* current_shader_program_;
   std::shared_ptr<DispatchQueue> task_queue_;
+  bool gl3_available_ = false;
+  bool float_render_target_available_ = false;
 
 #if defined(GPUPIXEL_IOS)
   EAGLContext* egl_context_;
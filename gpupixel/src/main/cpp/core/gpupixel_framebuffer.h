@@ -41,6 +41,10 @@ class GPUPIXEL_API GPUPixelFramebuffer {
   };
   bool HasFramebuffer() { return has_framebuffer_; };
 
+  // Timestamp of the frame currently held, carried along the filter chain
+  void SetTimestamp(int64_t timestamp) { timestamp_ = timestamp; }
+  int64_t GetTimestamp() const { return timestamp_; }
+
   void Activate();
   void Deactivate();
 
@@ -53,6 +57,7 @@ class GPUPIXEL_API GPUPixelFramebuffer {
   bool has_framebuffer_;
   uint32_t texture_;
   uint32_t framebuffer_;
+  int64_t timestamp_ = 0;
 
   void GenerateTexture();
   void GenerateFramebuffer();
@@ -35,6 +35,14 @@
 #include <emscripten/html5.h>
 #endif
 
+// ES 3.0 / desktop GL 3.0 entry points (pixel buffer objects, fences) are
+// declared on these platforms. Whether the running context actually supports
+// them is reported by GPUPixelContext::IsGL3Available().
+#if defined(GPUPIXEL_ANDROID) || defined(GPUPIXEL_IOS) || \
+    defined(GPUPIXEL_WIN) || defined(GPUPIXEL_LINUX)
+#define GPUPIXEL_GL3_API
+#endif
+
 // clang-format off
 //------------- ENABLE_GL_CHECK Begin ------------ //
 #if defined(NDEBUG)
@@ -172,6 +172,13 @@ void GPUPixelGLProgram::SetUniformValue(const std::string& uniform_name,
   SetUniformValue(GetUniformLocation(uniform_name), value, length);
 }
 
+void GPUPixelGLProgram::SetUniformVec4Array(const std::string& uniform_name,
+                                            const float* array,
+                                            int count) {
+  GPUPixelContext::GetInstance()->SetActiveGlProgram(this);
+  GL_CALL(glUniform4fv(GetUniformLocation(uniform_name), count, array));
+}
+
 void GPUPixelGLProgram::SetUniformValue(int uniform_location, int value) {
   GPUPixelContext::GetInstance()->SetActiveGlProgram(this);
   GL_CALL(glUniform1i(uniform_location, value));
@@ -35,6 +35,10 @@ class GPUPIXEL_API GPUPixelGLProgram {
   void SetUniformValue(const std::string& uniform_name,
                        const void* array,
                        int length);
+  // |count| vec4 elements, 4 floats each
+  void SetUniformVec4Array(const std::string& uniform_name,
+                           const float* array,
+                           int count);
 
   void SetUniformValue(int uniform_location, int value);
   void SetUniformValue(int uniform_location, float value);
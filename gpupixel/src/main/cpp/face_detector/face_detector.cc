@@ -5,8 +5,14 @@
  */
 
 #include "gpupixel/face_detector/face_detector.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+#include "libyuv/rotate.h"
+#include "libyuv/scale.h"
+#include "libyuv/scale_argb.h"
 #include "mars_face_detector.h"
+#include "utils/image_converter.h"
 #include "utils/filesystem.h"
 #include "utils/logging.h"
 #include "utils/util.h"
@@ -17,7 +23,8 @@ std::shared_ptr<FaceDetector> FaceDetector::Create() {
   return std::shared_ptr<FaceDetector>(new FaceDetector());
 }
 
-FaceDetector::FaceDetector() {
+FaceDetector::FaceDetector()
+    : landmarks_pool_(FaceLandmarksPool::Create()) {
   mars_face_detector_ = mars_face_kit::MarsFaceDetector::CreateFaceDetector();
   auto path = Util::GetResourcePath() / "models";
 
@@ -29,87 +36,483 @@ FaceDetector::FaceDetector() {
   }
 }
 
+FaceDetector::~FaceDetector() {
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    async_stop_ = true;
+  }
+  async_cv_.notify_one();
+  if (async_thread_.joinable()) {
+    async_thread_.join();
+  }
+}
+
+namespace {
+// Side of the region searched while tracking, relative to the last face box
+constexpr float kTrackRegionScale = 2.0f;
+}  // namespace
+
 std::vector<float> FaceDetector::Detect(const uint8_t* data,
                                         int width,
                                         int height,
                                         int stride,
                                         GPUPIXEL_MODE_FMT fmt,
-                                        GPUPIXEL_FRAME_TYPE type) {
+                                        GPUPIXEL_FRAME_TYPE type,
+                                        int rotation /* = 0*/) {
+  auto result =
+      DetectLandmarks(data, width, height, stride, fmt, type, rotation);
+  std::vector<float> landmarks(result->InterleavedSize());
+  result->ToInterleaved(landmarks.data(), landmarks.size());
+  return landmarks;
+}
+
+std::vector<FaceInfo> FaceDetector::DetectFaces(const uint8_t* data,
+                                                int width,
+                                                int height,
+                                                int stride,
+                                                GPUPIXEL_MODE_FMT fmt,
+                                                GPUPIXEL_FRAME_TYPE type,
+                                                int rotation /* = 0*/) {
+  auto result =
+      DetectLandmarks(data, width, height, stride, fmt, type, rotation);
+  std::vector<FaceInfo> faces(result->face_count);
+  for (int i = 0; i < result->face_count; i++) {
+    const FaceLandmarks::Face& src = result->faces[i];
+    FaceInfo& face = faces[i];
+    face.face_id = src.face_id;
+    face.score = src.score;
+    std::copy(src.rect, src.rect + 4, face.rect);
+    face.pitch = src.pitch;
+    face.yaw = src.yaw;
+    face.roll = src.roll;
+    face.landmarks.resize(kFaceLandmarkCount * 2);
+    for (int j = 0; j < kFaceLandmarkCount; j++) {
+      face.landmarks[j * 2] = src.x[j];
+      face.landmarks[j * 2 + 1] = src.y[j];
+    }
+  }
+  return faces;
+}
+
+std::shared_ptr<const FaceLandmarks> FaceDetector::DetectLandmarks(
+    const uint8_t* data,
+    int width,
+    int height,
+    int stride,
+    GPUPIXEL_MODE_FMT fmt,
+    GPUPIXEL_FRAME_TYPE type,
+    int rotation /* = 0*/,
+    int64_t timestamp /* = 0*/) {
+  std::lock_guard<std::mutex> detect_lock(detect_mutex_);
+
+  // From here on the frame is the upright, downscaled detection image.
+  // Normalized coordinates are the same in both.
+  PrepareImage(data, width, height, stride, type, rotation);
+
+  if (fmt != GPUPIXEL_MODE_FMT_VIDEO || width != last_width_ ||
+      height != last_height_) {
+    has_track_ = false;
+    frames_since_detect_ = 0;
+  }
+  last_width_ = width;
+  last_height_ = height;
+
+  std::vector<mars_face_kit::FaceDetectionInfo>& face_info = face_info_;
+  face_info.clear();
+  bool tracked = false;
+  if (has_track_ && frames_since_detect_ + 1 < detect_interval_) {
+    tracked = TrackFace(data, width, height, stride, type, face_info);
+  }
+  if (tracked) {
+    frames_since_detect_++;
+  } else {
+    face_info.clear();
+    DetectFrame(data, width, height, stride, type, face_info);
+    frames_since_detect_ = 0;
+  }
+  last_detect_full_ = !tracked;
+
+  if (face_info.size() > static_cast<size_t>(max_faces_)) {
+    face_info.resize(max_faces_);
+  }
+
+  if (face_info.empty()) {
+    has_track_ = false;
+  } else if (fmt == GPUPIXEL_MODE_FMT_VIDEO) {
+    UpdateTrack(face_info);
+  }
+
+  std::shared_ptr<FaceLandmarks> result = landmarks_pool_->Acquire();
+  result->timestamp = timestamp;
+  result->face_count = 0;
+  for (const auto& info : face_info) {
+    if (info.landmarks.size() < 106) {
+      continue;
+    }
+    FaceLandmarks::Face& face = result->faces[result->face_count++];
+    face.face_id = info.face_id;
+    face.score = info.score;
+    face.rect[0] = info.rect.left / width;
+    face.rect[1] = info.rect.top / height;
+    face.rect[2] = info.rect.right / width;
+    face.rect[3] = info.rect.bottom / height;
+    face.pitch = info.pitch;
+    face.yaw = info.yaw;
+    face.roll = info.roll;
+
+    for (int i = 0; i < 106; i++) {
+      face.x[i] = info.landmarks[i].x / width;
+      face.y[i] = info.landmarks[i].y / height;
+    }
+
+    // Additional landmarks, each the center between two model points:
+    // 106 between 102 and 98, 107 between 35 and 65, 108 between 70 and 40,
+    // 109 between 5 and 80, 110 between 81 and 27
+    static const int kCenterPairs[5][2] = {
+        {102, 98}, {35, 65}, {70, 40}, {5, 80}, {81, 27}};
+    for (int i = 0; i < 5; i++) {
+      int a = kCenterPairs[i][0];
+      int b = kCenterPairs[i][1];
+      face.x[106 + i] = (face.x[a] + face.x[b]) / 2;
+      face.y[106 + i] = (face.y[a] + face.y[b]) / 2;
+    }
+  }
+
+  return result;
+}
+
+void FaceDetector::SetMaxFaces(int count) {
+  std::lock_guard<std::mutex> lock(detect_mutex_);
+  max_faces_ = std::max(1, std::min(count, FaceLandmarks::kMaxFaces));
+}
+
+void FaceDetector::DetectAsync(const uint8_t* data,
+                               int width,
+                               int height,
+                               int stride,
+                               GPUPIXEL_MODE_FMT fmt,
+                               GPUPIXEL_FRAME_TYPE type,
+                               int rotation,
+                               int64_t timestamp) {
+  // Only the luma plane of YUV frames is used
+  size_t size = (size_t)stride * height;
+
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    // An unprocessed frame is simply overwritten, its buffer reused
+    pending_frame_.data.resize(size);
+    memcpy(pending_frame_.data.data(), data, size);
+    pending_frame_.width = width;
+    pending_frame_.height = height;
+    pending_frame_.stride = stride;
+    pending_frame_.fmt = fmt;
+    pending_frame_.type = type;
+    pending_frame_.rotation = rotation;
+    pending_frame_.timestamp = timestamp;
+    has_pending_frame_ = true;
+    if (!async_thread_.joinable()) {
+      async_thread_ = std::thread(&FaceDetector::AsyncWorker, this);
+    }
+  }
+  async_cv_.notify_one();
+}
+
+void FaceDetector::AsyncWorker() {
+  AsyncFrame frame;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(async_mutex_);
+      async_cv_.wait(lock,
+                     [this] { return has_pending_frame_ || async_stop_; });
+      if (async_stop_) {
+        return;
+      }
+      // Swap so both buffers keep their capacity
+      std::swap(frame, pending_frame_);
+      has_pending_frame_ = false;
+    }
+
+    auto result = DetectLandmarks(frame.data.data(), frame.width,
+                                  frame.height, frame.stride, frame.fmt,
+                                  frame.type, frame.rotation, frame.timestamp);
+
+    ResultCallback callback;
+    {
+      std::lock_guard<std::mutex> lock(result_mutex_);
+      previous_landmarks_ = result_landmarks_;
+      result_landmarks_ = result;
+      callback = result_callback_;
+    }
+    if (callback) {
+      callback(result);
+    }
+  }
+}
+
+std::shared_ptr<const FaceLandmarks> FaceDetector::GetLatestFaceLandmarks() {
+  std::lock_guard<std::mutex> lock(result_mutex_);
+  return result_landmarks_;
+}
+
+bool FaceDetector::GetLatestLandmarks(std::vector<float>& landmarks,
+                                      int64_t& timestamp) {
+  auto result = GetLatestFaceLandmarks();
+  if (!result) {
+    return false;
+  }
+  landmarks.resize(result->InterleavedSize());
+  result->ToInterleaved(landmarks.data(), landmarks.size());
+  timestamp = result->timestamp;
+  return true;
+}
+
+std::shared_ptr<const FaceLandmarks> FaceDetector::GetFaceLandmarksAt(
+    int64_t timestamp) {
+  std::shared_ptr<const FaceLandmarks> latest;
+  std::shared_ptr<const FaceLandmarks> previous;
+  {
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    latest = result_landmarks_;
+    previous = previous_landmarks_;
+  }
+
+  // Needs the same faces in both results and time moving forward
+  if (!latest || !previous || latest->face_count == 0 ||
+      latest->face_count != previous->face_count ||
+      latest->timestamp <= previous->timestamp ||
+      timestamp <= latest->timestamp) {
+    return latest;
+  }
+  for (int i = 0; i < latest->face_count; i++) {
+    if (latest->faces[i].face_id != previous->faces[i].face_id) {
+      return latest;
+    }
+  }
+
+  float t = std::min(1.0f, (float)(timestamp - latest->timestamp) /
+                               (latest->timestamp - previous->timestamp));
+  std::shared_ptr<FaceLandmarks> result = landmarks_pool_->Acquire();
+  *result = *latest;
+  result->timestamp = timestamp;
+  for (int i = 0; i < result->face_count; i++) {
+    FaceLandmarks::Face& face = result->faces[i];
+    const FaceLandmarks::Face& last = previous->faces[i];
+    for (int j = 0; j < FaceLandmarks::kPointCount; j++) {
+      face.x[j] += (face.x[j] - last.x[j]) * t;
+      face.y[j] += (face.y[j] - last.y[j]) * t;
+    }
+  }
+  return result;
+}
+
+std::vector<float> FaceDetector::GetLandmarksAt(int64_t timestamp) {
+  std::vector<float> landmarks;
+  auto result = GetFaceLandmarksAt(timestamp);
+  if (result) {
+    landmarks.resize(result->InterleavedSize());
+    result->ToInterleaved(landmarks.data(), landmarks.size());
+  }
+  return landmarks;
+}
+
+void FaceDetector::SetResultCallback(ResultCallback callback) {
+  std::lock_guard<std::mutex> lock(result_mutex_);
+  result_callback_ = callback;
+}
+
+void FaceDetector::SetDetectSize(int size) {
+  std::lock_guard<std::mutex> lock(detect_mutex_);
+  detect_size_ = size > 0 ? size : 0;
+}
+
+void FaceDetector::SetDetectInterval(int interval) {
+  std::lock_guard<std::mutex> lock(detect_mutex_);
+  detect_interval_ = interval > 1 ? interval : 1;
+}
+
+void FaceDetector::SetTrackingThreshold(float score) {
+  std::lock_guard<std::mutex> lock(detect_mutex_);
+  tracking_threshold_ = score;
+}
+
+void FaceDetector::ResetTracking() {
+  std::lock_guard<std::mutex> lock(detect_mutex_);
+  has_track_ = false;
+  frames_since_detect_ = 0;
+}
+
+void FaceDetector::PrepareImage(const uint8_t*& data,
+                                int& width,
+                                int& height,
+                                int& stride,
+                                GPUPIXEL_FRAME_TYPE& type,
+                                int rotation) {
+  bool packed = type == GPUPIXEL_FRAME_TYPE_RGBA ||
+                type == GPUPIXEL_FRAME_TYPE_BGRA;
+  int pixel_bytes = packed ? 4 : 1;
+  // The luma plane leads every YUV layout
+  if (!packed) {
+    type = GPUPIXEL_FRAME_TYPE_GRAY;
+  }
+  rotation = ((rotation / 90) % 4 + 4) % 4 * 90;
+
+  int scaled_width = width;
+  int scaled_height = height;
+  int longer = std::max(width, height);
+  if (detect_size_ > 0 && longer > detect_size_) {
+    float scale = (float)detect_size_ / longer;
+    scaled_width = std::max(1, (int)(width * scale + 0.5f));
+    scaled_height = std::max(1, (int)(height * scale + 0.5f));
+  }
+
+  if (scaled_width != width || scaled_height != height) {
+    int dst_stride = scaled_width * pixel_bytes;
+    scale_buffer_.resize((size_t)dst_stride * scaled_height);
+    if (packed) {
+      libyuv::ARGBScale(data, stride, width, height, scale_buffer_.data(),
+                        dst_stride, scaled_width, scaled_height,
+                        libyuv::kFilterBilinear);
+    } else {
+      libyuv::ScalePlane(data, stride, width, height, scale_buffer_.data(),
+                         dst_stride, scaled_width, scaled_height,
+                         libyuv::kFilterBilinear);
+    }
+    data = scale_buffer_.data();
+    width = scaled_width;
+    height = scaled_height;
+    stride = dst_stride;
+  }
+
+  if (rotation != 0) {
+    int rotated_width = rotation == 180 ? width : height;
+    int rotated_height = rotation == 180 ? height : width;
+    int dst_stride = rotated_width * pixel_bytes;
+    rotate_buffer_.resize((size_t)dst_stride * rotated_height);
+    if (packed) {
+      ImageConverter::RotateRGBA(data, stride, rotate_buffer_.data(),
+                                 dst_stride, width, height, rotation);
+    } else {
+      libyuv::RotatePlane(data, stride, rotate_buffer_.data(), dst_stride,
+                          width, height,
+                          static_cast<libyuv::RotationMode>(rotation));
+    }
+    data = rotate_buffer_.data();
+    width = rotated_width;
+    height = rotated_height;
+    stride = dst_stride;
+  }
+}
+
+void FaceDetector::DetectFrame(
+    const uint8_t* data,
+    int width,
+    int height,
+    int stride,
+    GPUPIXEL_FRAME_TYPE type,
+    std::vector<mars_face_kit::FaceDetectionInfo>& faces) {
+  int pixel_bytes = type == GPUPIXEL_FRAME_TYPE_GRAY ? 1 : 4;
   mars_face_kit::MarsImage image;
   image.data = (uint8_t*)data;
-  image.width = width == stride / 4 ? width : stride / 4;
+  image.width =
+      width == stride / pixel_bytes ? width : stride / pixel_bytes;
   image.height = height;
   if (type == GPUPIXEL_FRAME_TYPE_RGBA) {
     image.pixel_format = mars_face_kit::PixelFormat::RGBA;
   } else if (type == GPUPIXEL_FRAME_TYPE_BGRA) {
     image.pixel_format = mars_face_kit::PixelFormat::BGRA;
+  } else {
+    image.pixel_format = mars_face_kit::PixelFormat::GRAY;
   }
   image.width_step = width;
   image.rotate_type = mars_face_kit::CLOCKWISE_ROTATE_0;
 
-  std::vector<mars_face_kit::FaceDetectionInfo> face_info;
-  std::vector<float> landmarks;
+  mars_face_detector_->Detect(image, faces);
+}
+
+bool FaceDetector::TrackFace(
+    const uint8_t* data,
+    int width,
+    int height,
+    int stride,
+    GPUPIXEL_FRAME_TYPE type,
+    std::vector<mars_face_kit::FaceDetectionInfo>& faces) {
+  int pixel_bytes = type == GPUPIXEL_FRAME_TYPE_GRAY ? 1 : 4;
 
-  mars_face_detector_->Detect(image, face_info);
-  if (face_info.size() > 0) {
-    for (int i = 0; i < face_info[0].landmarks.size(); i++) {
-      landmarks.push_back(face_info[0].landmarks[i].x / width);
-      landmarks.push_back(face_info[0].landmarks[i].y / height);
-    }
-
-    // Calculate additional facial landmarks
-    // Landmark 106: Center point between points 102 and 98
-    auto point_x = (face_info[0].landmarks[102].x / width +
-                    face_info[0].landmarks[98].x / width) /
-                   2;
-    auto point_y = (face_info[0].landmarks[102].y / height +
-                    face_info[0].landmarks[98].y / height) /
-                   2;
-    landmarks.push_back(point_x);
-    landmarks.push_back(point_y);
-
-    // Landmark 107: Center point between points 35 and 65
-    point_x = (face_info[0].landmarks[35].x / width +
-               face_info[0].landmarks[65].x / width) /
-              2;
-    point_y = (face_info[0].landmarks[35].y / height +
-               face_info[0].landmarks[65].y / height) /
-              2;
-    landmarks.push_back(point_x);
-    landmarks.push_back(point_y);
-
-    // Landmark 108: Center point between points 70 and 40
-    point_x = (face_info[0].landmarks[70].x / width +
-               face_info[0].landmarks[40].x / width) /
-              2;
-    point_y = (face_info[0].landmarks[70].y / height +
-               face_info[0].landmarks[40].y / height) /
-              2;
-    landmarks.push_back(point_x);
-    landmarks.push_back(point_y);
-
-    // Landmark 109: Center point between points 5 and 80
-    point_x = (face_info[0].landmarks[5].x / width +
-               face_info[0].landmarks[80].x / width) /
-              2;
-    point_y = (face_info[0].landmarks[5].y / height +
-               face_info[0].landmarks[80].y / height) /
-              2;
-    landmarks.push_back(point_x);
-    landmarks.push_back(point_y);
-
-    // Landmark 110: Center point between points 81 and 27
-    point_x = (face_info[0].landmarks[81].x / width +
-               face_info[0].landmarks[27].x / width) /
-              2;
-    point_y = (face_info[0].landmarks[81].y / height +
-               face_info[0].landmarks[27].y / height) /
-              2;
-    landmarks.push_back(point_x);
-    landmarks.push_back(point_y);
+  // Square region centered on the last face, clamped to the frame
+  float center_x = (track_left_ + track_right_) / 2;
+  float center_y = (track_top_ + track_bottom_) / 2;
+  float side = std::max(track_right_ - track_left_,
+                        track_bottom_ - track_top_) *
+               kTrackRegionScale;
+  int left = std::max(0, (int)(center_x - side / 2)) & ~1;
+  int top = std::max(0, (int)(center_y - side / 2)) & ~1;
+  int right = std::min(width, (int)(center_x + side / 2 + 1));
+  int bottom = std::min(height, (int)(center_y + side / 2 + 1));
+  int crop_width = right - left;
+  int crop_height = bottom - top;
+  if (crop_width <= 0 || crop_height <= 0) {
+    return false;
   }
 
-  return landmarks;
+  if (crop_width == width && crop_height == height) {
+    DetectFrame(data, width, height, stride, type, faces);
+  } else {
+    size_t row_bytes = (size_t)crop_width * pixel_bytes;
+    crop_buffer_.resize(row_bytes * crop_height);
+    const uint8_t* src =
+        data + (size_t)top * stride + (size_t)left * pixel_bytes;
+    for (int y = 0; y < crop_height; y++) {
+      memcpy(crop_buffer_.data() + y * row_bytes, src + (size_t)y * stride,
+             row_bytes);
+    }
+    DetectFrame(crop_buffer_.data(), crop_width, crop_height, (int)row_bytes,
+                type, faces);
+
+    // Back to frame coordinates
+    for (auto& face : faces) {
+      for (auto& point : face.landmarks) {
+        point.x += left;
+        point.y += top;
+      }
+      face.rect.left += left;
+      face.rect.right += left;
+      face.rect.top += top;
+      face.rect.bottom += top;
+    }
+  }
+
+  // Every tracked face has to be found again
+  if (faces.size() < static_cast<size_t>(tracked_faces_)) {
+    return false;
+  }
+  for (int i = 0; i < tracked_faces_; i++) {
+    if (faces[i].score < tracking_threshold_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FaceDetector::UpdateTrack(
+    const std::vector<mars_face_kit::FaceDetectionInfo>& faces) {
+  // The union of the landmark hulls is tighter and steadier than the
+  // detector boxes
+  has_track_ = false;
+  tracked_faces_ = 0;
+  for (const auto& face : faces) {
+    for (const auto& point : face.landmarks) {
+      if (!has_track_) {
+        track_left_ = track_right_ = point.x;
+        track_top_ = track_bottom_ = point.y;
+        has_track_ = true;
+      }
+      track_left_ = std::min(track_left_, point.x);
+      track_right_ = std::max(track_right_, point.x);
+      track_top_ = std::min(track_top_, point.y);
+      track_bottom_ = std::max(track_bottom_, point.y);
+    }
+    tracked_faces_++;
+  }
 }
 
 }  // namespace gpupixel
@@ -6,9 +6,14 @@
 
 #include "gpupixel/filter/beauty_face_filter.h"
 #include "core/gpupixel_context.h"
+#include "utils/logging.h"
 namespace gpupixel {
 
-BeautyFaceFilter::BeautyFaceFilter() {}
+BeautyFaceFilter::BeautyFaceFilter()
+    : guided_filter_(nullptr),
+      smoothing_engine_(BOX_HIGH_PASS),
+      radius_(4),
+      high_pass_delta_(7.07) {}
 
 BeautyFaceFilter::~BeautyFaceFilter() {}
 
@@ -27,21 +32,17 @@ bool BeautyFaceFilter::Init() {
     return false;
   }
 
-  box_blur_filter_ = BoxBlurFilter::Create();
-  AddFilter(box_blur_filter_);
-
+  // One blur pass renders both the mean and the high pass the unit filter
+  // needs
   box_high_pass_filter_ = BoxHighPassFilter::Create();
   AddFilter(box_high_pass_filter_);
 
   beauty_face_filter_ = BeautyFaceUnitFilter::Create();
   AddFilter(beauty_face_filter_);
 
-  box_blur_filter_->AddSink(beauty_face_filter_, 1);
-  box_high_pass_filter_->AddSink(beauty_face_filter_, 2);
-
-  SetTerminalFilter(beauty_face_filter_);
+  ConnectSmoothing(box_high_pass_filter_->GetMeanOutput(),
+                   box_high_pass_filter_);
 
-  box_blur_filter_->SetTexelSpacingMultiplier(4);
   SetRadius(4);
 
   RegisterProperty("whiteness", 0,
@@ -51,20 +52,68 @@ bool BeautyFaceFilter::Init() {
   RegisterProperty("skin_smoothing", 0,
                    "The smoothing of filter with range between -1 and 1.",
                    [this](float& val) { SetBlurAlpha(val); });
+
+  RegisterProperty("skin_smoothing_engine", (int)BOX_HIGH_PASS,
+                   "0: box high pass, 1: guided filter", [this](int& val) {
+                     SetSmoothingEngine((SmoothingEngine)val);
+                   });
   return true;
 }
 
+void BeautyFaceFilter::ConnectSmoothing(
+    std::shared_ptr<Source> smoothed_output,
+    std::shared_ptr<Source> high_pass_output) {
+  smoothed_output->AddSink(beauty_face_filter_, 1);
+  high_pass_output->AddSink(beauty_face_filter_, 2);
+  // AddFilter guesses the terminal from the sinks of the new member
+  SetTerminalFilter(beauty_face_filter_);
+}
+
+void BeautyFaceFilter::SetSmoothingEngine(SmoothingEngine engine) {
+  if (engine == smoothing_engine_ ||
+      (engine != BOX_HIGH_PASS && engine != GUIDED)) {
+    return;
+  }
+  if (engine == GUIDED && !guided_filter_) {
+    guided_filter_ =
+        GuidedFilter::Create(box_high_pass_filter_->GetBoxRadius());
+    if (!guided_filter_) {
+      LOG_WARN("BeautyFaceFilter: guided filter unavailable, keeping box");
+      return;
+    }
+    guided_filter_->SetDelta(high_pass_delta_);
+  }
+
+  if (engine == GUIDED) {
+    box_high_pass_filter_->GetMeanOutput()->RemoveAllSinks();
+    box_high_pass_filter_->RemoveAllSinks();
+    RemoveFilter(box_high_pass_filter_);
+    AddFilter(guided_filter_);
+    ConnectSmoothing(guided_filter_, guided_filter_->GetHighPassOutput());
+  } else {
+    guided_filter_->GetHighPassOutput()->RemoveAllSinks();
+    guided_filter_->RemoveAllSinks();
+    RemoveFilter(guided_filter_);
+    AddFilter(box_high_pass_filter_);
+    ConnectSmoothing(box_high_pass_filter_->GetMeanOutput(),
+                     box_high_pass_filter_);
+  }
+  smoothing_engine_ = engine;
+}
+
 void BeautyFaceFilter::SetInputFramebuffer(
     std::shared_ptr<GPUPixelFramebuffer> framebuffer,
     RotationMode rotation_mode /* = NoRotation*/,
     int texIdx /* = 0*/) {
-  for (auto& filter : filters_) {
-    filter->SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
-  }
+  FilterGroup::SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
 }
 
 void BeautyFaceFilter::SetHighPassDelta(float highPassDelta) {
+  high_pass_delta_ = highPassDelta;
   box_high_pass_filter_->SetDelta(highPassDelta);
+  if (guided_filter_) {
+    guided_filter_->SetDelta(highPassDelta);
+  }
 }
 
 void BeautyFaceFilter::SetSharpen(float sharpen) {
@@ -80,7 +129,10 @@ void BeautyFaceFilter::SetWhite(float white) {
 }
 
 void BeautyFaceFilter::SetRadius(float radius) {
-  box_blur_filter_->SetRadius(radius);
+  radius_ = radius;
   box_high_pass_filter_->SetRadius(radius);
+  if (guided_filter_) {
+    guided_filter_->SetRadius(box_high_pass_filter_->GetBoxRadius());
+  }
 }
 }  // namespace gpupixel
@@ -306,10 +306,13 @@ bool BeautyFaceUnitFilter::Init() {
   }
 
   auto path = Util::GetResourcePath() / "res";
-  gray_image_ = SourceImage::Create((path / "lookup_gray.png").string());
-  original_image_ = SourceImage::Create((path / "lookup_origin.png").string());
-  skin_image_ = SourceImage::Create((path / "lookup_skin.png").string());
-  custom_image_ = SourceImage::Create((path / "lookup_light.png").string());
+  // Shared by every instance, decoded once per process
+  gray_image_ = SourceImage::CreateShared((path / "lookup_gray.png").string());
+  original_image_ =
+      SourceImage::CreateShared((path / "lookup_origin.png").string());
+  skin_image_ = SourceImage::CreateShared((path / "lookup_skin.png").string());
+  custom_image_ =
+      SourceImage::CreateShared((path / "lookup_light.png").string());
   return true;
 }
 
@@ -23,11 +23,18 @@ std::shared_ptr<BlusherFilter> BlusherFilter::Create() {
 }
 
 bool BlusherFilter::Init() {
-  auto path = Util::GetResourcePath() / "res";
-  auto blusher = SourceImage::Create((path / "blusher.png").string());
-  SetImageTexture(blusher);
-  SetTextureBounds(FrameBounds{395, 520, 489, 209});
+  SetImageTexture(CreateTexture());
+  SetTextureBounds(GetTextureBounds());
   return FaceMakeupFilter::Init();
 }
 
+std::shared_ptr<SourceImage> BlusherFilter::CreateTexture() {
+  auto path = Util::GetResourcePath() / "res";
+  return SourceImage::CreateShared((path / "blusher.png").string());
+}
+
+FrameBounds BlusherFilter::GetTextureBounds() {
+  return FrameBounds{395, 520, 489, 209};
+}
+
 }  // namespace gpupixel
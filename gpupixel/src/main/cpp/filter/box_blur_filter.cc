@@ -5,11 +5,18 @@
  */
 
 #include "gpupixel/filter/box_blur_filter.h"
+#include <cmath>
 #include "core/gpupixel_context.h"
+#include "utils/logging.h"
 namespace gpupixel {
 
 BoxBlurFilter::BoxBlurFilter()
-    : horizontal_blur_filter_(nullptr), vertical_blur_filter_(nullptr) {}
+    : horizontal_blur_filter_(nullptr),
+      vertical_blur_filter_(nullptr),
+      summed_area_table_filter_(nullptr),
+      summed_area_box_filter_(nullptr),
+      texel_spacing_(1.0),
+      engine_(SEPARABLE) {}
 
 BoxBlurFilter::~BoxBlurFilter() {}
 
@@ -40,12 +47,19 @@ bool BoxBlurFilter::Init(int radius, float sigma) {
 
   RegisterProperty("sigma", 0.0, "", [this](float& sigma) { setSigma(sigma); });
 
+  RegisterProperty("engine", (int)SEPARABLE,
+                   "0: separable, 1: summed-area table",
+                   [this](int& engine) { SetEngine((Engine)engine); });
+
   return true;
 }
 
 void BoxBlurFilter::SetRadius(int radius) {
   horizontal_blur_filter_->SetRadius(radius);
   vertical_blur_filter_->SetRadius(radius);
+  if (summed_area_box_filter_) {
+    summed_area_box_filter_->SetRadius(GetBoxRadius());
+  }
 }
 
 void BoxBlurFilter::setSigma(float sigma) {
@@ -56,6 +70,44 @@ void BoxBlurFilter::setSigma(float sigma) {
 void BoxBlurFilter::SetTexelSpacingMultiplier(float value) {
   horizontal_blur_filter_->SetTexelSpacingMultiplier(value);
   vertical_blur_filter_->SetTexelSpacingMultiplier(value);
+  texel_spacing_ = value;
+  if (summed_area_box_filter_) {
+    summed_area_box_filter_->SetRadius(GetBoxRadius());
+  }
+}
+
+void BoxBlurFilter::SetEngine(Engine engine) {
+  if (engine == engine_ ||
+      (engine != SEPARABLE && engine != SUMMED_AREA_TABLE)) {
+    return;
+  }
+  if (engine == SUMMED_AREA_TABLE && !summed_area_table_filter_) {
+    if (!SummedAreaTableFilter::IsSupported()) {
+      LOG_WARN("BoxBlurFilter: no float render targets, staying separable");
+      return;
+    }
+    summed_area_table_filter_ = SummedAreaTableFilter::Create();
+    summed_area_box_filter_ = SummedAreaBoxFilter::Create(
+        SummedAreaBoxFilter::MEAN, GetBoxRadius());
+    if (!summed_area_table_filter_ || !summed_area_box_filter_) {
+      summed_area_table_filter_.reset();
+      summed_area_box_filter_.reset();
+      return;
+    }
+    summed_area_table_filter_->AddSink(summed_area_box_filter_);
+  }
+
+  if (engine == SUMMED_AREA_TABLE) {
+    ReplaceFilter(horizontal_blur_filter_, summed_area_table_filter_);
+  } else {
+    ReplaceFilter(summed_area_table_filter_, horizontal_blur_filter_);
+  }
+  engine_ = engine;
+}
+
+int BoxBlurFilter::GetBoxRadius() const {
+  return BoxMonoBlurFilter::GetBoxRadius(horizontal_blur_filter_->GetRadius(),
+                                         texel_spacing_);
 }
 
 }  // namespace gpupixel
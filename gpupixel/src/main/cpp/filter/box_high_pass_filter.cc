@@ -5,10 +5,20 @@
  */
 
 #include "gpupixel/filter/box_high_pass_filter.h"
+#include <cmath>
 #include "core/gpupixel_context.h"
+#include "utils/logging.h"
 namespace gpupixel {
 
-BoxHighPassFilter::BoxHighPassFilter() {}
+namespace {
+const float kTexelSpacing = 4;
+}  // namespace
+
+BoxHighPassFilter::BoxHighPassFilter()
+    : summed_area_table_filter_(nullptr),
+      summed_area_high_pass_filter_(nullptr),
+      delta_(7.07),
+      engine_(SEPARABLE) {}
 
 BoxHighPassFilter::~BoxHighPassFilter() {}
 
@@ -27,16 +37,18 @@ bool BoxHighPassFilter::Init() {
     return false;
   }
 
-  box_blur_filter_ = BoxBlurFilter::Create();
-  AddFilter(box_blur_filter_);
-
-  box_difference_filter_ = BoxDifferenceFilter::Create();
-  AddFilter(box_difference_filter_);
+  horizontal_blur_filter_ =
+      BoxMonoBlurFilter::Create(GaussianBlurMonoFilter::HORIZONTAL, 4, 0.0);
+  AddFilter(horizontal_blur_filter_);
 
-  box_blur_filter_->AddSink(box_difference_filter_, 1);
-  SetTerminalFilter(box_difference_filter_);
+  // Finishes the blur and takes the difference without another pass over
+  // the blurred image
+  vertical_high_pass_filter_ = BoxHighPassMonoFilter::Create(4);
+  horizontal_blur_filter_->AddSink(vertical_high_pass_filter_, 0);
+  SetTerminalFilter(vertical_high_pass_filter_);
 
-  box_blur_filter_->SetTexelSpacingMultiplier(4);
+  horizontal_blur_filter_->SetTexelSpacingMultiplier(kTexelSpacing);
+  vertical_high_pass_filter_->SetTexelSpacingMultiplier(kTexelSpacing);
   return true;
 }
 
@@ -44,17 +56,76 @@ void BoxHighPassFilter::SetInputFramebuffer(
     std::shared_ptr<GPUPixelFramebuffer> framebuffer,
     RotationMode rotation_mode /* = NoRotation*/,
     int texIdx /* = 0*/) {
-  for (auto& filter : filters_) {
-    filter->SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
+  FilterGroup::SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
+  // The unblurred input to take the difference to
+  if (engine_ == SUMMED_AREA_TABLE) {
+    summed_area_high_pass_filter_->SetInputFramebuffer(framebuffer,
+                                                       rotation_mode, 1);
+  } else {
+    vertical_high_pass_filter_->SetInputFramebuffer(framebuffer, rotation_mode,
+                                                    1);
+  }
+}
+
+std::shared_ptr<Source> BoxHighPassFilter::GetMeanOutput() const {
+  if (engine_ == SUMMED_AREA_TABLE) {
+    return summed_area_high_pass_filter_->GetOutput(1);
   }
+  return vertical_high_pass_filter_->GetOutput(1);
 }
 
 void BoxHighPassFilter::SetRadius(float radius) {
-  box_blur_filter_->SetRadius(radius);
+  horizontal_blur_filter_->SetRadius(radius);
+  vertical_high_pass_filter_->SetRadius(radius);
+  if (summed_area_high_pass_filter_) {
+    summed_area_high_pass_filter_->SetRadius(GetBoxRadius());
+  }
 }
 
 void BoxHighPassFilter::SetDelta(float delta) {
-  box_difference_filter_->SetDelta(delta);
+  delta_ = delta;
+  vertical_high_pass_filter_->SetDelta(delta);
+  if (summed_area_high_pass_filter_) {
+    summed_area_high_pass_filter_->SetDelta(delta);
+  }
+}
+
+void BoxHighPassFilter::SetEngine(Engine engine) {
+  if (engine == engine_ ||
+      (engine != SEPARABLE && engine != SUMMED_AREA_TABLE)) {
+    return;
+  }
+  if (engine == SUMMED_AREA_TABLE && !summed_area_table_filter_) {
+    if (!SummedAreaTableFilter::IsSupported()) {
+      LOG_WARN(
+          "BoxHighPassFilter: no float render targets, staying separable");
+      return;
+    }
+    summed_area_table_filter_ = SummedAreaTableFilter::Create();
+    summed_area_high_pass_filter_ = SummedAreaBoxFilter::Create(
+        SummedAreaBoxFilter::HIGH_PASS, GetBoxRadius());
+    if (!summed_area_table_filter_ || !summed_area_high_pass_filter_) {
+      summed_area_table_filter_.reset();
+      summed_area_high_pass_filter_.reset();
+      return;
+    }
+    summed_area_high_pass_filter_->SetDelta(delta_);
+    summed_area_table_filter_->AddSink(summed_area_high_pass_filter_, 0);
+  }
+
+  std::shared_ptr<Source> mean_output = GetMeanOutput();
+  if (engine == SUMMED_AREA_TABLE) {
+    ReplaceFilter(horizontal_blur_filter_, summed_area_table_filter_);
+  } else {
+    ReplaceFilter(summed_area_table_filter_, horizontal_blur_filter_);
+  }
+  engine_ = engine;
+  MoveSinks(mean_output, GetMeanOutput());
+}
+
+int BoxHighPassFilter::GetBoxRadius() const {
+  return BoxMonoBlurFilter::GetBoxRadius(horizontal_blur_filter_->GetRadius(),
+                                         kTexelSpacing);
 }
 
 }  // namespace gpupixel
@@ -0,0 +1,91 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/box_high_pass_mono_filter.h"
+#include <algorithm>
+#include "core/gpupixel_context.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+BoxHighPassMonoFilter::BoxHighPassMonoFilter()
+    : BoxMonoBlurFilter(VERTICAL), delta_(7.07) {}
+
+BoxHighPassMonoFilter::~BoxHighPassMonoFilter() {}
+
+std::shared_ptr<BoxHighPassMonoFilter> BoxHighPassMonoFilter::Create(
+    int radius /* = 4*/) {
+  auto ret =
+      std::shared_ptr<BoxHighPassMonoFilter>(new BoxHighPassMonoFilter());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init(radius)) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool BoxHighPassMonoFilter::Init(int radius) {
+  // Two inputs and two outputs, SetRadius rebuilds the program with the same
+  return InitWithShaderString(
+      GenerateOptimizedVertexShaderString(radius, 0.0),
+      GenerateOptimizedFragmentShaderString(radius, 0.0), 2, 2);
+}
+
+std::string BoxHighPassMonoFilter::GenerateOptimizedVertexShaderString(
+    int radius,
+    float sigma) {
+  // Without a blur the base shaders would not write the outputs
+  std::string shader = BoxMonoBlurFilter::GenerateOptimizedVertexShaderString(
+      std::max(radius, 1), sigma);
+  shader.insert(shader.rfind('}'),
+                "textureCoordinate1 = inputTextureCoordinate1.xy;\n");
+  return "attribute vec4 inputTextureCoordinate1;\n"
+         "varying vec2 textureCoordinate1;\n" +
+         shader;
+}
+
+std::string BoxHighPassMonoFilter::GenerateOptimizedFragmentShaderString(
+    int radius,
+    float sigma) {
+  std::string shader = BoxMonoBlurFilter::GenerateOptimizedFragmentShaderString(
+      std::max(radius, 1), sigma);
+  const std::string output = "gl_FragColor = sum;";
+#if defined(GPUPIXEL_GLES_SHADER)
+  shader.replace(
+      shader.rfind(output), output.size(),
+      "lowp vec3 iColor = texture2D(inputImageTexture1, "
+      "textureCoordinate1).rgb;\n"
+      "highp vec3 diffColor = (iColor - sum.rgb) * delta;\n"
+      "OUTPUT0 = vec4(min(diffColor * diffColor, 1.0), 1.0);\n"
+      "OUTPUT1 = sum;\n");
+  return "uniform sampler2D inputImageTexture1;\n"
+         "uniform highp float delta;\n"
+         "varying highp vec2 textureCoordinate1;\n" +
+         shader;
+#else
+  shader.replace(
+      shader.rfind(output), output.size(),
+      "vec3 iColor = texture2D(inputImageTexture1, textureCoordinate1).rgb;\n"
+      "vec3 diffColor = (iColor - sum.rgb) * delta;\n"
+      "OUTPUT0 = vec4(min(diffColor * diffColor, 1.0), 1.0);\n"
+      "OUTPUT1 = sum;\n");
+  return "uniform sampler2D inputImageTexture1;\n"
+         "uniform float delta;\n"
+         "varying vec2 textureCoordinate1;\n" +
+         shader;
+#endif
+}
+
+bool BoxHighPassMonoFilter::DoRender(bool updateSinks) {
+  filter_program_->SetUniformValue("delta", delta_);
+  return BoxMonoBlurFilter::DoRender(updateSinks);
+}
+
+void BoxHighPassMonoFilter::SetDelta(float delta) {
+  delta_ = delta;
+}
+
+}  // namespace gpupixel
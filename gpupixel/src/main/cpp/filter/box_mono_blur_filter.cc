@@ -48,10 +48,16 @@ void BoxMonoBlurFilter::SetRadius(int radius) {
       filter_program_ = 0;
     }
     InitWithShaderString(GenerateOptimizedVertexShaderString(radius_, 0.0),
-                         GenerateOptimizedFragmentShaderString(radius_, 0.0));
+                         GenerateOptimizedFragmentShaderString(radius_, 0.0),
+                         input_count_, output_count_);
+    GraphChanged();
   }
 }
 
+int BoxMonoBlurFilter::GetBoxRadius(int radius, float texel_spacing) {
+  return (int)std::round(radius * texel_spacing + (texel_spacing - 1) / 2);
+}
+
 std::string BoxMonoBlurFilter::GenerateOptimizedVertexShaderString(
     int radius,
     float sigma) {
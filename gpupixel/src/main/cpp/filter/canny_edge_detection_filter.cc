@@ -6,6 +6,7 @@
 
 #include "gpupixel/filter/canny_edge_detection_filter.h"
 #include "core/gpupixel_context.h"
+#include "utils/logging.h"
 namespace gpupixel {
 
 CannyEdgeDetectionFilter::CannyEdgeDetectionFilter()
@@ -13,7 +14,10 @@ CannyEdgeDetectionFilter::CannyEdgeDetectionFilter()
       blur_filter_(0),
       edge_detection_filter_(0),
       non_maximum_suppression_filter_(0),
-      weak_pixel_inclusion_filter_(0) {}
+      weak_pixel_inclusion_filter_(0),
+      horizontal_pass_filter_(0),
+      vertical_pass_filter_(0),
+      engine_(SEPARATE_PASSES) {}
 
 CannyEdgeDetectionFilter::~CannyEdgeDetectionFilter() {}
 
@@ -40,7 +44,7 @@ bool CannyEdgeDetectionFilter::Init() {
   blur_filter_ = SingleComponentGaussianBlurFilter::Create();
 
   // 3. soble edge detection
-  edge_detection_filter_ = DirectionalSobelEdgeDetectionFilter::Create();
+  edge_detection_filter_ = DirectionalSobelEdgeDetectionFilter::Create(true);
 
   // 4. apply non-maximum suppression
   non_maximum_suppression_filter_ =
@@ -55,7 +59,60 @@ bool CannyEdgeDetectionFilter::Init() {
       ->AddSink(weak_pixel_inclusion_filter_);
   AddFilter(grayscale_filter_);
 
+  RegisterProperty("engine", (int)SEPARATE_PASSES,
+                   "0: separate passes, 1: fused blur and Sobel",
+                   [this](int& val) { SetEngine((Engine)val); });
   return true;
 }
 
+void CannyEdgeDetectionFilter::SetEngine(Engine engine) {
+  if (engine == engine_ || (engine != SEPARATE_PASSES && engine != FUSED)) {
+    return;
+  }
+  if (engine == FUSED && !horizontal_pass_filter_) {
+    if (!GPUPixelContext::GetInstance()->IsFloatRenderTargetAvailable()) {
+      LOG_WARN("CannyEdgeDetectionFilter: float render targets unavailable");
+      return;
+    }
+    horizontal_pass_filter_ =
+        GaussianSobelPassFilter::Create(GaussianSobelPassFilter::HORIZONTAL);
+    vertical_pass_filter_ = GaussianSobelPassFilter::Create(
+        GaussianSobelPassFilter::VERTICAL, true);
+    if (!horizontal_pass_filter_ || !vertical_pass_filter_) {
+      horizontal_pass_filter_ = nullptr;
+      vertical_pass_filter_ = nullptr;
+      return;
+    }
+    horizontal_pass_filter_->AddSink(vertical_pass_filter_);
+  }
+
+  // Non-maximum suppression and hysteresis stay, only their input moves
+  if (engine == FUSED) {
+    edge_detection_filter_->RemoveSink(non_maximum_suppression_filter_);
+    vertical_pass_filter_->AddSink(non_maximum_suppression_filter_);
+    FilterGroup::MoveSinks(edge_detection_filter_->GetOutput(1),
+                           vertical_pass_filter_->GetOutput(1));
+    // The idle engine is not rendered and would keep its gradient target
+    edge_detection_filter_->GetOutput(1)->SetFramebuffer(nullptr);
+    RemoveFilter(grayscale_filter_);
+    AddFilter(horizontal_pass_filter_);
+  } else {
+    vertical_pass_filter_->RemoveSink(non_maximum_suppression_filter_);
+    edge_detection_filter_->AddSink(non_maximum_suppression_filter_);
+    FilterGroup::MoveSinks(vertical_pass_filter_->GetOutput(1),
+                           edge_detection_filter_->GetOutput(1));
+    vertical_pass_filter_->GetOutput(1)->SetFramebuffer(nullptr);
+    RemoveFilter(horizontal_pass_filter_);
+    AddFilter(grayscale_filter_);
+  }
+  engine_ = engine;
+}
+
+std::shared_ptr<Source> CannyEdgeDetectionFilter::GetGradientOutput() const {
+  if (engine_ == FUSED) {
+    return vertical_pass_filter_->GetOutput(1);
+  }
+  return edge_detection_filter_->GetOutput(1);
+}
+
 }  // namespace gpupixel
@@ -58,8 +58,15 @@ const std::string kDirectionalSobelEdgeDetectionFragmentShaderString =
           normalizedDirection = (normalizedDirection + 1.0) *
                                 0.5;  // Place -1.0 - 1.0 within 0 - 1.0
 
+#ifdef GRADIENT_OUTPUT
+          OUTPUT0 = vec4(gradientMagnitude, normalizedDirection.x,
+                         normalizedDirection.y, 1.0);
+          // Signed gradients of up to 4 placed within 0 - 1.0
+          OUTPUT1 = vec4(gradientDirection * 0.125 + 0.5, 0.0, 1.0);
+#else
           gl_FragColor = vec4(gradientMagnitude, normalizedDirection.x,
                               normalizedDirection.y, 1.0);
+#endif
         })";
 #elif defined(GPUPIXEL_GL_SHADER)
 const std::string kDirectionalSobelEdgeDetectionFragmentShaderString =
@@ -111,29 +118,41 @@ const std::string kDirectionalSobelEdgeDetectionFragmentShaderString =
           normalizedDirection = (normalizedDirection + 1.0) *
                                 0.5;  // Place -1.0 - 1.0 within 0 - 1.0
 
+#ifdef GRADIENT_OUTPUT
+          OUTPUT0 = vec4(gradientMagnitude, normalizedDirection.x,
+                         normalizedDirection.y, 1.0);
+          // Signed gradients of up to 4 placed within 0 - 1.0
+          OUTPUT1 = vec4(gradientDirection * 0.125 + 0.5, 0.0, 1.0);
+#else
           gl_FragColor = vec4(gradientMagnitude, normalizedDirection.x,
                               normalizedDirection.y, 1.0);
+#endif
         })";
 #endif
 
 std::shared_ptr<DirectionalSobelEdgeDetectionFilter>
-DirectionalSobelEdgeDetectionFilter::Create() {
+DirectionalSobelEdgeDetectionFilter::Create(
+    bool gradient_output /* = false*/) {
   auto ret = std::shared_ptr<DirectionalSobelEdgeDetectionFilter>(
       new DirectionalSobelEdgeDetectionFilter());
   gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
-    if (ret && !ret->Init()) {
+    if (ret && !ret->Init(gradient_output)) {
       ret.reset();
     }
   });
   return ret;
 }
 
-bool DirectionalSobelEdgeDetectionFilter::Init() {
-  if (InitWithFragmentShaderString(
-          kDirectionalSobelEdgeDetectionFragmentShaderString)) {
-    return true;
+bool DirectionalSobelEdgeDetectionFilter::Init(
+    bool gradient_output /* = false*/) {
+  if (!gradient_output) {
+    return InitWithFragmentShaderString(
+        kDirectionalSobelEdgeDetectionFragmentShaderString);
   }
-  return false;
+  return InitWithFragmentShaderString(
+      "#define GRADIENT_OUTPUT\n" +
+          kDirectionalSobelEdgeDetectionFragmentShaderString,
+      1, 2);
 }
 
 }  // namespace gpupixel
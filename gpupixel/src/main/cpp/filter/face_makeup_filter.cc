@@ -5,6 +5,8 @@
  */
 
 #include "gpupixel/filter/face_makeup_filter.h"
+#include <algorithm>
+#include <atomic>
 #include "core/gpupixel_context.h"
 #include "gpupixel/source/source_image.h"
 #include "utils/util.h"
@@ -22,14 +24,17 @@ const std::string FaceMakeupFilterVertexShaderString = R"(
     })";
 #if defined(GPUPIXEL_GLES_SHADER)
 const std::string FaceMakeupFilterFragmentShaderString = R"(
-    precision mediump float; 
+    precision mediump float;
+    #define MAX_LAYERS 4
     varying highp vec2 textureCoordinate;
     varying highp vec2 textureCoordinate2;
     uniform sampler2D inputImageTexture;
-    uniform sampler2D inputImageTexture2;  // mouth
+    uniform sampler2D inputImageTexture2;  // layer atlas
 
-    uniform float intensity;
-    uniform int blendMode;
+    // Per layer the template to atlas transform (offset.xy, scale.xy), the
+    // atlas bounds of the layer (min.xy, max.xy) and (level, blend mode)
+    uniform int layerCount;
+    uniform highp vec4 layers[MAX_LAYERS * 3];
 
     float blendHardLight(float base, float blend) {
       return blend < 0.5 ? (2.0 * base * blend)
@@ -75,30 +80,46 @@ const std::string FaceMakeupFilterFragmentShaderString = R"(
     }
 
     void main() {
-      vec4 fgColor = texture2D(inputImageTexture2, textureCoordinate);  // mouth
-      fgColor = fgColor * intensity;
-      vec4 bgColor = texture2D(inputImageTexture, textureCoordinate2);
-      if (fgColor.a == 0.0) {
-        gl_FragColor = bgColor;
-        return;
+      vec4 color = texture2D(inputImageTexture, textureCoordinate2);
+      // Loop indices only, so the uniform array index stays a
+      // constant-index expression as GLSL ES 1.0 requires
+      for (int i = 0; i < MAX_LAYERS; i++) {
+        if (i >= layerCount) {
+          break;
+        }
+        highp vec4 transform = layers[i * 3];
+        highp vec4 bounds = layers[i * 3 + 1];
+        vec4 params = layers[i * 3 + 2];
+        // Clamped like the edge of a texture of its own
+        highp vec2 atlasCoordinate =
+            clamp(textureCoordinate * transform.zw + transform.xy, bounds.xy,
+                  bounds.zw);
+        vec4 fgColor = texture2D(inputImageTexture2, atlasCoordinate);
+        fgColor = fgColor * params.x;
+        if (fgColor.a == 0.0) {
+          continue;
+        }
+
+        vec3 blended =
+            blendFunc(color.rgb,
+                      clamp(fgColor.rgb * (1.0 / fgColor.a), 0.0, 1.0),
+                      int(params.y + 0.5));
+        color.rgb = color.rgb * (1.0 - fgColor.a) + blended * fgColor.a;
       }
-
-      vec3 color = blendFunc(bgColor.rgb,
-                             clamp(fgColor.rgb * (1.0 / fgColor.a), 0.0, 1.0),
-                             blendMode);
-      //    color = color * intensity;
-      gl_FragColor =
-          vec4(bgColor.rgb * (1.0 - fgColor.a) + color.rgb * fgColor.a, 1.0);
+      gl_FragColor = vec4(color.rgb, 1.0);
     })";
 #elif defined(GPUPIXEL_GL_SHADER)
 const std::string FaceMakeupFilterFragmentShaderString = R"(
+    #define MAX_LAYERS 4
     varying vec2 textureCoordinate;
     varying vec2 textureCoordinate2;
     uniform sampler2D inputImageTexture;
-    uniform sampler2D inputImageTexture2;  // mouth
+    uniform sampler2D inputImageTexture2;  // layer atlas
 
-    uniform float intensity;
-    uniform int blendMode;
+    // Per layer the template to atlas transform (offset.xy, scale.xy), the
+    // atlas bounds of the layer (min.xy, max.xy) and (level, blend mode)
+    uniform int layerCount;
+    uniform vec4 layers[MAX_LAYERS * 3];
 
     float blendHardLight(float base, float blend) {
       return blend < 0.5 ? (2.0 * base * blend)
@@ -144,25 +165,60 @@ const std::string FaceMakeupFilterFragmentShaderString = R"(
     }
 
     void main() {
-      vec4 fgColor = texture2D(inputImageTexture2, textureCoordinate);  // mouth
-      fgColor = fgColor * intensity;
-      vec4 bgColor = texture2D(inputImageTexture, textureCoordinate2);
-      if (fgColor.a == 0.0) {
-        gl_FragColor = bgColor;
-        return;
+      vec4 color = texture2D(inputImageTexture, textureCoordinate2);
+      // Loop indices only, so the uniform array index stays a
+      // constant-index expression as GLSL ES 1.0 requires
+      for (int i = 0; i < MAX_LAYERS; i++) {
+        if (i >= layerCount) {
+          break;
+        }
+        vec4 transform = layers[i * 3];
+        vec4 bounds = layers[i * 3 + 1];
+        vec4 params = layers[i * 3 + 2];
+        // Clamped like the edge of a texture of its own
+        vec2 atlasCoordinate =
+            clamp(textureCoordinate * transform.zw + transform.xy, bounds.xy,
+                  bounds.zw);
+        vec4 fgColor = texture2D(inputImageTexture2, atlasCoordinate);
+        fgColor = fgColor * params.x;
+        if (fgColor.a == 0.0) {
+          continue;
+        }
+
+        vec3 blended =
+            blendFunc(color.rgb,
+                      clamp(fgColor.rgb * (1.0 / fgColor.a), 0.0, 1.0),
+                      int(params.y + 0.5));
+        color.rgb = color.rgb * (1.0 - fgColor.a) + blended * fgColor.a;
       }
-
-      vec3 color = blendFunc(bgColor.rgb,
-                             clamp(fgColor.rgb * (1.0 / fgColor.a), 0.0, 1.0),
-                             blendMode);
-      //    color = color * intensity;
-      gl_FragColor =
-          vec4(bgColor.rgb * (1.0 - fgColor.a) + color.rgb * fgColor.a, 1.0);
+      gl_FragColor = vec4(color.rgb, 1.0);
     })";
 #endif
-FaceMakeupFilter::FaceMakeupFilter() {}
-
-FaceMakeupFilter::~FaceMakeupFilter() {}
+namespace {
+// The template coordinates are relative to a 1280 pixel wide template
+constexpr float kTemplateSize = 1280;
+// Blend mode of every layer, multiply
+constexpr int kLayerBlendMode = 15;
+// Empty pixels between two layers of the atlas, so linear filtering at the
+// edge of one does not pick up the next
+constexpr int kAtlasPadding = 2;
+// vec4 uniforms per layer
+constexpr int kLayerUniforms = 3;
+}  // namespace
+
+constexpr int FaceMakeupFilter::kMaxLayers;
+
+FaceMakeupFilter::FaceMakeupFilter()
+    : landmarks_pool_(FaceLandmarksPool::Create()) {}
+
+FaceMakeupFilter::~FaceMakeupFilter() {
+  uint32_t buffers[] = {texture_coordinate_buffer_, index_buffer_,
+                        position_buffer_};
+  if (buffers[0] || buffers[1] || buffers[2]) {
+    GPUPixelContext::GetInstance()->SyncRunWithContext(
+        [&] { GL_CALL(glDeleteBuffers(3, buffers)); });
+  }
+}
 
 std::shared_ptr<FaceMakeupFilter> FaceMakeupFilter::Create() {
   auto ret = std::shared_ptr<FaceMakeupFilter>(new FaceMakeupFilter());
@@ -192,6 +248,8 @@ bool FaceMakeupFilter::Init() {
   filter_tex_coord_attribute2_ =
       filter_program2_->GetAttribLocation("inputTextureCoordinate");
 
+  InitFaceMesh();
+
   RegisterProperty("blend_level", 0,
                    "The smoothing of filter with range between -1 and 1.",
                    [this](float& val) { SetBlendLevel(val); });
@@ -199,25 +257,178 @@ bool FaceMakeupFilter::Init() {
   std::vector<float> defaut;
   RegisterProperty("face_landmark", defaut,
                    "The face landmark of filter with range between -1 and 1.",
-                   [this](std::vector<float> val) { SetFaceLandmarks(val); });
+                   [this](std::vector<float>& val) { SetFaceLandmarks(val); });
   return true;
 }
 
-void FaceMakeupFilter::SetFaceLandmarks(std::vector<float> landmarks) {
-  if (landmarks.size() == 0) {
-    has_face_ = false;
+void FaceMakeupFilter::SetFaceLandmarks(const std::vector<float>& landmarks) {
+  // Never the slot a render in flight reads
+  std::shared_ptr<FaceLandmarks> result = landmarks_pool_->Acquire();
+  result->FromInterleaved(landmarks.data(), landmarks.size());
+  std::atomic_store(&face_landmarks_,
+                    std::shared_ptr<const FaceLandmarks>(result));
+}
+
+void FaceMakeupFilter::SetFaceLandmarks(
+    std::shared_ptr<const FaceLandmarks> landmarks) {
+  // Set from the detector thread while the GL thread renders
+  std::atomic_store(&face_landmarks_, landmarks);
+}
+
+FaceMakeupFilter::Layer& FaceMakeupFilter::GetLayer(int layer) {
+  if (layers_.size() <= (size_t)layer) {
+    layers_.resize(layer + 1);
+  }
+  return layers_[layer];
+}
+
+void FaceMakeupFilter::SetImageTexture(std::shared_ptr<SourceImage> texture) {
+  GetLayer(0).texture = texture;
+  atlas_dirty_ = true;
+}
+
+void FaceMakeupFilter::SetTextureBounds(FrameBounds bounds) {
+  GetLayer(0).bounds = bounds;
+  atlas_dirty_ = true;
+}
+
+int FaceMakeupFilter::AddLayer(std::shared_ptr<SourceImage> texture,
+                               FrameBounds bounds) {
+  if (!texture || layers_.size() >= (size_t)kMaxLayers) {
+    return -1;
+  }
+  Layer layer;
+  layer.texture = texture;
+  layer.bounds = bounds;
+  layers_.push_back(layer);
+  atlas_dirty_ = true;
+  return (int)layers_.size() - 1;
+}
+
+void FaceMakeupFilter::SetLayerLevel(int layer, float level) {
+  if (layer < 0 || (size_t)layer >= layers_.size()) {
     return;
   }
-  std::vector<float> vect;
-  for (auto it : landmarks) {
-    vect.push_back(2 * it - 1);
+  layers_[layer].level = level;
+}
+
+void FaceMakeupFilter::InitFaceMesh() {
+  auto coord = FaceTextureCoordinates();
+  auto face_indexs = GetFaceIndexs();
+  size_t point_count = coord.size() / 2;
+  face_index_count_ = face_indexs.size();
+
+  // Enough for the most faces, a frame draws the first face_count copies
+  std::vector<float> texture_coordinates;
+  std::vector<uint16_t> indexs;
+  for (int face = 0; face < FaceLandmarks::kMaxFaces; face++) {
+    texture_coordinates.insert(texture_coordinates.end(), coord.begin(),
+                               coord.end());
+    // Indices of later faces point at their own landmark block
+    for (uint32_t index : face_indexs) {
+      indexs.push_back((uint16_t)(index + face * point_count));
+    }
   }
-  face_landmarks_ = vect;
-  has_face_ = true;
+
+  uint32_t buffers[3];
+  GL_CALL(glGenBuffers(3, buffers));
+  texture_coordinate_buffer_ = buffers[0];
+  index_buffer_ = buffers[1];
+  position_buffer_ = buffers[2];
+
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, texture_coordinate_buffer_));
+  GL_CALL(glBufferData(GL_ARRAY_BUFFER,
+                       texture_coordinates.size() * sizeof(float),
+                       texture_coordinates.data(), GL_STATIC_DRAW));
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, position_buffer_));
+  GL_CALL(glBufferData(GL_ARRAY_BUFFER, sizeof(vertex_positions_), nullptr,
+                       GL_STREAM_DRAW));
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+  GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_));
+  GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                       indexs.size() * sizeof(uint16_t), indexs.data(),
+                       GL_STATIC_DRAW));
+  GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
 
-void FaceMakeupFilter::SetImageTexture(std::shared_ptr<SourceImage> texture) {
-  image_texture_ = texture;
+void FaceMakeupFilter::UpdateAtlas() {
+  if (!atlas_dirty_) {
+    return;
+  }
+  atlas_dirty_ = false;
+  atlas_.reset();
+  layer_uniforms_.clear();
+
+  // All layers side by side in one row
+  int atlas_width = 0;
+  int atlas_height = 0;
+  for (auto& layer : layers_) {
+    if (!layer.texture) {
+      continue;
+    }
+    layer.atlas_x = atlas_width;
+    layer.atlas_y = 0;
+    atlas_width += layer.texture->GetWidth() + kAtlasPadding;
+    atlas_height = std::max(atlas_height, layer.texture->GetHeight());
+  }
+  if (atlas_width == 0 || atlas_height == 0) {
+    return;
+  }
+
+  atlas_ = GPUPixelContext::GetInstance()
+               ->GetFramebufferFactory()
+               ->CreateFramebuffer(atlas_width, atlas_height);
+  atlas_->Activate();
+  GL_CALL(glClearColor(0, 0, 0, 0));
+  GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
+
+  static const float imageVertices[] = {
+      -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f,
+  };
+  GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program2_);
+  GL_CALL(glActiveTexture(GL_TEXTURE4));
+  filter_program2_->SetUniformValue("inputImageTexture", 4);
+  GL_CALL(glEnableVertexAttribArray(filter_position_attribute2_));
+  GL_CALL(glVertexAttribPointer(filter_position_attribute2_, 2, GL_FLOAT, 0, 0,
+                                imageVertices));
+  GL_CALL(glEnableVertexAttribArray(filter_tex_coord_attribute2_));
+  GL_CALL(glVertexAttribPointer(filter_tex_coord_attribute2_, 2, GL_FLOAT, 0, 0,
+                                GetTextureCoordinate(NoRotation)));
+
+  for (const auto& layer : layers_) {
+    if (!layer.texture) {
+      continue;
+    }
+    float width = (float)layer.texture->GetWidth();
+    float height = (float)layer.texture->GetHeight();
+    GL_CALL(glViewport(layer.atlas_x, layer.atlas_y, (int)width, (int)height));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D,
+                          layer.texture->GetFramebuffer()->GetTexture()));
+    GL_CALL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
+
+    // Template coordinate -> texture coordinate of the layer -> atlas
+    const FrameBounds& bounds = layer.bounds;
+    float scale_x = width / bounds.width / atlas_width;
+    float scale_y = height / bounds.height / atlas_height;
+    const float uniforms[kLayerUniforms * 4] = {
+        layer.atlas_x / (float)atlas_width - bounds.x * scale_x,
+        layer.atlas_y / (float)atlas_height - bounds.y * scale_y,
+        kTemplateSize * scale_x,
+        kTemplateSize * scale_y,
+        (layer.atlas_x + 0.5f) / atlas_width,
+        (layer.atlas_y + 0.5f) / atlas_height,
+        (layer.atlas_x + width - 0.5f) / atlas_width,
+        (layer.atlas_y + height - 0.5f) / atlas_height,
+        // The level is filled in per frame
+        0,
+        (float)kLayerBlendMode,
+        0,
+        0};
+    layer_uniforms_.insert(layer_uniforms_.end(), uniforms,
+                           uniforms + kLayerUniforms * 4);
+  }
+  atlas_->Deactivate();
 }
 
 bool FaceMakeupFilter::DoRender(bool updateSinks) {
@@ -225,8 +436,11 @@ bool FaceMakeupFilter::DoRender(bool updateSinks) {
       -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f,
   };
 
+  UpdateAtlas();
+
   framebuffer_->Activate();
   // render origin frame --- begin -----//
+  // Layers only cover the face mesh, the rest is copied once for all layers
   GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program2_);
   GL_CALL(glClearColor(background_color_.r, background_color_.g,
                        background_color_.b, background_color_.a));
@@ -249,46 +463,67 @@ bool FaceMakeupFilter::DoRender(bool updateSinks) {
   GL_CALL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
 
   // render image --- begin --- //
-  GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program_);
-
-  GL_CALL(glEnableVertexAttribArray(filter_position_attribute_));
-  if (face_landmarks_.size() != 0) {
+  // All faces and all layers go out in one draw
+  std::shared_ptr<const FaceLandmarks> landmarks =
+      std::atomic_load(&face_landmarks_);
+  int face_count =
+      landmarks ? std::min(landmarks->face_count, FaceLandmarks::kMaxFaces) : 0;
+  int layer_count = (int)(layer_uniforms_.size() / (kLayerUniforms * 4));
+  if (face_count > 0 && layer_count > 0) {
+    GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program_);
+
+    // Landmarks become clip space positions, the only per-frame upload
+    float* position = vertex_positions_;
+    for (int i = 0; i < face_count; i++) {
+      const FaceLandmarks::Face& face = landmarks->faces[i];
+      for (int j = 0; j < FaceLandmarks::kPointCount; j++) {
+        *position++ = 2 * face.x[j] - 1;
+        *position++ = 2 * face.y[j] - 1;
+      }
+    }
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, position_buffer_));
+    GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0,
+                            (position - vertex_positions_) * sizeof(float),
+                            vertex_positions_));
+    GL_CALL(glEnableVertexAttribArray(filter_position_attribute_));
     GL_CALL(glVertexAttribPointer(filter_position_attribute_, 2, GL_FLOAT, 0, 0,
-                                  face_landmarks_.data()));
-  }
-
-  auto coord = this->FaceTextureCoordinates();
-  std::vector<float> textureCoordinates(coord.size());
-  auto point_count = coord.size() / 2;
-  for (int i = 0; i < point_count; i++) {
-    textureCoordinates[i * 2 + 0] =
-        (coord[i * 2 + 0] * 1280 - texture_bounds_.x) / texture_bounds_.width;
-    textureCoordinates[i * 2 + 1] =
-        (coord[i * 2 + 1] * 1280 - texture_bounds_.y) / texture_bounds_.height;
-  }
-  // texcoord attribute
-  GL_CALL(glEnableVertexAttribArray(filter_tex_coord_attribute_));
-  GL_CALL(glVertexAttribPointer(filter_tex_coord_attribute_, 2, GL_FLOAT, 0, 0,
-                                textureCoordinates.data()));
-
-  filter_program_->SetUniformValue("intensity", this->blend_level_);
-
-  filter_program_->SetUniformValue("blendMode", 15);
-
-  std::shared_ptr<GPUPixelFramebuffer> fb = input_framebuffers_[0].frame_buffer;
-  GL_CALL(glActiveTexture(GL_TEXTURE0));
-  GL_CALL(glBindTexture(GL_TEXTURE_2D, fb->GetTexture()));
-  filter_program_->SetUniformValue("inputImageTexture", 0);  // origin image
-
-  glActiveTexture(GL_TEXTURE3);
-  // assert(image_texture_);
-  glBindTexture(GL_TEXTURE_2D, image_texture_->GetFramebuffer()->GetTexture());
-  filter_program_->SetUniformValue("inputImageTexture2", 3);
-
-  if (has_face_) {
-    auto face_indexs = this->GetFaceIndexs();
-    glDrawElements(GL_TRIANGLES, (GLsizei)face_indexs.size(), GL_UNSIGNED_INT,
-                   face_indexs.data());
+                                  nullptr));
+
+    // texcoord attribute
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, texture_coordinate_buffer_));
+    GL_CALL(glEnableVertexAttribArray(filter_tex_coord_attribute_));
+    GL_CALL(glVertexAttribPointer(filter_tex_coord_attribute_, 2, GL_FLOAT, 0,
+                                  0, nullptr));
+    // The other filters draw from client memory
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+
+    // Layers without a texture are not in the atlas
+    int uniform_layer = 0;
+    for (const auto& layer : layers_) {
+      if (layer.texture) {
+        layer_uniforms_[(uniform_layer++ * kLayerUniforms + 2) * 4] =
+            layer.level;
+      }
+    }
+    filter_program_->SetUniformValue("layerCount", layer_count);
+    filter_program_->SetUniformVec4Array("layers", layer_uniforms_.data(),
+                                         layer_count * kLayerUniforms);
+
+    std::shared_ptr<GPUPixelFramebuffer> fb =
+        input_framebuffers_[0].frame_buffer;
+    GL_CALL(glActiveTexture(GL_TEXTURE0));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, fb->GetTexture()));
+    filter_program_->SetUniformValue("inputImageTexture", 0);  // origin image
+
+    GL_CALL(glActiveTexture(GL_TEXTURE3));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, atlas_->GetTexture()));
+    filter_program_->SetUniformValue("inputImageTexture2", 3);
+
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_));
+    GL_CALL(glDrawElements(GL_TRIANGLES,
+                           (GLsizei)(face_index_count_ * face_count),
+                           GL_UNSIGNED_SHORT, nullptr));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
   }
   framebuffer_->Deactivate();
 
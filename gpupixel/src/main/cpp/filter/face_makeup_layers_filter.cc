@@ -0,0 +1,55 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/face_makeup_layers_filter.h"
+#include "core/gpupixel_context.h"
+#include "gpupixel/filter/blusher_filter.h"
+#include "gpupixel/filter/lipstick_filter.h"
+#include "gpupixel/source/source_image.h"
+namespace gpupixel {
+
+FaceMakeupLayersFilter::FaceMakeupLayersFilter() {}
+
+std::shared_ptr<FaceMakeupLayersFilter> FaceMakeupLayersFilter::Create() {
+  auto ret =
+      std::shared_ptr<FaceMakeupLayersFilter>(new FaceMakeupLayersFilter());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init()) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool FaceMakeupLayersFilter::Init() {
+  // Later layers are drawn over the earlier ones
+  blusher_layer_ = AddLayer(BlusherFilter::CreateTexture(),
+                            BlusherFilter::GetTextureBounds());
+  lipstick_layer_ = AddLayer(LipstickFilter::CreateTexture(),
+                             LipstickFilter::GetTextureBounds());
+  if (!FaceMakeupFilter::Init()) {
+    return false;
+  }
+
+  RegisterProperty("lipstick_level", 0,
+                   "The lipstick level with range between 0 and 1.",
+                   [this](float& val) { SetLipstickLevel(val); });
+
+  RegisterProperty("blusher_level", 0,
+                   "The blusher level with range between 0 and 1.",
+                   [this](float& val) { SetBlusherLevel(val); });
+  return true;
+}
+
+void FaceMakeupLayersFilter::SetLipstickLevel(float level) {
+  SetLayerLevel(lipstick_layer_, level);
+}
+
+void FaceMakeupLayersFilter::SetBlusherLevel(float level) {
+  SetLayerLevel(blusher_layer_, level);
+}
+
+}  // namespace gpupixel
@@ -5,17 +5,72 @@
  */
 
 #include "gpupixel/filter/face_reshape_filter.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include "core/gpupixel_context.h"
 namespace gpupixel {
 
+namespace {
+// Faces reshaped per pass, must match MAX_FACES in the shader
+constexpr int kMaxFaces = FaceLandmarks::kMaxFaces;
+// (origin, target) landmark pairs pulled towards each other to thin the face
+constexpr int kThinFacePairs[9][2] = {{3, 44},  {29, 44}, {7, 45},
+                                      {25, 45}, {10, 46}, {22, 46},
+                                      {14, 49}, {18, 49}, {16, 49}};
+// (eye center, eye point) pairs, their distance sets the enlarged radius
+constexpr int kBigEyePairs[2][2] = {{74, 72}, {77, 75}};
+// vec4 warps per face
+constexpr int kWarpsPerFace = 11;
+// 16 bit indices limit the grid
+constexpr int kMaxMeshDensity = 160;
+
+// Distance with y divided by the aspect ratio, as in the shader
+float AspectDistance(float x0, float y0, float x1, float y1, float aspect) {
+  float dx = x1 - x0;
+  float dy = (y1 - y0) / aspect;
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+// CPU versions of curveWarp and enlargeEye in the fragment shader
+void CurveWarp(float* coord, const float* warp, float delta, float aspect) {
+  float radius = AspectDistance(warp[0], warp[1], warp[2], warp[3], aspect);
+  if (radius <= 0) {
+    return;
+  }
+  float ratio =
+      AspectDistance(coord[0], coord[1], warp[0], warp[1], aspect) / radius;
+  ratio = std::min(std::max(1 - ratio, 0.0f), 1.0f);
+  coord[0] -= (warp[2] - warp[0]) * delta * ratio;
+  coord[1] -= (warp[3] - warp[1]) * delta * ratio;
+}
+
+void EnlargeEye(float* coord, const float* warp, float delta, float aspect) {
+  float radius =
+      AspectDistance(warp[0], warp[1], warp[2], warp[3], aspect) * 5;
+  if (radius <= 0) {
+    return;
+  }
+  float weight =
+      AspectDistance(coord[0], coord[1], warp[0], warp[1], aspect) / radius;
+  weight = 1 - (1 - weight * weight) * delta;
+  weight = std::min(std::max(weight, 0.0f), 1.0f);
+  coord[0] = warp[0] + (coord[0] - warp[0]) * weight;
+  coord[1] = warp[1] + (coord[1] - warp[1]) * weight;
+}
+}  // namespace
+
 #if defined(GPUPIXEL_GLES_SHADER)
 const std::string kGPUPixelThinFaceFragmentShaderString = R"(
  precision highp float;
+ #define MAX_FACES 4
  varying highp vec2 textureCoordinate;
  uniform sampler2D inputImageTexture;
 
- uniform int hasFace;
- uniform float facePoints[106 * 2];
+ // Per face 9 thin-face warps followed by 2 eye warps, each packed as
+ // (origin.xy, target.xy)
+ uniform int faceCount;
+ uniform vec4 faceWarps[MAX_FACES * 11];
 
  uniform highp float aspectRatio;
  uniform float thinFaceDelta;
@@ -49,71 +104,48 @@ const std::string kGPUPixelThinFaceFragmentShaderString = R"(
      return result;
  }
 
- vec2 thinFace(vec2 currentCoordinate) {
-
-     vec2 faceIndexs[9];
-     faceIndexs[0] = vec2(3., 44.);
-     faceIndexs[1] = vec2(29., 44.);
-     faceIndexs[2] = vec2(7., 45.);
-     faceIndexs[3] = vec2(25., 45.);
-     faceIndexs[4] = vec2(10., 46.);
-     faceIndexs[5] = vec2(22., 46.);
-     faceIndexs[6] = vec2(14., 49.);
-     faceIndexs[7] = vec2(18., 49.);
-     faceIndexs[8] = vec2(16., 49.);
-
-     for(int i = 0; i < 9; i++)
-     {
-         int originIndex = int(faceIndexs[i].x);
-         int targetIndex = int(faceIndexs[i].y);
-         vec2 originPoint = vec2(facePoints[originIndex * 2], facePoints[originIndex * 2 + 1]);
-         vec2 targetPoint = vec2(facePoints[targetIndex * 2], facePoints[targetIndex * 2 + 1]);
-         currentCoordinate = curveWarp(currentCoordinate, originPoint, targetPoint, thinFaceDelta);
-     }
-     return currentCoordinate;
- }
-
- vec2 bigEye(vec2 currentCoordinate) {
-
-     vec2 faceIndexs[2];
-     faceIndexs[0] = vec2(74., 72.);
-     faceIndexs[1] = vec2(77., 75.);
-
-     for(int i = 0; i < 2; i++)
-     {
-         int originIndex = int(faceIndexs[i].x);
-         int targetIndex = int(faceIndexs[i].y);
-
-         vec2 originPoint = vec2(facePoints[originIndex * 2], facePoints[originIndex * 2 + 1]);
-         vec2 targetPoint = vec2(facePoints[targetIndex * 2], facePoints[targetIndex * 2 + 1]);
-
-         float radius = distance(vec2(targetPoint.x, targetPoint.y / aspectRatio), vec2(originPoint.x, originPoint.y / aspectRatio));
-         radius = radius * 5.;
-         currentCoordinate = enlargeEye(currentCoordinate, originPoint, radius, bigEyeDelta);
-     }
-     return currentCoordinate;
- }
-
  void main()
  {
      vec2 positionToUse = textureCoordinate;
 
-     if (hasFace == 1) {
-         positionToUse = thinFace(positionToUse);
-         positionToUse = bigEye(positionToUse);
+     // Loop indices only, so the uniform array index stays a constant-index
+     // expression as GLSL ES 1.0 requires
+     for (int face = 0; face < MAX_FACES; face++) {
+         if (face >= faceCount) {
+             break;
+         }
+
+         // thin face
+         for (int i = 0; i < 9; i++) {
+             vec4 warp = faceWarps[face * 11 + i];
+             positionToUse = curveWarp(positionToUse, warp.xy, warp.zw, thinFaceDelta);
+         }
+
+         // big eye
+         for (int i = 9; i < 11; i++) {
+             vec4 warp = faceWarps[face * 11 + i];
+             vec2 originPoint = warp.xy;
+             vec2 targetPoint = warp.zw;
+
+             float radius = distance(vec2(targetPoint.x, targetPoint.y / aspectRatio), vec2(originPoint.x, originPoint.y / aspectRatio));
+             radius = radius * 5.;
+             positionToUse = enlargeEye(positionToUse, originPoint, radius, bigEyeDelta);
+         }
      }
 
      gl_FragColor = texture2D(inputImageTexture, positionToUse);
-
  }
  )";
 #elif defined(GPUPIXEL_GL_SHADER)
 const std::string kGPUPixelThinFaceFragmentShaderString = R"(
+ #define MAX_FACES 4
  varying vec2 textureCoordinate;
  uniform sampler2D inputImageTexture;
 
- uniform int hasFace;
- uniform float facePoints[106 * 2];
+ // Per face 9 thin-face warps followed by 2 eye warps, each packed as
+ // (origin.xy, target.xy)
+ uniform int faceCount;
+ uniform vec4 faceWarps[MAX_FACES * 11];
 
  uniform float aspectRatio;
  uniform float thinFaceDelta;
@@ -147,58 +179,33 @@ const std::string kGPUPixelThinFaceFragmentShaderString = R"(
      return result;
  }
 
- vec2 thinFace(vec2 currentCoordinate) {
-
-     vec2 faceIndexs[9];
-     faceIndexs[0] = vec2(3., 44.);
-     faceIndexs[1] = vec2(29., 44.);
-     faceIndexs[2] = vec2(7., 45.);
-     faceIndexs[3] = vec2(25., 45.);
-     faceIndexs[4] = vec2(10., 46.);
-     faceIndexs[5] = vec2(22., 46.);
-     faceIndexs[6] = vec2(14., 49.);
-     faceIndexs[7] = vec2(18., 49.);
-     faceIndexs[8] = vec2(16., 49.);
-
-     for(int i = 0; i < 9; i++)
-     {
-         int originIndex = int(faceIndexs[i].x);
-         int targetIndex = int(faceIndexs[i].y);
-         vec2 originPoint = vec2(facePoints[originIndex * 2], facePoints[originIndex * 2 + 1]);
-         vec2 targetPoint = vec2(facePoints[targetIndex * 2], facePoints[targetIndex * 2 + 1]);
-         currentCoordinate = curveWarp(currentCoordinate, originPoint, targetPoint, thinFaceDelta);
-     }
-     return currentCoordinate;
- }
-
- vec2 bigEye(vec2 currentCoordinate) {
-
-     vec2 faceIndexs[2];
-     faceIndexs[0] = vec2(74., 72.);
-     faceIndexs[1] = vec2(77., 75.);
-
-     for(int i = 0; i < 2; i++)
-     {
-         int originIndex = int(faceIndexs[i].x);
-         int targetIndex = int(faceIndexs[i].y);
-
-         vec2 originPoint = vec2(facePoints[originIndex * 2], facePoints[originIndex * 2 + 1]);
-         vec2 targetPoint = vec2(facePoints[targetIndex * 2], facePoints[targetIndex * 2 + 1]);
-
-         float radius = distance(vec2(targetPoint.x, targetPoint.y / aspectRatio), vec2(originPoint.x, originPoint.y / aspectRatio));
-         radius = radius * 5.;
-         currentCoordinate = enlargeEye(currentCoordinate, originPoint, radius, bigEyeDelta);
-     }
-     return currentCoordinate;
- }
-
  void main()
  {
      vec2 positionToUse = textureCoordinate;
 
-     if (hasFace == 1) {
-         positionToUse = thinFace(positionToUse);
-         positionToUse = bigEye(positionToUse);
+     // Loop indices only, so the uniform array index stays a constant-index
+     // expression as GLSL ES 1.0 requires
+     for (int face = 0; face < MAX_FACES; face++) {
+         if (face >= faceCount) {
+             break;
+         }
+
+         // thin face
+         for (int i = 0; i < 9; i++) {
+             vec4 warp = faceWarps[face * 11 + i];
+             positionToUse = curveWarp(positionToUse, warp.xy, warp.zw, thinFaceDelta);
+         }
+
+         // big eye
+         for (int i = 9; i < 11; i++) {
+             vec4 warp = faceWarps[face * 11 + i];
+             vec2 originPoint = warp.xy;
+             vec2 targetPoint = warp.zw;
+
+             float radius = distance(vec2(targetPoint.x, targetPoint.y / aspectRatio), vec2(originPoint.x, originPoint.y / aspectRatio));
+             radius = radius * 5.;
+             positionToUse = enlargeEye(positionToUse, originPoint, radius, bigEyeDelta);
+         }
      }
 
      gl_FragColor = texture2D(inputImageTexture, positionToUse);
@@ -206,9 +213,15 @@ const std::string kGPUPixelThinFaceFragmentShaderString = R"(
  )";
 #endif
 
-FaceReshapeFilter::FaceReshapeFilter() {}
+FaceReshapeFilter::FaceReshapeFilter()
+    : landmarks_pool_(FaceLandmarksPool::Create()) {}
 
-FaceReshapeFilter::~FaceReshapeFilter() {}
+FaceReshapeFilter::~FaceReshapeFilter() {
+  if (mesh_program_) {
+    delete mesh_program_;
+    mesh_program_ = nullptr;
+  }
+}
 
 std::shared_ptr<FaceReshapeFilter> FaceReshapeFilter::Create() {
   auto ret = std::shared_ptr<FaceReshapeFilter>(new FaceReshapeFilter());
@@ -232,10 +245,14 @@ bool FaceReshapeFilter::Init() {
                    "The smoothing of filter with range between -1 and 1.",
                    [this](float& val) { SetEyeZoomLevel(val); });
 
+  RegisterProperty("warp_mode", (int)PER_PIXEL,
+                   "0: warp every pixel, 1: warp the vertices of a mesh",
+                   [this](int& val) { SetWarpMode((WarpMode)val); });
+
   std::vector<float> defaut;
   RegisterProperty("face_landmark", defaut,
                    "The face landmark of filter with range between -1 and 1.",
-                   [this](std::vector<float> val) { SetFaceLandmarks(val); });
+                   [this](std::vector<float>& val) { SetFaceLandmarks(val); });
 
   this->thin_face_delta_ = 0.0;
   // [0, 0.15]
@@ -243,14 +260,19 @@ bool FaceReshapeFilter::Init() {
   return true;
 }
 
-void FaceReshapeFilter::SetFaceLandmarks(std::vector<float> landmarks) {
-  if (landmarks.size() == 0) {
-    has_face_ = false;
-    return;
-  }
+void FaceReshapeFilter::SetFaceLandmarks(const std::vector<float>& landmarks) {
+  // Filled before it is published, the render thread may still be reading
+  // the previous landmarks
+  std::shared_ptr<FaceLandmarks> result = landmarks_pool_->Acquire();
+  result->FromInterleaved(landmarks.data(), landmarks.size());
+  std::atomic_store(&face_landmarks_,
+                    std::shared_ptr<const FaceLandmarks>(result));
+}
 
-  face_landmarks_ = landmarks;
-  has_face_ = true;
+void FaceReshapeFilter::SetFaceLandmarks(
+    std::shared_ptr<const FaceLandmarks> landmarks) {
+  // Set from the detector thread while the GL thread renders
+  std::atomic_store(&face_landmarks_, landmarks);
 }
 
 bool FaceReshapeFilter::DoRender(bool updateSinks) {
@@ -261,14 +283,164 @@ bool FaceReshapeFilter::DoRender(bool updateSinks) {
 
   filter_program_->SetUniformValue("bigEyeDelta", this->big_eye_delta_);
 
-  filter_program_->SetUniformValue("hasFace", has_face_);
-  if (has_face_) {
-    filter_program_->SetUniformValue("facePoints", face_landmarks_.data(),
-                                     static_cast<int>(face_landmarks_.size()));
+  // Only the landmark pairs each face is warped with are uploaded
+  std::shared_ptr<const FaceLandmarks> landmarks =
+      std::atomic_load(&face_landmarks_);
+  int face_count = landmarks ? std::min(landmarks->face_count, kMaxFaces) : 0;
+  float* warp = face_warps_;
+  for (int i = 0; i < face_count; i++) {
+    const FaceLandmarks::Face& face = landmarks->faces[i];
+    auto pack = [&warp, &face](const int pair[2]) {
+      *warp++ = face.x[pair[0]];
+      *warp++ = face.y[pair[0]];
+      *warp++ = face.x[pair[1]];
+      *warp++ = face.y[pair[1]];
+    };
+    for (const auto& pair : kThinFacePairs) {
+      pack(pair);
+    }
+    for (const auto& pair : kBigEyePairs) {
+      pack(pair);
+    }
+  }
+
+  if (warp_mode_ == MESH) {
+    return RenderMesh(face_count, updateSinks);
+  }
+
+  filter_program_->SetUniformValue("faceCount", face_count);
+  if (face_count > 0) {
+    filter_program_->SetUniformVec4Array("faceWarps", face_warps_,
+                                         face_count * kWarpsPerFace);
   }
   return Filter::DoRender(updateSinks);
 }
 
+bool FaceReshapeFilter::RenderMesh(int face_count, bool updateSinks) {
+  if (!mesh_program_) {
+    mesh_program_ = GPUPixelGLProgram::CreateWithShaderString(
+        kDefaultVertexShader, kDefaultFragmentShader);
+    mesh_position_attribute_ = mesh_program_->GetAttribLocation("position");
+    mesh_tex_coord_attribute_ =
+        mesh_program_->GetAttribLocation("inputTextureCoordinate");
+  }
+
+  const InputFrameBufferInfo& input = input_framebuffers_[0];
+  int width = framebuffer_->GetWidth();
+  int height = framebuffer_->GetHeight();
+  UpdateMesh(width, height, input.rotation_mode);
+  WarpMesh(face_count, (float)width / height);
+
+  GPUPixelContext::GetInstance()->SetActiveGlProgram(mesh_program_);
+  ActivateOutputs();
+  GL_CALL(glClearColor(background_color_.r, background_color_.g,
+                       background_color_.b, background_color_.a));
+  GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
+
+  GL_CALL(glActiveTexture(GL_TEXTURE0));
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, input.frame_buffer->GetTexture()));
+  mesh_program_->SetUniformValue("inputImageTexture", 0);
+
+  GL_CALL(glEnableVertexAttribArray(mesh_position_attribute_));
+  GL_CALL(glVertexAttribPointer(mesh_position_attribute_, 2, GL_FLOAT, 0, 0,
+                                mesh_positions_.data()));
+  GL_CALL(glEnableVertexAttribArray(mesh_tex_coord_attribute_));
+  GL_CALL(glVertexAttribPointer(mesh_tex_coord_attribute_, 2, GL_FLOAT, 0, 0,
+                                mesh_texture_coordinates_.data()));
+  GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)mesh_indexs_.size(),
+                         GL_UNSIGNED_SHORT, mesh_indexs_.data()));
+
+  DeactivateOutputs();
+  return Source::DoRender(updateSinks);
+}
+
+void FaceReshapeFilter::UpdateMesh(int width, int height,
+                                   RotationMode rotation) {
+  float longer = (float)std::max(width, height);
+  int columns = std::max(1, (int)std::round(mesh_density_ * width / longer));
+  int rows = std::max(1, (int)std::round(mesh_density_ * height / longer));
+  if (columns == mesh_columns_ && rows == mesh_rows_ &&
+      width == mesh_width_ && height == mesh_height_ &&
+      rotation == mesh_rotation_) {
+    return;
+  }
+  mesh_columns_ = columns;
+  mesh_rows_ = rows;
+  mesh_width_ = width;
+  mesh_height_ = height;
+  mesh_rotation_ = rotation;
+
+  // Texture coordinates of the four corners of the full-frame quad, in the
+  // order of the vertices Filter::DoRender draws
+  const float* corners = GetTextureCoordinate(rotation);
+  size_t vertex_count = (size_t)(columns + 1) * (rows + 1);
+  mesh_positions_.resize(vertex_count * 2);
+  mesh_base_coordinates_.resize(vertex_count * 2);
+  mesh_texture_coordinates_.resize(vertex_count * 2);
+  float* position = mesh_positions_.data();
+  float* coord = mesh_base_coordinates_.data();
+  for (int row = 0; row <= rows; row++) {
+    float v = (float)row / rows;
+    for (int column = 0; column <= columns; column++) {
+      float u = (float)column / columns;
+      *position++ = 2 * u - 1;
+      *position++ = 2 * v - 1;
+      for (int i = 0; i < 2; i++) {
+        float bottom = corners[i] + (corners[2 + i] - corners[i]) * u;
+        float top = corners[4 + i] + (corners[6 + i] - corners[4 + i]) * u;
+        *coord++ = bottom + (top - bottom) * v;
+      }
+    }
+  }
+
+  mesh_indexs_.clear();
+  mesh_indexs_.reserve((size_t)columns * rows * 6);
+  for (int row = 0; row < rows; row++) {
+    for (int column = 0; column < columns; column++) {
+      uint16_t i0 = (uint16_t)(row * (columns + 1) + column);
+      uint16_t i1 = (uint16_t)(i0 + 1);
+      uint16_t i2 = (uint16_t)(i0 + columns + 1);
+      uint16_t i3 = (uint16_t)(i2 + 1);
+      mesh_indexs_.insert(mesh_indexs_.end(), {i0, i1, i2, i1, i3, i2});
+    }
+  }
+}
+
+void FaceReshapeFilter::WarpMesh(int face_count, float aspect) {
+  mesh_texture_coordinates_ = mesh_base_coordinates_;
+  if (face_count == 0) {
+    return;
+  }
+
+  // Same order as the shader, face by face, so the result only differs by
+  // the linear interpolation between vertices
+  float* end =
+      mesh_texture_coordinates_.data() + mesh_texture_coordinates_.size();
+  for (int face = 0; face < face_count; face++) {
+    const float* warps = face_warps_ + face * kWarpsPerFace * 4;
+    for (float* coord = mesh_texture_coordinates_.data(); coord < end;
+         coord += 2) {
+      for (int i = 0; i < 9; i++) {
+        CurveWarp(coord, warps + i * 4, thin_face_delta_, aspect);
+      }
+      for (int i = 9; i < kWarpsPerFace; i++) {
+        EnlargeEye(coord, warps + i * 4, big_eye_delta_, aspect);
+      }
+    }
+  }
+}
+
+void FaceReshapeFilter::SetWarpMode(WarpMode mode) {
+  if (mode != PER_PIXEL && mode != MESH) {
+    return;
+  }
+  warp_mode_ = mode;
+}
+
+void FaceReshapeFilter::SetMeshDensity(int cells) {
+  mesh_density_ = std::min(std::max(cells, 1), kMaxMeshDensity);
+}
+
 #pragma mark - face slim
 void FaceReshapeFilter::SetFaceSlimLevel(float level) {
   thin_face_delta_ = level;
@@ -5,6 +5,7 @@
  */
 
 #include "gpupixel/filter/filter.h"
+#include <algorithm>
 #include "core/gpupixel_context.h"
 #include "gpupixel/gpupixel.h"
 #include "utils/logging.h"
@@ -21,6 +22,7 @@ init_filter_factory() {
   factory["LipstickFilter"] = LipstickFilter::Create;
   factory["BlusherFilter"] = BlusherFilter::Create;
   factory["FaceMakeupFilter"] = FaceMakeupFilter::Create;
+  factory["FaceMakeupLayersFilter"] = FaceMakeupLayersFilter::Create;
 
   // // Basic adjustment filters
   // factory["ContrastFilter"] = ContrastFilter::Create;
@@ -62,7 +64,89 @@ init_filter_factory() {
 std::map<std::string, std::function<std::shared_ptr<Filter>()>>
     Filter::filter_factories_ = init_filter_factory();
 
-Filter::Filter() : filter_program_(0), filter_class_name_("") {
+const int Filter::kMaxOutputs;
+
+namespace {
+
+// Declares OUTPUT0..OUTPUT<n-1> for a shader rendering |output_count| outputs
+// and adapts both stages to the way they are rendered
+void BuildMultipleOutputShaders(int output_count,
+                                bool single_pass,
+                                std::string& vertex_shader,
+                                std::string& fragment_shader) {
+#if defined(GPUPIXEL_GL_SHADER)
+  // Desktop GL writes gl_FragData[i] to draw buffer i
+  std::string outputs;
+  for (int i = 0; i < output_count; i++) {
+    outputs += Util::StringFormat("#define OUTPUT%d gl_FragData[%d]\n", i, i);
+  }
+  fragment_shader = outputs + fragment_shader;
+#else
+  std::string outputs;
+  if (single_pass) {
+    // GLSL ES 1.00 can only write gl_FragColor, run the shader as 3.00
+    vertex_shader =
+        "#version 300 es\n"
+        "#define attribute in\n"
+        "#define varying out\n" +
+        vertex_shader;
+    outputs =
+        "#version 300 es\n"
+        "#define varying in\n"
+        "#define texture2D texture\n";
+    for (int i = 0; i < output_count; i++) {
+      outputs += Util::StringFormat(
+          "layout(location = %d) out highp vec4 OUTPUT%d;\n", i, i);
+    }
+    fragment_shader = outputs + fragment_shader;
+    return;
+  }
+
+  // One pass per output, outputIndex picks the one written
+  outputs = "uniform int outputIndex;\n";
+  for (int i = 0; i < output_count; i++) {
+    outputs += Util::StringFormat("mediump vec4 OUTPUT%d;\n", i);
+  }
+  std::string select = "gl_FragColor = OUTPUT0;\n";
+  for (int i = 1; i < output_count; i++) {
+    select += Util::StringFormat(
+        "if (outputIndex == %d) gl_FragColor = OUTPUT%d;\n", i, i);
+  }
+  fragment_shader = outputs + "#define main filterMain\n" + fragment_shader +
+                    "\n#undef main\n"
+                    "void main() {\n"
+                    "filterMain();\n" +
+                    select + "}\n";
+#endif
+}
+
+TextureAttributes GetOutputTextureAttributes(Filter::OutputFormat format) {
+  TextureAttributes attributes =
+      GPUPixelFramebuffer::default_texture_attributes;
+#if defined(GPUPIXEL_GL3_API)
+  if (format != Filter::RGBA8) {
+    // Float textures are not filterable without another extension
+    attributes.minFilter = GL_NEAREST;
+    attributes.magFilter = GL_NEAREST;
+    attributes.internalFormat = format == Filter::RG32F ? GL_RG32F : GL_RGBA32F;
+    attributes.format = format == Filter::RG32F ? GL_RG : GL_RGBA;
+    attributes.type = GL_FLOAT;
+  }
+#endif
+  return attributes;
+}
+
+}  // namespace
+
+Filter::Filter()
+    : filter_program_(0),
+      filter_class_name_(""),
+      output_width_(0),
+      output_height_(0),
+      output_format_(RGBA8),
+      output_count_(1),
+      output_framebuffer_(0),
+      current_output_(0) {
   background_color_.r = 0.0;
   background_color_.g = 0.0;
   background_color_.b = 0.0;
@@ -74,6 +158,12 @@ Filter::~Filter() {
     delete filter_program_;
     filter_program_ = 0;
   }
+  if (output_framebuffer_) {
+    uint32_t framebuffer = output_framebuffer_;
+    GPUPixelContext::GetInstance()->SyncRunWithContext(
+        [&] { GL_CALL(glDeleteFramebuffers(1, &framebuffer)); });
+    output_framebuffer_ = 0;
+  }
 }
 
 std::shared_ptr<Filter> Filter::Create(const std::string& filter_class_name) {
@@ -105,10 +195,26 @@ std::shared_ptr<Filter> Filter::CreateWithFragmentShaderString(
 
 bool Filter::InitWithShaderString(const std::string& vertex_shader_source,
                                   const std::string& fragment_shader_source,
-                                  int input_number /* = 1*/) {
+                                  int input_number /* = 1*/,
+                                  int output_number /* = 1*/) {
   input_count_ = input_number;
-  filter_program_ = GPUPixelGLProgram::CreateWithShaderString(
-      vertex_shader_source, fragment_shader_source);
+  output_count_ = std::min(std::max(output_number, 1), kMaxOutputs);
+  while ((int)extra_outputs_.size() < output_count_ - 1) {
+    extra_outputs_.push_back(std::make_shared<Source>());
+  }
+  extra_outputs_.resize(output_count_ - 1);
+
+  if (output_count_ == 1) {
+    filter_program_ = GPUPixelGLProgram::CreateWithShaderString(
+        vertex_shader_source, fragment_shader_source);
+  } else {
+    std::string vertex_shader = vertex_shader_source;
+    std::string fragment_shader = fragment_shader_source;
+    BuildMultipleOutputShaders(output_count_, IsMultipleOutputsSupported(),
+                               vertex_shader, fragment_shader);
+    filter_program_ = GPUPixelGLProgram::CreateWithShaderString(
+        vertex_shader, fragment_shader);
+  }
   filter_position_attribute_ = filter_program_->GetAttribLocation("position");
   GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program_);
   GL_CALL(glEnableVertexAttribArray(filter_position_attribute_));
@@ -117,9 +223,11 @@ bool Filter::InitWithShaderString(const std::string& vertex_shader_source,
 
 bool Filter::InitWithFragmentShaderString(
     const std::string& fragment_shader_source,
-    int input_number /* = 1*/) {
+    int input_number /* = 1*/,
+    int output_number /* = 1*/) {
   return InitWithShaderString(GetVertexShaderString(input_number),
-                              fragment_shader_source, input_number);
+                              fragment_shader_source, input_number,
+                              output_number);
 }
 
 std::string Filter::GetVertexShaderString(int input_number) const {
@@ -163,7 +271,7 @@ bool Filter::DoRender(bool update_sinks) {
   };
 
   GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program_);
-  framebuffer_->Activate();
+  ActivateOutputs();
   GL_CALL(glClearColor(background_color_.r, background_color_.g,
                        background_color_.b, background_color_.a));
   GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
@@ -191,11 +299,93 @@ bool Filter::DoRender(bool update_sinks) {
                                 image_vertices));
   GL_CALL(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
 
-  framebuffer_->Deactivate();
+  DeactivateOutputs();
 
   return Source::DoRender(update_sinks);
 }
 
+void Filter::DoUpdateSinks() {
+  Source::DoUpdateSinks();
+  for (auto& output : extra_outputs_) {
+    if (output->GetFramebuffer()) {
+      output->DoUpdateSinks();
+    }
+  }
+}
+
+std::shared_ptr<Source> Filter::GetOutput(int index) const {
+  if (index < 1 || index >= output_count_) {
+    return nullptr;
+  }
+  return extra_outputs_[index - 1];
+}
+
+bool Filter::IsMultipleOutputsSupported() {
+#if defined(GPUPIXEL_GL_SHADER)
+  return true;
+#elif defined(GPUPIXEL_GL3_API)
+  return GPUPixelContext::GetInstance()->IsGL3Available();
+#else
+  return false;
+#endif
+}
+
+void Filter::ActivateOutputs() {
+  if (output_count_ == 1) {
+    framebuffer_->Activate();
+    return;
+  }
+
+  if (!IsMultipleOutputsSupported()) {
+    auto target = current_output_ == 0
+                      ? framebuffer_
+                      : extra_outputs_[current_output_ - 1]->GetFramebuffer();
+    target->Activate();
+    filter_program_->SetUniformValue("outputIndex", current_output_);
+    return;
+  }
+
+#if defined(GPUPIXEL_GL_SHADER) || defined(GPUPIXEL_GL3_API)
+  // Draw buffers are part of the framebuffer state, they are only set again
+  // when an output gains or loses its target
+  bool draw_buffers_changed = false;
+  if (!output_framebuffer_) {
+    GL_CALL(glGenFramebuffers(1, &output_framebuffer_));
+    output_textures_.assign(output_count_, 0);
+    draw_buffers_changed = true;
+  }
+  GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, output_framebuffer_));
+  for (int i = 0; i < output_count_; i++) {
+    uint32_t texture = framebuffer_->GetTexture();
+    if (i > 0) {
+      auto output_framebuffer = extra_outputs_[i - 1]->GetFramebuffer();
+      texture = output_framebuffer ? output_framebuffer->GetTexture() : 0;
+    }
+    if (output_textures_[i] != texture) {
+      GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i,
+                                     GL_TEXTURE_2D, texture, 0));
+      draw_buffers_changed |= !output_textures_[i] || !texture;
+      output_textures_[i] = texture;
+    }
+  }
+  if (draw_buffers_changed) {
+    // Outputs without a target are discarded
+    GLenum draw_buffers[kMaxOutputs];
+    for (int i = 0; i < output_count_; i++) {
+      draw_buffers[i] =
+          output_textures_[i] ? GL_COLOR_ATTACHMENT0 + i : GL_NONE;
+    }
+    GL_CALL(glDrawBuffers(output_count_, draw_buffers));
+  }
+  GL_CALL(glViewport(0, 0, framebuffer_->GetWidth(),
+                     framebuffer_->GetHeight()));
+#endif
+}
+
+void Filter::DeactivateOutputs() {
+  GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
 const float* Filter::GetTextureCoordinate(
     const RotationMode& rotation_mode) const {
   static const float no_rotation_texture_coordinates[] = {
@@ -280,21 +470,76 @@ void Filter::Render() {
     rotated_framebuffer_height = first_input_framebuffer->GetWidth();
   }
 
-  if (framebuffer_scale_ != 1.0) {
+  if (output_width_ > 0 && output_height_ > 0) {
+    rotated_framebuffer_width = output_width_;
+    rotated_framebuffer_height = output_height_;
+  } else if (framebuffer_scale_ != 1.0) {
     rotated_framebuffer_width =
         int(rotated_framebuffer_width * framebuffer_scale_);
     rotated_framebuffer_height =
         int(rotated_framebuffer_height * framebuffer_scale_);
   }
+  TextureAttributes attributes = GetOutputTextureAttributes(output_format_);
   if (!framebuffer_ ||
       (framebuffer_->GetWidth() != rotated_framebuffer_width ||
-       framebuffer_->GetHeight() != rotated_framebuffer_height)) {
+       framebuffer_->GetHeight() != rotated_framebuffer_height ||
+       framebuffer_->GetTextureAttributes().internalFormat !=
+           attributes.internalFormat)) {
     framebuffer_ = GPUPixelContext::GetInstance()
                        ->GetFramebufferFactory()
                        ->CreateFramebuffer(rotated_framebuffer_width,
-                                           rotated_framebuffer_height);
+                                           rotated_framebuffer_height, false,
+                                           attributes);
   }
-  DoRender(true);
+  framebuffer_->SetTimestamp(first_input_framebuffer->GetTimestamp());
+
+  if (output_count_ == 1) {
+    DoRender(true);
+    return;
+  }
+
+  for (auto& output : extra_outputs_) {
+    // Extra outputs nobody is connected to get no target and are not written
+    if (output->GetSinks().empty()) {
+      output->SetFramebuffer(nullptr);
+      continue;
+    }
+    auto output_framebuffer = output->GetFramebuffer();
+    if (!output_framebuffer ||
+        output_framebuffer->GetWidth() != rotated_framebuffer_width ||
+        output_framebuffer->GetHeight() != rotated_framebuffer_height ||
+        output_framebuffer->GetTextureAttributes().internalFormat !=
+            attributes.internalFormat) {
+      output_framebuffer = GPUPixelContext::GetInstance()
+                               ->GetFramebufferFactory()
+                               ->CreateFramebuffer(rotated_framebuffer_width,
+                                                   rotated_framebuffer_height,
+                                                   false, attributes);
+      output->SetFramebuffer(output_framebuffer);
+    }
+    output_framebuffer->SetTimestamp(first_input_framebuffer->GetTimestamp());
+  }
+
+  if (IsMultipleOutputsSupported()) {
+    DoRender(true);
+    return;
+  }
+  // Sinks are fed once the last output with a target is rendered
+  int last_output = 0;
+  for (int i = 1; i < output_count_; i++) {
+    if (extra_outputs_[i - 1]->GetFramebuffer()) {
+      last_output = i;
+    }
+  }
+  for (current_output_ = 0; current_output_ <= last_output;
+       current_output_++) {
+    if (current_output_ > 0 &&
+        !extra_outputs_[current_output_ - 1]->GetFramebuffer()) {
+      continue;
+    }
+    DoRender(current_output_ == last_output);
+  }
+  current_output_ = 0;
 }
 
 bool Filter::RegisterProperty(
@@ -402,7 +647,8 @@ bool Filter::SetProperty(const std::string& name, float value) {
   return true;
 }
 
-bool Filter::SetProperty(const std::string& name, std::vector<float> value) {
+bool Filter::SetProperty(const std::string& name,
+                         const std::vector<float>& value) {
   Property* raw_property = GetProperty(name);
   if (!raw_property) {
     LOG_WARN("Filter::setProperty invalid property {}", name);
@@ -413,10 +659,12 @@ bool Filter::SetProperty(const std::string& name, std::vector<float> value) {
     return false;
   }
   VectorProperty* property = ((VectorProperty*)raw_property);
+  // Assigning reuses the stored vector's capacity, the callback then works
+  // on the stored copy
+  property->value = value;
   if (property->on_property_set_func) {
-    property->on_property_set_func(value);
+    property->on_property_set_func(property->value);
   }
-  property->value = value;
 
   return true;
 }
@@ -7,11 +7,17 @@
 #include "gpupixel/filter/filter_group.h"
 #include <assert.h>
 #include <algorithm>
+#include <typeinfo>
 #include "core/gpupixel_context.h"
+#include "utils/util.h"
 
 namespace gpupixel {
 
-FilterGroup::FilterGroup() : terminal_filter_(0) {}
+FilterGroup::FilterGroup()
+    : terminal_filter_(0),
+      signed_member_count_(0),
+      member_signatures_version_(0),
+      render_signature_version_(0) {}
 
 FilterGroup::~FilterGroup() {
   RemoveAllFilters();
@@ -48,6 +54,7 @@ bool FilterGroup::Init(std::vector<std::shared_ptr<Filter>> filters) {
     return true;
   }
   filters_ = filters;
+  GraphChanged();
   SetTerminalFilter(PredictTerminalFilter(filters[filters.size() - 1]));
   return true;
 }
@@ -74,11 +81,13 @@ void FilterGroup::RemoveFilter(std::shared_ptr<Filter> filter) {
   auto itr = std::find(filters_.begin(), filters_.end(), filter);
   if (itr != filters_.end()) {
     filters_.erase(itr);
+    GraphChanged();
   }
 }
 
 void FilterGroup::RemoveAllFilters() {
   filters_.clear();
+  GraphChanged();
 }
 
 std::shared_ptr<Filter> FilterGroup::PredictTerminalFilter(
@@ -139,14 +148,182 @@ bool FilterGroup::DoRender(bool updateSinks) {
 
 void FilterGroup::Render() {
   DoRender();
+  UpdateMemberSignatures();
 
-  for (auto& filter : filters_) {
-    if (filter->IsReady()) {
-      filter->Render();
+  // Members that would render the same image from the same inputs are
+  // rendered once, the others pass that output on. Only the inputs are
+  // compared per frame, and only while two members have a signature.
+  std::map<std::string, std::shared_ptr<Filter>> rendered;
+  for (size_t i = 0; i < filters_.size(); i++) {
+    auto& filter = filters_[i];
+    if (!filter->IsReady()) {
+      continue;
+    }
+    if (signed_member_count_ > 1 && !member_signatures_[i].empty()) {
+      std::string inputs = filter->GetInputSignature();
+      if (!inputs.empty()) {
+        std::string signature = member_signatures_[i] + "@" + inputs;
+        auto it = rendered.find(signature);
+        if (it != rendered.end()) {
+          ShareOutput(it->second, filter);
+          continue;
+        }
+        rendered[signature] = filter;
+      }
+    }
+    filter->Render();
+  }
+
+  // The inputs were only kept for the signatures
+  Sink::ResetAndClean();
+}
+
+void FilterGroup::UpdateMemberSignatures() {
+  uint64_t version = GetGraphVersion();
+  if (version == member_signatures_version_ &&
+      member_signatures_.size() == filters_.size()) {
+    return;
+  }
+  member_signatures_.resize(filters_.size());
+  signed_member_count_ = 0;
+  for (size_t i = 0; i < filters_.size(); i++) {
+    member_signatures_[i] = filters_[i]->GetRenderSignature();
+    if (!member_signatures_[i].empty()) {
+      signed_member_count_++;
+    }
+  }
+  member_signatures_version_ = version;
+}
+
+std::string FilterGroup::GetRenderSignature() const {
+  uint64_t version = GetGraphVersion();
+  if (version == render_signature_version_) {
+    return render_signature_;
+  }
+  render_signature_.clear();
+  render_signature_version_ = version;
+  if (!terminal_filter_ || filters_.empty()) {
+    return "";
+  }
+  std::vector<std::string> chains;
+  for (const auto& filter : filters_) {
+    std::string chain = GetChainSignature(filter);
+    if (chain.empty()) {
+      return "";
+    }
+    chains.push_back(chain);
+  }
+  // Members are compared as a set, their order does not change the output
+  std::sort(chains.begin(), chains.end());
+
+  render_signature_ = typeid(*this).name();
+  for (const auto& chain : chains) {
+    render_signature_ += "{" + chain + "}";
+  }
+  return render_signature_;
+}
+
+std::string FilterGroup::GetChainSignature(
+    const std::shared_ptr<Filter>& filter,
+    int depth /* = 0*/) const {
+  std::string signature = filter->GetRenderSignature();
+  if (signature.empty() || depth > 32) {
+    return "";
+  }
+  if (filter == terminal_filter_) {
+    return signature + "[]";
+  }
+
+  std::vector<std::string> sinks;
+  for (auto& it : filter->GetSinks()) {
+    auto sink = std::dynamic_pointer_cast<Filter>(it.first);
+    if (!sink) {
+      return "";
+    }
+    std::string chain = GetChainSignature(sink, depth + 1);
+    if (chain.empty()) {
+      return "";
+    }
+    sinks.push_back(chain + Util::StringFormat("#%d", it.second));
+  }
+  // Sinks are kept in pointer order, which differs between two groups
+  std::sort(sinks.begin(), sinks.end());
+
+  signature += "[";
+  for (const auto& sink : sinks) {
+    signature += sink + ",";
+  }
+  return signature + "]";
+}
+
+std::shared_ptr<Filter> FilterGroup::GetOutputFilter(
+    const std::shared_ptr<Filter>& filter) {
+  auto group = std::dynamic_pointer_cast<FilterGroup>(filter);
+  if (!group) {
+    return filter;
+  }
+  if (!group->terminal_filter_) {
+    return nullptr;
+  }
+  return GetOutputFilter(group->terminal_filter_);
+}
+
+void FilterGroup::ShareOutput(const std::shared_ptr<Filter>& original,
+                              const std::shared_ptr<Filter>& duplicate) {
+  auto output = GetOutputFilter(original);
+  if (!output || !output->GetFramebuffer()) {
+    duplicate->Render();
+    return;
+  }
+  std::shared_ptr<GPUPixelFramebuffer> framebuffer = output->GetFramebuffer();
+  RotationMode rotation = output->GetOutputRotation();
+
+  ReleaseInputs(duplicate);
+  for (auto& it : duplicate->GetSinks()) {
+    auto sink = it.first;
+    sink->SetInputFramebuffer(framebuffer, rotation, it.second);
+    if (sink->IsReady()) {
+      sink->Render();
+      sink->ResetAndClean();
     }
   }
 }
 
+void FilterGroup::ReleaseInputs(const std::shared_ptr<Filter>& filter) {
+  auto group = std::dynamic_pointer_cast<FilterGroup>(filter);
+  if (!group) {
+    filter->ResetAndClean();
+    return;
+  }
+  for (auto& member : group->filters_) {
+    ReleaseInputs(member);
+  }
+  group->Sink::ResetAndClean();
+}
+
+void FilterGroup::ReplaceFilter(const std::shared_ptr<Filter>& from,
+                                const std::shared_ptr<Filter>& to) {
+  std::map<std::shared_ptr<Sink>, int> sinks;
+  if (terminal_filter_) {
+    sinks = GetSinks();
+    RemoveAllSinks();
+  }
+  RemoveFilter(from);
+  AddFilter(to);
+  for (auto& it : sinks) {
+    AddSink(it.first, it.second);
+  }
+}
+
+void FilterGroup::MoveSinks(const std::shared_ptr<Source>& from,
+                            const std::shared_ptr<Source>& to) {
+  std::map<std::shared_ptr<Sink>, int> sinks = from->GetSinks();
+  from->RemoveAllSinks();
+  for (auto& it : sinks) {
+    to->AddSink(it.first, it.second);
+  }
+}
+
 void FilterGroup::DoUpdateSinks() {
   if (terminal_filter_) {
     terminal_filter_->DoUpdateSinks();
@@ -170,6 +347,8 @@ void FilterGroup::SetInputFramebuffer(
     std::shared_ptr<GPUPixelFramebuffer> framebuffer,
     RotationMode rotation_mode /* = NoRotation*/,
     int texIdx /* = 0*/) {
+  // Kept until Render for the render signatures
+  Sink::SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
   for (auto& filter : filters_) {
     filter->SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
   }
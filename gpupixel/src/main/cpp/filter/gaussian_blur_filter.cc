@@ -7,11 +7,15 @@
 #include "gpupixel/filter/gaussian_blur_filter.h"
 #include <cmath>
 #include "core/gpupixel_context.h"
+#include "utils/logging.h"
 #include "utils/util.h"
 namespace gpupixel {
 
 GaussianBlurFilter::GaussianBlurFilter()
-    : horizontal_blur_filter_(nullptr), vertical_blur_filter_(nullptr) {}
+    : horizontal_blur_filter_(nullptr),
+      vertical_blur_filter_(nullptr),
+      pyramid_blur_filter_(nullptr),
+      engine_(SEPARABLE) {}
 
 GaussianBlurFilter::~GaussianBlurFilter() {}
 
@@ -43,17 +47,62 @@ bool GaussianBlurFilter::Init(int radius, float sigma) {
 
   RegisterProperty("sigma", 2.0, "", [this](float& sigma) { setSigma(sigma); });
 
+  RegisterProperty("engine", (int)SEPARABLE, "0: separable, 1: pyramid",
+                   [this](int& engine) { SetEngine((Engine)engine); });
+
   return true;
 }
 
 void GaussianBlurFilter::SetRadius(int radius) {
   horizontal_blur_filter_->SetRadius(radius);
   vertical_blur_filter_->SetRadius(radius);
+  if (pyramid_blur_filter_) {
+    pyramid_blur_filter_->SetSigma(GetKernelSigma());
+  }
 }
 
 void GaussianBlurFilter::setSigma(float sigma) {
   horizontal_blur_filter_->setSigma(sigma);
   vertical_blur_filter_->setSigma(sigma);
+  if (pyramid_blur_filter_) {
+    pyramid_blur_filter_->SetSigma(GetKernelSigma());
+  }
+}
+
+void GaussianBlurFilter::SetEngine(Engine engine) {
+  if (engine == engine_ || (engine != SEPARABLE && engine != PYRAMID)) {
+    return;
+  }
+  if (engine == PYRAMID && !pyramid_blur_filter_) {
+    pyramid_blur_filter_ = PyramidBlurFilter::Create(GetKernelSigma());
+    if (!pyramid_blur_filter_) {
+      LOG_ERROR("GaussianBlurFilter: failed to create pyramid blur");
+      return;
+    }
+  }
+
+  if (engine == PYRAMID) {
+    ReplaceFilter(horizontal_blur_filter_, pyramid_blur_filter_);
+  } else {
+    ReplaceFilter(pyramid_blur_filter_, horizontal_blur_filter_);
+  }
+  engine_ = engine;
+}
+
+float GaussianBlurFilter::GetKernelSigma() const {
+  int radius = horizontal_blur_filter_->GetRadius();
+  float sigma = horizontal_blur_filter_->GetSigma();
+  if (radius < 1 || sigma <= 0) {
+    return 0;
+  }
+  double weight_sum = 0;
+  double variance = 0;
+  for (int i = -radius; i <= radius; i++) {
+    double weight = exp(-i * i / (2.0 * sigma * sigma));
+    weight_sum += weight;
+    variance += weight * i * i;
+  }
+  return sqrt(variance / weight_sum);
 }
 
 }  // namespace gpupixel
@@ -6,6 +6,7 @@
 
 #include "gpupixel/filter/gaussian_blur_mono_filter.h"
 #include <cmath>
+#include <typeinfo>
 #include "core/gpupixel_context.h"
 #include "utils/util.h"
 namespace gpupixel {
@@ -48,7 +49,9 @@ void GaussianBlurMonoFilter::SetRadius(int radius) {
     filter_program_ = 0;
   }
   InitWithShaderString(GenerateOptimizedVertexShaderString(radius_, sigma_),
-                       GenerateOptimizedFragmentShaderString(radius_, sigma_));
+                       GenerateOptimizedFragmentShaderString(radius_, sigma_),
+                       input_count_, output_count_);
+  GraphChanged();
 }
 
 void GaussianBlurMonoFilter::setSigma(float sigma) {
@@ -80,7 +83,9 @@ void GaussianBlurMonoFilter::setSigma(float sigma) {
     filter_program_ = 0;
   }
   InitWithShaderString(GenerateOptimizedVertexShaderString(radius_, sigma_),
-                       GenerateOptimizedFragmentShaderString(radius_, sigma_));
+                       GenerateOptimizedFragmentShaderString(radius_, sigma_),
+                       input_count_, output_count_);
+  GraphChanged();
 }
 
 bool GaussianBlurMonoFilter::DoRender(bool updateSinks) {
@@ -118,6 +123,17 @@ bool GaussianBlurMonoFilter::DoRender(bool updateSinks) {
 void GaussianBlurMonoFilter::SetTexelSpacingMultiplier(float value) {
   vertical_texel_spacing_ = value;
   horizontal_texel_spacing_ = value;
+  GraphChanged();
+}
+
+std::string GaussianBlurMonoFilter::GetRenderSignature() const {
+  // Covers every parameter that changes the rendered image: the shaders
+  // follow the radius and sigma, the texel spacings and the framebuffer
+  // scale change the sampling
+  return Util::StringFormat("%s:%d:%d:%f:%f:%f:%f", typeid(*this).name(),
+                            (int)type_, radius_, sigma_,
+                            vertical_texel_spacing_, horizontal_texel_spacing_,
+                            framebuffer_scale_);
 }
 
 std::string GaussianBlurMonoFilter::GenerateVertexShaderString(int radius,
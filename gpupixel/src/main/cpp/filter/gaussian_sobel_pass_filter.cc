@@ -0,0 +1,244 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/gaussian_sobel_pass_filter.h"
+#include <algorithm>
+#include <cmath>
+#include "core/gpupixel_context.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+namespace {
+// Blurred radius plus the Sobel neighbour on each side
+constexpr int kMaxTaps = (GaussianSobelPassFilter::kMaxRadius + 1) * 2 + 1;
+}  // namespace
+
+constexpr int GaussianSobelPassFilter::kMaxRadius;
+
+#if defined(GPUPIXEL_GLES_SHADER)
+const std::string kGaussianSobelPassFragmentShaderString = R"(
+    precision highp float;
+    #define MAX_TAPS 19
+    uniform sampler2D inputImageTexture;
+    varying highp vec2 textureCoordinate;
+
+    // Texture space offset of one output pixel along the pass direction
+    uniform highp vec2 stepOffset;
+    // (offset in pixels, derivative weight, smoothing weight, 0)
+    uniform int tapCount;
+    uniform highp vec4 taps[MAX_TAPS];
+
+    void main() {
+      highp vec2 sums = vec2(0.0);
+      // Loop indices only, so the uniform array index stays a
+      // constant-index expression as GLSL ES 1.0 requires
+      for (int i = 0; i < MAX_TAPS; i++) {
+        if (i >= tapCount) {
+          break;
+        }
+        highp vec4 tap = taps[i];
+        highp vec4 color =
+            texture2D(inputImageTexture, textureCoordinate + stepOffset * tap.x);
+#if defined(HORIZONTAL)
+        highp float luminance = dot(color.rgb, vec3(0.2125, 0.7154, 0.0721));
+        sums += luminance * tap.yz;
+#else
+        // x needs the vertical smoothing of the horizontal derivative, y
+        // the vertical derivative of the horizontal smoothing
+        sums += color.rg * tap.zy;
+#endif
+      }
+
+#if defined(HORIZONTAL)
+      gl_FragColor = vec4(sums, 0.0, 1.0);
+#else
+      vec2 gradientDirection = sums;
+      float gradientMagnitude = length(gradientDirection);
+      vec2 normalizedDirection = normalize(gradientDirection);
+      normalizedDirection =
+          sign(normalizedDirection) *
+          floor(abs(normalizedDirection) +
+                0.617316);  // Offset by 1-sin(pi/8) to set
+                            // to 0 if near axis, 1 if away
+      normalizedDirection = (normalizedDirection + 1.0) *
+                            0.5;  // Place -1.0 - 1.0 within 0 - 1.0
+
+#ifdef GRADIENT_OUTPUT
+      OUTPUT0 = vec4(gradientMagnitude, normalizedDirection.x,
+                     normalizedDirection.y, 1.0);
+      // Signed gradients of up to 4 placed within 0 - 1.0
+      OUTPUT1 = vec4(gradientDirection * 0.125 + 0.5, 0.0, 1.0);
+#else
+      gl_FragColor = vec4(gradientMagnitude, normalizedDirection.x,
+                          normalizedDirection.y, 1.0);
+#endif
+#endif
+    })";
+#elif defined(GPUPIXEL_GL_SHADER)
+const std::string kGaussianSobelPassFragmentShaderString = R"(
+    #define MAX_TAPS 19
+    uniform sampler2D inputImageTexture;
+    varying vec2 textureCoordinate;
+
+    // Texture space offset of one output pixel along the pass direction
+    uniform vec2 stepOffset;
+    // (offset in pixels, derivative weight, smoothing weight, 0)
+    uniform int tapCount;
+    uniform vec4 taps[MAX_TAPS];
+
+    void main() {
+      vec2 sums = vec2(0.0);
+      for (int i = 0; i < MAX_TAPS; i++) {
+        if (i >= tapCount) {
+          break;
+        }
+        vec4 tap = taps[i];
+        vec4 color =
+            texture2D(inputImageTexture, textureCoordinate + stepOffset * tap.x);
+#if defined(HORIZONTAL)
+        float luminance = dot(color.rgb, vec3(0.2125, 0.7154, 0.0721));
+        sums += luminance * tap.yz;
+#else
+        // x needs the vertical smoothing of the horizontal derivative, y
+        // the vertical derivative of the horizontal smoothing
+        sums += color.rg * tap.zy;
+#endif
+      }
+
+#if defined(HORIZONTAL)
+      gl_FragColor = vec4(sums, 0.0, 1.0);
+#else
+      vec2 gradientDirection = sums;
+      float gradientMagnitude = length(gradientDirection);
+      vec2 normalizedDirection = normalize(gradientDirection);
+      normalizedDirection =
+          sign(normalizedDirection) *
+          floor(abs(normalizedDirection) +
+                0.617316);  // Offset by 1-sin(pi/8) to set
+                            // to 0 if near axis, 1 if away
+      normalizedDirection = (normalizedDirection + 1.0) *
+                            0.5;  // Place -1.0 - 1.0 within 0 - 1.0
+
+#ifdef GRADIENT_OUTPUT
+      OUTPUT0 = vec4(gradientMagnitude, normalizedDirection.x,
+                     normalizedDirection.y, 1.0);
+      // Signed gradients of up to 4 placed within 0 - 1.0
+      OUTPUT1 = vec4(gradientDirection * 0.125 + 0.5, 0.0, 1.0);
+#else
+      gl_FragColor = vec4(gradientMagnitude, normalizedDirection.x,
+                          normalizedDirection.y, 1.0);
+#endif
+#endif
+    })";
+#endif
+
+GaussianSobelPassFilter::GaussianSobelPassFilter(Direction direction)
+    : direction_(direction), radius_(4), sigma_(2.0) {}
+
+GaussianSobelPassFilter::~GaussianSobelPassFilter() {}
+
+std::shared_ptr<GaussianSobelPassFilter> GaussianSobelPassFilter::Create(
+    Direction direction,
+    bool gradient_output /* = false*/) {
+  auto ret = std::shared_ptr<GaussianSobelPassFilter>(
+      new GaussianSobelPassFilter(direction));
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init(gradient_output)) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool GaussianSobelPassFilter::Init(bool gradient_output) {
+  std::string defines;
+  int output_number = 1;
+  if (direction_ == HORIZONTAL) {
+    // The derivative is signed and the sums need more than 8 bits
+    SetOutputFormat(RG32F);
+    defines = "#define HORIZONTAL\n";
+  } else if (gradient_output) {
+    defines = "#define GRADIENT_OUTPUT\n";
+    output_number = 2;
+  }
+  UpdateTaps();
+  return InitWithFragmentShaderString(
+      defines + kGaussianSobelPassFragmentShaderString, 1, output_number);
+}
+
+void GaussianSobelPassFilter::SetRadius(int radius) {
+  radius = std::min(std::max(radius, 0), kMaxRadius);
+  if (radius != radius_) {
+    radius_ = radius;
+    UpdateTaps();
+  }
+}
+
+void GaussianSobelPassFilter::SetSigma(float sigma) {
+  if (sigma != sigma_) {
+    sigma_ = sigma;
+    UpdateTaps();
+  }
+}
+
+void GaussianSobelPassFilter::UpdateTaps() {
+  // The normalized weights SingleComponentGaussianBlurFilter uses, a radius
+  // or sigma that turns the blur off leaves the center tap alone
+  std::vector<double> gaussian(radius_ * 2 + 3, 0.0);
+  int center = radius_ + 1;
+  if (radius_ < 1 || sigma_ <= 0.0) {
+    gaussian[center] = 1.0;
+  } else {
+    double sum = 0;
+    for (int i = -radius_; i <= radius_; i++) {
+      gaussian[center + i] = exp(-i * i / (2.0 * sigma_ * sigma_));
+      sum += gaussian[center + i];
+    }
+    for (auto& weight : gaussian) {
+      weight /= sum;
+    }
+  }
+
+  // Blur then [-1 0 1] is g[i - 1] - g[i + 1] at offset i, blur then
+  // [1 2 1] is g[i - 1] + 2 g[i] + g[i + 1]
+  taps_.clear();
+  auto at = [&](int i) {
+    return i < 0 || i >= (int)gaussian.size() ? 0.0 : gaussian[i];
+  };
+  for (int i = -radius_ - 1; i <= radius_ + 1; i++) {
+    int index = center + i;
+    taps_.push_back((float)i);
+    taps_.push_back((float)(at(index - 1) - at(index + 1)));
+    taps_.push_back((float)(at(index - 1) + 2 * at(index) + at(index + 1)));
+    taps_.push_back(0);
+  }
+}
+
+bool GaussianSobelPassFilter::DoRender(bool updateSinks) {
+  auto& input = input_framebuffers_.begin()->second;
+  int width = framebuffer_->GetWidth();
+  int height = framebuffer_->GetHeight();
+
+  // Texture coordinates of the bottom left, bottom right and top left
+  // corners give the texture space direction of the output axes
+  const float* coordinates = GetTextureCoordinate(input.rotation_mode);
+  Vector2 step_offset;
+  if (direction_ == HORIZONTAL) {
+    step_offset = Vector2((coordinates[2] - coordinates[0]) / width,
+                          (coordinates[3] - coordinates[1]) / width);
+  } else {
+    step_offset = Vector2((coordinates[4] - coordinates[0]) / height,
+                          (coordinates[5] - coordinates[1]) / height);
+  }
+
+  int tap_count = std::min((int)taps_.size() / 4, kMaxTaps);
+  filter_program_->SetUniformValue("stepOffset", step_offset);
+  filter_program_->SetUniformValue("tapCount", tap_count);
+  filter_program_->SetUniformVec4Array("taps", taps_.data(), tap_count);
+  return Filter::DoRender(updateSinks);
+}
+
+}  // namespace gpupixel
@@ -0,0 +1,201 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/guided_filter.h"
+#include <algorithm>
+#include <cmath>
+#include "core/gpupixel_context.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+#if defined(GPUPIXEL_GLES_SHADER)
+const std::string kGuidedFilterOutputFragmentShaderString = R"(
+    varying highp vec2 textureCoordinate;
+    varying highp vec2 textureCoordinate1;
+    uniform sampler2D inputImageTexture;
+    uniform highp sampler2D inputImageTexture1;
+    uniform highp vec2 coefficientSize;
+    uniform highp float delta;
+
+    highp vec4 Fetch(highp vec2 index) {
+      return texture2D(inputImageTexture1, (index + 0.5) / coefficientSize);
+    }
+
+    void main() {
+      // Float textures are read with nearest filtering, interpolate here
+      highp vec2 position = textureCoordinate1 * coefficientSize - 0.5;
+      highp vec2 base = floor(position);
+      highp vec2 weight = position - base;
+      highp vec4 coefficients =
+          mix(mix(Fetch(base), Fetch(base + vec2(1.0, 0.0)), weight.x),
+              mix(Fetch(base + vec2(0.0, 1.0)), Fetch(base + 1.0), weight.x),
+              weight.y);
+
+      lowp vec4 color = texture2D(inputImageTexture, textureCoordinate);
+      highp vec3 smoothed =
+          clamp(coefficients.r * color.rgb + coefficients.gba, 0.0, 1.0);
+      highp vec3 diffColor = (color.rgb - smoothed) * delta;
+      OUTPUT0 = vec4(smoothed, color.a);
+      OUTPUT1 = vec4(min(diffColor * diffColor, 1.0), 1.0);
+    })";
+#elif defined(GPUPIXEL_GL_SHADER)
+const std::string kGuidedFilterOutputFragmentShaderString = R"(
+    varying vec2 textureCoordinate;
+    varying vec2 textureCoordinate1;
+    uniform sampler2D inputImageTexture;
+    uniform sampler2D inputImageTexture1;
+    uniform vec2 coefficientSize;
+    uniform float delta;
+
+    vec4 Fetch(vec2 index) {
+      return texture2D(inputImageTexture1, (index + 0.5) / coefficientSize);
+    }
+
+    void main() {
+      // Float textures are read with nearest filtering, interpolate here
+      vec2 position = textureCoordinate1 * coefficientSize - 0.5;
+      vec2 base = floor(position);
+      vec2 weight = position - base;
+      vec4 coefficients =
+          mix(mix(Fetch(base), Fetch(base + vec2(1.0, 0.0)), weight.x),
+              mix(Fetch(base + vec2(0.0, 1.0)), Fetch(base + 1.0), weight.x),
+              weight.y);
+
+      vec4 color = texture2D(inputImageTexture, textureCoordinate);
+      vec3 smoothed =
+          clamp(coefficients.r * color.rgb + coefficients.gba, 0.0, 1.0);
+      vec3 diffColor = (color.rgb - smoothed) * delta;
+      OUTPUT0 = vec4(smoothed, color.a);
+      OUTPUT1 = vec4(min(diffColor * diffColor, 1.0), 1.0);
+    })";
+#endif
+
+GuidedFilterOutputFilter::GuidedFilterOutputFilter() : delta_(7.07) {}
+
+GuidedFilterOutputFilter::~GuidedFilterOutputFilter() {}
+
+std::shared_ptr<GuidedFilterOutputFilter> GuidedFilterOutputFilter::Create() {
+  auto ret =
+      std::shared_ptr<GuidedFilterOutputFilter>(new GuidedFilterOutputFilter());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init()) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool GuidedFilterOutputFilter::Init() {
+  return InitWithFragmentShaderString(kGuidedFilterOutputFragmentShaderString,
+                                      2, 2);
+}
+
+bool GuidedFilterOutputFilter::DoRender(bool updateSinks) {
+  auto coefficients = input_framebuffers_[1].frame_buffer;
+  filter_program_->SetUniformValue(
+      "coefficientSize", Vector2((float)coefficients->GetWidth(),
+                                 (float)coefficients->GetHeight()));
+  filter_program_->SetUniformValue("delta", delta_);
+  return Filter::DoRender(updateSinks);
+}
+
+GuidedFilter::GuidedFilter()
+    : downsample_filter_(nullptr),
+      image_table_filter_(nullptr),
+      coefficient_filter_(nullptr),
+      coefficient_table_filter_(nullptr),
+      coefficient_mean_filter_(nullptr),
+      output_filter_(nullptr),
+      radius_(16),
+      downsampling_(4.0) {}
+
+GuidedFilter::~GuidedFilter() {}
+
+std::shared_ptr<GuidedFilter> GuidedFilter::Create(int radius /* = 16*/,
+                                                   float epsilon /* = 0.01*/) {
+  auto ret = std::shared_ptr<GuidedFilter>(new GuidedFilter());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init(radius, epsilon)) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool GuidedFilter::Init(int radius, float epsilon) {
+  if (!FilterGroup::Init()) {
+    return false;
+  }
+
+  downsample_filter_ =
+      Filter::CreateWithFragmentShaderString(kDefaultFragmentShader);
+  image_table_filter_ = SummedAreaTableFilter::Create(
+      SummedAreaTableFilter::COLOR_AND_LUMINANCE_SQUARE);
+  coefficient_filter_ =
+      SummedAreaBoxFilter::Create(SummedAreaBoxFilter::GUIDED_COEFFICIENTS);
+  coefficient_table_filter_ = SummedAreaTableFilter::Create();
+  coefficient_mean_filter_ = SummedAreaBoxFilter::Create();
+  output_filter_ = GuidedFilterOutputFilter::Create();
+  if (!downsample_filter_ || !image_table_filter_ || !coefficient_filter_ ||
+      !coefficient_table_filter_ || !coefficient_mean_filter_ ||
+      !output_filter_) {
+    return false;
+  }
+  // Keeps the interpolated coefficients exact
+  coefficient_mean_filter_->SetOutputFormat(RGBA32F);
+
+  downsample_filter_->AddSink(image_table_filter_)
+      ->AddSink(coefficient_filter_)
+      ->AddSink(coefficient_table_filter_)
+      ->AddSink(coefficient_mean_filter_)
+      ->AddSink(output_filter_, 1);
+  AddFilter(downsample_filter_);
+  // Takes the full size image as input 0
+  AddFilter(output_filter_);
+  SetTerminalFilter(output_filter_);
+
+  radius_ = radius;
+  SetDownsampling(downsampling_);
+  SetEpsilon(epsilon);
+
+  RegisterProperty("radius", radius_, "Half the box width in pixels",
+                   [this](int& radius) { SetRadius(radius); });
+  RegisterProperty("epsilon", epsilon, "", [this](float& epsilon) {
+    SetEpsilon(epsilon);
+  });
+  return true;
+}
+
+void GuidedFilter::SetRadius(int radius) {
+  radius_ = radius;
+  UpdateRadius();
+}
+
+void GuidedFilter::SetEpsilon(float epsilon) {
+  coefficient_filter_->SetEpsilon(epsilon);
+}
+
+void GuidedFilter::SetDownsampling(float downsampling) {
+  downsampling_ = std::max(downsampling, 1.0f);
+  downsample_filter_->SetFramebufferScale(1 / downsampling_);
+  UpdateRadius();
+}
+
+void GuidedFilter::UpdateRadius() {
+  int radius = (int)std::round(radius_ / downsampling_);
+  coefficient_filter_->SetRadius(radius);
+  coefficient_mean_filter_->SetRadius(radius);
+}
+
+void GuidedFilter::SetDelta(float delta) {
+  output_filter_->SetDelta(delta);
+}
+
+std::shared_ptr<Source> GuidedFilter::GetHighPassOutput() const {
+  return output_filter_->GetOutput(1);
+}
+
+}  // namespace gpupixel
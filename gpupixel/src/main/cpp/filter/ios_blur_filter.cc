@@ -62,6 +62,10 @@ bool IOSBlurFilter::Init() {
       "downSampling", down_sampling_, "",
       [this](float& downSampling) { setDownSampling(downSampling); });
 
+  blur_engine_ = GaussianBlurFilter::SEPARABLE;
+  RegisterProperty("blurEngine", blur_engine_, "0: separable, 1: pyramid",
+                   [this](int& blurEngine) { setBlurEngine(blurEngine); });
+
   return true;
 }
 
@@ -86,4 +90,9 @@ void IOSBlurFilter::setDownSampling(float downSampling) {
   luminance_range_filter_->SetFramebufferScale(downSampling);
 }
 
+void IOSBlurFilter::setBlurEngine(int blurEngine) {
+  blur_engine_ = blurEngine;
+  blur_filter_->SetEngine((GaussianBlurFilter::Engine)blurEngine);
+}
+
 }  // namespace gpupixel
@@ -23,11 +23,18 @@ std::shared_ptr<LipstickFilter> LipstickFilter::Create() {
 }
 
 bool LipstickFilter::Init() {
-  auto path = Util::GetResourcePath() / "res";
-  auto mouth = SourceImage::Create((path / "mouth.png").string());
-  SetImageTexture(mouth);
-  SetTextureBounds(FrameBounds{502.5, 710, 262.5, 167.5});
+  SetImageTexture(CreateTexture());
+  SetTextureBounds(GetTextureBounds());
   return FaceMakeupFilter::Init();
 }
 
+std::shared_ptr<SourceImage> LipstickFilter::CreateTexture() {
+  auto path = Util::GetResourcePath() / "res";
+  return SourceImage::CreateShared((path / "mouth.png").string());
+}
+
+FrameBounds LipstickFilter::GetTextureBounds() {
+  return FrameBounds{502.5, 710, 262.5, 167.5};
+}
+
 }  // namespace gpupixel
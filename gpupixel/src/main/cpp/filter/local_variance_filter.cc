@@ -0,0 +1,51 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/local_variance_filter.h"
+#include "core/gpupixel_context.h"
+namespace gpupixel {
+
+LocalVarianceFilter::LocalVarianceFilter()
+    : summed_area_table_filter_(nullptr), variance_filter_(nullptr) {}
+
+LocalVarianceFilter::~LocalVarianceFilter() {}
+
+std::shared_ptr<LocalVarianceFilter> LocalVarianceFilter::Create(
+    int radius /* = 8*/) {
+  auto ret = std::shared_ptr<LocalVarianceFilter>(new LocalVarianceFilter());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init(radius)) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool LocalVarianceFilter::Init(int radius) {
+  if (!FilterGroup::Init()) {
+    return false;
+  }
+
+  summed_area_table_filter_ =
+      SummedAreaTableFilter::Create(SummedAreaTableFilter::LUMINANCE_MOMENTS);
+  variance_filter_ =
+      SummedAreaBoxFilter::Create(SummedAreaBoxFilter::VARIANCE, radius);
+  if (!summed_area_table_filter_ || !variance_filter_) {
+    return false;
+  }
+  summed_area_table_filter_->AddSink(variance_filter_);
+  AddFilter(summed_area_table_filter_);
+
+  RegisterProperty("radius", radius, "Half the box width in pixels",
+                   [this](int& radius) { SetRadius(radius); });
+  return true;
+}
+
+void LocalVarianceFilter::SetRadius(int radius) {
+  variance_filter_->SetRadius(radius);
+}
+
+}  // namespace gpupixel
@@ -50,9 +50,11 @@ const std::string kNearbySampling3x3SamplingVertexShaderString = R"(
 
 bool NearbySampling3x3Filter::InitWithFragmentShaderString(
     const std::string& fragmentShaderSource,
-    int inputNumber /* = 1*/) {
+    int inputNumber /* = 1*/,
+    int outputNumber /* = 1*/) {
   if (Filter::InitWithShaderString(kNearbySampling3x3SamplingVertexShaderString,
-                                   fragmentShaderSource)) {
+                                   fragmentShaderSource, inputNumber,
+                                   outputNumber)) {
     texel_size_multiplier_ = 1.0;
     texel_width_uniform_ = filter_program_->GetUniformLocation("texelWidth");
     texel_height_uniform_ = filter_program_->GetUniformLocation("texelHeight");
@@ -0,0 +1,175 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/pyramid_blur_filter.h"
+#include <algorithm>
+#include <cmath>
+#include "core/gpupixel_context.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+namespace {
+// Standard deviation of n down and n up passes with the tap offset at the
+// same index, in units of sqrt((4^n - 1) / 3) input pixels. Measured on the
+// pass kernels including bilinear sampling, it hardly depends on n.
+const float kTapOffsets[] = {0.5, 0.75, 1.0, 1.25, 1.5, 1.75,
+                             2.0, 2.25, 2.5, 2.75, 3.0};
+const float kLevelSpreads[] = {0.957, 1.384, 1.683, 1.928, 2.189, 2.55,
+                               2.885, 3.161, 3.403, 3.806, 4.183};
+const int kTapOffsetCount = sizeof(kTapOffsets) / sizeof(kTapOffsets[0]);
+// Wider offsets start to leave gaps, only used when the input is too small
+// for another level
+const int kPreferredMaxOffset = 4;
+
+float LevelScale(int levels) {
+  return std::sqrt((std::pow(4.0f, levels) - 1) / 3);
+}
+
+float TapOffsetForSpread(float spread) {
+  if (spread <= kLevelSpreads[0]) {
+    return kTapOffsets[0];
+  }
+  for (int i = 1; i < kTapOffsetCount; i++) {
+    if (spread <= kLevelSpreads[i]) {
+      float t = (spread - kLevelSpreads[i - 1]) /
+                (kLevelSpreads[i] - kLevelSpreads[i - 1]);
+      return kTapOffsets[i - 1] + t * (kTapOffsets[i] - kTapOffsets[i - 1]);
+    }
+  }
+  return kTapOffsets[kTapOffsetCount - 1];
+}
+}  // namespace
+
+const int PyramidBlurFilter::kMaxLevels;
+
+PyramidBlurFilter::PyramidBlurFilter()
+    : sigma_(2.0),
+      level_count_(0),
+      input_width_(0),
+      input_height_(0),
+      levels_dirty_(true) {}
+
+PyramidBlurFilter::~PyramidBlurFilter() {}
+
+std::shared_ptr<PyramidBlurFilter> PyramidBlurFilter::Create(
+    float sigma /* = 2.0*/) {
+  auto ret = std::shared_ptr<PyramidBlurFilter>(new PyramidBlurFilter());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init(sigma)) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool PyramidBlurFilter::Init(float sigma) {
+  if (!FilterGroup::Init()) {
+    return false;
+  }
+
+  // Level 1 and its way back up always exist, the others are created once
+  // a sigma needs them
+  down_filters_.push_back(
+      PyramidBlurPassFilter::Create(PyramidBlurPassFilter::DOWN));
+  up_filters_.push_back(
+      PyramidBlurPassFilter::Create(PyramidBlurPassFilter::UP));
+  if (!down_filters_[0] || !up_filters_[0]) {
+    return false;
+  }
+  AddFilter(down_filters_[0]);
+  SetTerminalFilter(up_filters_[0]);
+
+  SetSigma(sigma);
+  RegisterProperty("sigma", sigma_, "",
+                   [this](float& sigma) { SetSigma(sigma); });
+  return true;
+}
+
+void PyramidBlurFilter::SetSigma(float sigma) {
+  sigma_ = std::max(sigma, 0.0f);
+  levels_dirty_ = true;
+}
+
+void PyramidBlurFilter::SetInputFramebuffer(
+    std::shared_ptr<GPUPixelFramebuffer> framebuffer,
+    RotationMode rotation_mode /* = NoRotation*/,
+    int texIdx /* = 0*/) {
+  if (framebuffer) {
+    int width = framebuffer->GetWidth();
+    int height = framebuffer->GetHeight();
+    if (rotationSwapsSize(rotation_mode)) {
+      std::swap(width, height);
+    }
+    if (width != input_width_ || height != input_height_) {
+      input_width_ = width;
+      input_height_ = height;
+      levels_dirty_ = true;
+    }
+    if (levels_dirty_) {
+      UpdateLevels();
+    }
+  }
+  FilterGroup::SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
+}
+
+void PyramidBlurFilter::UpdateLevels() {
+  levels_dirty_ = false;
+
+  // The smallest level keeps at least 2 pixels
+  int max_levels = 1;
+  while (max_levels < kMaxLevels &&
+         (std::min(input_width_, input_height_) >> (max_levels + 1)) >= 2) {
+    max_levels++;
+  }
+  int levels = 1;
+  while (levels < max_levels &&
+         sigma_ > LevelScale(levels) * kLevelSpreads[kPreferredMaxOffset]) {
+    levels++;
+  }
+  float offset = TapOffsetForSpread(sigma_ / LevelScale(levels));
+
+  while ((int)down_filters_.size() < levels) {
+    down_filters_.push_back(
+        PyramidBlurPassFilter::Create(PyramidBlurPassFilter::DOWN));
+    up_filters_.push_back(
+        PyramidBlurPassFilter::Create(PyramidBlurPassFilter::UP));
+  }
+
+  if (levels != level_count_) {
+    // Sinks of up_filters_[0] are the group's, everything else is rewired
+    for (auto& filter : down_filters_) {
+      filter->RemoveAllSinks();
+    }
+    for (size_t i = 1; i < up_filters_.size(); i++) {
+      up_filters_[i]->RemoveAllSinks();
+    }
+    for (int i = 0; i + 1 < levels; i++) {
+      down_filters_[i]->AddSink(down_filters_[i + 1]);
+    }
+    down_filters_[levels - 1]->AddSink(up_filters_[levels - 1]);
+    for (int i = levels - 1; i > 0; i--) {
+      up_filters_[i]->AddSink(up_filters_[i - 1]);
+    }
+    level_count_ = levels;
+  }
+
+  // Sizes are set explicitly so odd sizes come back up exactly
+  int width = input_width_;
+  int height = input_height_;
+  up_filters_[0]->SetOutputSize(width, height);
+  for (int i = 0; i < levels; i++) {
+    width = std::max((width + 1) / 2, 1);
+    height = std::max((height + 1) / 2, 1);
+    down_filters_[i]->SetOutputSize(width, height);
+    if (i + 1 < levels) {
+      up_filters_[i + 1]->SetOutputSize(width, height);
+    }
+    down_filters_[i]->SetOffset(offset);
+    up_filters_[i]->SetOffset(offset);
+  }
+}
+
+}  // namespace gpupixel
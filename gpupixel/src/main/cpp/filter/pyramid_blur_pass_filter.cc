@@ -0,0 +1,127 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/pyramid_blur_pass_filter.h"
+#include <typeinfo>
+#include "core/gpupixel_context.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+#if defined(GPUPIXEL_GLES_SHADER)
+const std::string kPyramidBlurDownFragmentShaderString = R"(
+    varying highp vec2 textureCoordinate; uniform sampler2D inputImageTexture;
+    uniform highp vec2 texelOffset;
+
+    void main() {
+      highp vec2 offset2 = vec2(texelOffset.x, -texelOffset.y);
+      mediump vec4 sum =
+          texture2D(inputImageTexture, textureCoordinate) * 4.0;
+      sum += texture2D(inputImageTexture, textureCoordinate - texelOffset);
+      sum += texture2D(inputImageTexture, textureCoordinate + texelOffset);
+      sum += texture2D(inputImageTexture, textureCoordinate - offset2);
+      sum += texture2D(inputImageTexture, textureCoordinate + offset2);
+      gl_FragColor = sum * 0.125;
+    })";
+
+const std::string kPyramidBlurUpFragmentShaderString = R"(
+    varying highp vec2 textureCoordinate; uniform sampler2D inputImageTexture;
+    uniform highp vec2 texelOffset;
+
+    void main() {
+      highp vec2 offset2 = vec2(texelOffset.x, -texelOffset.y);
+      mediump vec4 sum = texture2D(inputImageTexture,
+                                   textureCoordinate + vec2(-2.0 * texelOffset.x, 0.0));
+      sum += texture2D(inputImageTexture,
+                       textureCoordinate + vec2(2.0 * texelOffset.x, 0.0));
+      sum += texture2D(inputImageTexture,
+                       textureCoordinate + vec2(0.0, -2.0 * texelOffset.y));
+      sum += texture2D(inputImageTexture,
+                       textureCoordinate + vec2(0.0, 2.0 * texelOffset.y));
+      sum += texture2D(inputImageTexture, textureCoordinate - texelOffset) * 2.0;
+      sum += texture2D(inputImageTexture, textureCoordinate + texelOffset) * 2.0;
+      sum += texture2D(inputImageTexture, textureCoordinate - offset2) * 2.0;
+      sum += texture2D(inputImageTexture, textureCoordinate + offset2) * 2.0;
+      gl_FragColor = sum / 12.0;
+    })";
+#elif defined(GPUPIXEL_GL_SHADER)
+const std::string kPyramidBlurDownFragmentShaderString = R"(
+    varying vec2 textureCoordinate; uniform sampler2D inputImageTexture;
+    uniform vec2 texelOffset;
+
+    void main() {
+      vec2 offset2 = vec2(texelOffset.x, -texelOffset.y);
+      vec4 sum = texture2D(inputImageTexture, textureCoordinate) * 4.0;
+      sum += texture2D(inputImageTexture, textureCoordinate - texelOffset);
+      sum += texture2D(inputImageTexture, textureCoordinate + texelOffset);
+      sum += texture2D(inputImageTexture, textureCoordinate - offset2);
+      sum += texture2D(inputImageTexture, textureCoordinate + offset2);
+      gl_FragColor = sum * 0.125;
+    })";
+
+const std::string kPyramidBlurUpFragmentShaderString = R"(
+    varying vec2 textureCoordinate; uniform sampler2D inputImageTexture;
+    uniform vec2 texelOffset;
+
+    void main() {
+      vec2 offset2 = vec2(texelOffset.x, -texelOffset.y);
+      vec4 sum = texture2D(inputImageTexture,
+                           textureCoordinate + vec2(-2.0 * texelOffset.x, 0.0));
+      sum += texture2D(inputImageTexture,
+                       textureCoordinate + vec2(2.0 * texelOffset.x, 0.0));
+      sum += texture2D(inputImageTexture,
+                       textureCoordinate + vec2(0.0, -2.0 * texelOffset.y));
+      sum += texture2D(inputImageTexture,
+                       textureCoordinate + vec2(0.0, 2.0 * texelOffset.y));
+      sum += texture2D(inputImageTexture, textureCoordinate - texelOffset) * 2.0;
+      sum += texture2D(inputImageTexture, textureCoordinate + texelOffset) * 2.0;
+      sum += texture2D(inputImageTexture, textureCoordinate - offset2) * 2.0;
+      sum += texture2D(inputImageTexture, textureCoordinate + offset2) * 2.0;
+      gl_FragColor = sum / 12.0;
+    })";
+#endif
+
+PyramidBlurPassFilter::PyramidBlurPassFilter(Type type)
+    : type_(type), offset_(1.0) {}
+
+PyramidBlurPassFilter::~PyramidBlurPassFilter() {}
+
+std::shared_ptr<PyramidBlurPassFilter> PyramidBlurPassFilter::Create(
+    Type type /* = DOWN*/) {
+  auto ret =
+      std::shared_ptr<PyramidBlurPassFilter>(new PyramidBlurPassFilter(type));
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init()) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool PyramidBlurPassFilter::Init() {
+  return InitWithFragmentShaderString(type_ == DOWN
+                                          ? kPyramidBlurDownFragmentShaderString
+                                          : kPyramidBlurUpFragmentShaderString);
+}
+
+bool PyramidBlurPassFilter::DoRender(bool updateSinks) {
+  // Taps are placed in texture space, so the texture's own size applies
+  // whatever the input rotation is
+  auto input = input_framebuffers_.begin()->second.frame_buffer;
+  // The up taps sit at half and whole |offset|
+  float offset = type_ == DOWN ? offset_ : offset_ * 0.5;
+  filter_program_->SetUniformValue(
+      "texelOffset",
+      Vector2(offset / input->GetWidth(), offset / input->GetHeight()));
+  return Filter::DoRender(updateSinks);
+}
+
+std::string PyramidBlurPassFilter::GetRenderSignature() const {
+  return Util::StringFormat("%s:%d:%f:%d:%d", typeid(*this).name(),
+                            (int)type_, offset_, output_width_,
+                            output_height_);
+}
+
+}  // namespace gpupixel
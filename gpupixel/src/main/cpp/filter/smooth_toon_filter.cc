@@ -51,6 +51,10 @@ bool SmoothToonFilter::Init() {
                      setToonQuantizationLevels(toonQuantizationLevels);
                    });
 
+  blur_engine_ = GaussianBlurFilter::SEPARABLE;
+  RegisterProperty("blurEngine", blur_engine_, "0: separable, 1: pyramid",
+                   [this](int& blurEngine) { setBlurEngine(blurEngine); });
+
   return true;
 }
 
@@ -69,4 +73,9 @@ void SmoothToonFilter::setToonQuantizationLevels(float toonQuantizationLevels) {
   toon_filter_->setQuantizatinLevels(toon_quantization_levels_);
 }
 
+void SmoothToonFilter::setBlurEngine(int blurEngine) {
+  blur_engine_ = blurEngine;
+  gaussian_blur_filter_->SetEngine((GaussianBlurFilter::Engine)blurEngine);
+}
+
 }  // namespace gpupixel
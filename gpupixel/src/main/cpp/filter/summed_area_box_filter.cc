@@ -0,0 +1,175 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/summed_area_box_filter.h"
+#include <typeinfo>
+#include "core/gpupixel_context.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+#if defined(GPUPIXEL_GLES_SHADER)
+const std::string kSummedAreaBoxFragmentShaderString = R"(
+    varying highp vec2 textureCoordinate;
+    uniform highp sampler2D inputImageTexture;
+    uniform highp vec2 tableSize;
+    uniform highp float radius;
+#if defined(GUIDED_COEFFICIENTS)
+    uniform highp float epsilon;
+#endif
+#if defined(HIGH_PASS)
+    varying highp vec2 textureCoordinate1;
+    uniform sampler2D inputImageTexture1;
+    uniform highp float delta;
+#endif
+
+    highp vec4 Fetch(highp vec2 index) {
+      return texture2D(inputImageTexture, (index + 0.5) / tableSize);
+    }
+
+    void main() {
+      highp vec2 index = floor(textureCoordinate * tableSize);
+      highp vec2 high = min(index + radius, tableSize - 1.0);
+      highp vec2 low = index - radius - 1.0;
+      // Rows and columns before the frame add nothing
+      highp vec2 inside = step(0.0, low);
+      low = max(low, 0.0);
+      highp vec4 sum = Fetch(high) - Fetch(vec2(low.x, high.y)) * inside.x -
+                       Fetch(vec2(high.x, low.y)) * inside.y +
+                       Fetch(low) * inside.x * inside.y;
+      highp vec2 extent = high - max(index - radius, 0.0) + 1.0;
+      highp vec4 mean = sum / (extent.x * extent.y);
+
+#if defined(VARIANCE)
+      highp float variance = max(mean.g - mean.r * mean.r, 0.0);
+      gl_FragColor =
+          vec4(mean.r + 0.5, min(sqrt(variance) * 2.0, 1.0), 0.0, 1.0);
+#elif defined(GUIDED_COEFFICIENTS)
+      highp float meanLuminance = dot(mean.rgb, vec3(0.2125, 0.7154, 0.0721));
+      highp float variance = max(mean.a - meanLuminance * meanLuminance, 0.0);
+      highp float a = variance / (variance + epsilon);
+      gl_FragColor = vec4(a, (1.0 - a) * (mean.rgb + 0.5));
+#elif defined(HIGH_PASS)
+      mean += 0.5;
+      lowp vec3 iColor = texture2D(inputImageTexture1, textureCoordinate1).rgb;
+      highp vec3 diffColor = (iColor - mean.rgb) * delta;
+      OUTPUT0 = vec4(min(diffColor * diffColor, 1.0), 1.0);
+      OUTPUT1 = mean;
+#else
+      gl_FragColor = mean + 0.5;
+#endif
+    })";
+#elif defined(GPUPIXEL_GL_SHADER)
+const std::string kSummedAreaBoxFragmentShaderString = R"(
+    varying vec2 textureCoordinate;
+    uniform sampler2D inputImageTexture;
+    uniform vec2 tableSize;
+    uniform float radius;
+#if defined(GUIDED_COEFFICIENTS)
+    uniform float epsilon;
+#endif
+#if defined(HIGH_PASS)
+    varying vec2 textureCoordinate1;
+    uniform sampler2D inputImageTexture1;
+    uniform float delta;
+#endif
+
+    vec4 Fetch(vec2 index) {
+      return texture2D(inputImageTexture, (index + 0.5) / tableSize);
+    }
+
+    void main() {
+      vec2 index = floor(textureCoordinate * tableSize);
+      vec2 high = min(index + radius, tableSize - 1.0);
+      vec2 low = index - radius - 1.0;
+      // Rows and columns before the frame add nothing
+      vec2 inside = step(0.0, low);
+      low = max(low, 0.0);
+      vec4 sum = Fetch(high) - Fetch(vec2(low.x, high.y)) * inside.x -
+                 Fetch(vec2(high.x, low.y)) * inside.y +
+                 Fetch(low) * inside.x * inside.y;
+      vec2 extent = high - max(index - radius, 0.0) + 1.0;
+      vec4 mean = sum / (extent.x * extent.y);
+
+#if defined(VARIANCE)
+      float variance = max(mean.g - mean.r * mean.r, 0.0);
+      gl_FragColor =
+          vec4(mean.r + 0.5, min(sqrt(variance) * 2.0, 1.0), 0.0, 1.0);
+#elif defined(GUIDED_COEFFICIENTS)
+      float meanLuminance = dot(mean.rgb, vec3(0.2125, 0.7154, 0.0721));
+      float variance = max(mean.a - meanLuminance * meanLuminance, 0.0);
+      float a = variance / (variance + epsilon);
+      gl_FragColor = vec4(a, (1.0 - a) * (mean.rgb + 0.5));
+#elif defined(HIGH_PASS)
+      mean += 0.5;
+      vec3 iColor = texture2D(inputImageTexture1, textureCoordinate1).rgb;
+      vec3 diffColor = (iColor - mean.rgb) * delta;
+      OUTPUT0 = vec4(min(diffColor * diffColor, 1.0), 1.0);
+      OUTPUT1 = mean;
+#else
+      gl_FragColor = mean + 0.5;
+#endif
+    })";
+#endif
+
+SummedAreaBoxFilter::SummedAreaBoxFilter(Mode mode)
+    : mode_(mode), radius_(4), delta_(7.07), epsilon_(0.01) {}
+
+SummedAreaBoxFilter::~SummedAreaBoxFilter() {}
+
+std::shared_ptr<SummedAreaBoxFilter> SummedAreaBoxFilter::Create(
+    Mode mode /* = MEAN*/,
+    int radius /* = 4*/) {
+  auto ret =
+      std::shared_ptr<SummedAreaBoxFilter>(new SummedAreaBoxFilter(mode));
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init(radius)) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool SummedAreaBoxFilter::Init(int radius) {
+  radius_ = radius;
+  if (mode_ == HIGH_PASS) {
+    return InitWithFragmentShaderString(
+        "#define HIGH_PASS\n" + kSummedAreaBoxFragmentShaderString, 2, 2);
+  }
+  if (mode_ == GUIDED_COEFFICIENTS) {
+    SetOutputFormat(RGBA32F);
+    return InitWithFragmentShaderString("#define GUIDED_COEFFICIENTS\n" +
+                                        kSummedAreaBoxFragmentShaderString);
+  }
+  return InitWithFragmentShaderString(
+      (mode_ == VARIANCE ? "#define VARIANCE\n" : "") +
+      kSummedAreaBoxFragmentShaderString);
+}
+
+bool SummedAreaBoxFilter::DoRender(bool updateSinks) {
+  auto table = input_framebuffers_[0].frame_buffer;
+  filter_program_->SetUniformValue(
+      "tableSize",
+      Vector2((float)table->GetWidth(), (float)table->GetHeight()));
+  filter_program_->SetUniformValue("radius", (float)radius_);
+  if (mode_ == HIGH_PASS) {
+    filter_program_->SetUniformValue("delta", delta_);
+  }
+  if (mode_ == GUIDED_COEFFICIENTS) {
+    filter_program_->SetUniformValue("epsilon", epsilon_);
+  }
+  return Filter::DoRender(updateSinks);
+}
+
+std::string SummedAreaBoxFilter::GetRenderSignature() const {
+  // FilterGroup only passes on output 0 of a shared filter
+  if (mode_ == HIGH_PASS) {
+    return "";
+  }
+  return Util::StringFormat("%s:%d:%d:%f", typeid(*this).name(), (int)mode_,
+                            radius_, epsilon_);
+}
+
+}  // namespace gpupixel
@@ -0,0 +1,144 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/summed_area_table_filter.h"
+#include <algorithm>
+#include "core/gpupixel_context.h"
+#include "utils/logging.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+namespace {
+// Passes of 4^i steps until the steps cover |size|
+int PassCount(int size) {
+  int count = 1;
+  for (int covered = 4; covered < size; covered *= 4) {
+    count++;
+  }
+  return count;
+}
+}  // namespace
+
+SummedAreaTableFilter::SummedAreaTableFilter()
+    : content_(COLOR), horizontal_pass_count_(0), vertical_pass_count_(0) {}
+
+SummedAreaTableFilter::~SummedAreaTableFilter() {}
+
+std::shared_ptr<SummedAreaTableFilter> SummedAreaTableFilter::Create(
+    Content content /* = COLOR*/) {
+  auto ret =
+      std::shared_ptr<SummedAreaTableFilter>(new SummedAreaTableFilter());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init(content)) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool SummedAreaTableFilter::IsSupported() {
+  return GPUPixelContext::GetInstance()->IsFloatRenderTargetAvailable();
+}
+
+bool SummedAreaTableFilter::Init(Content content) {
+  if (!FilterGroup::Init()) {
+    return false;
+  }
+  if (!IsSupported()) {
+    LOG_ERROR("SummedAreaTableFilter: float render targets are not available");
+    return false;
+  }
+  content_ = content;
+
+  SummedAreaTablePassFilter::Transform transform =
+      SummedAreaTablePassFilter::CENTER;
+  if (content == LUMINANCE_MOMENTS) {
+    transform = SummedAreaTablePassFilter::MOMENTS;
+  } else if (content == COLOR_AND_LUMINANCE_SQUARE) {
+    transform = SummedAreaTablePassFilter::CENTER_AND_SQUARE;
+  }
+  horizontal_filters_.push_back(
+      CreatePass(SummedAreaTablePassFilter::HORIZONTAL, 1, transform));
+  vertical_filters_.push_back(
+      CreatePass(SummedAreaTablePassFilter::VERTICAL, 1));
+  if (!horizontal_filters_[0] || !vertical_filters_[0]) {
+    return false;
+  }
+  horizontal_filters_[0]->AddSink(vertical_filters_[0]);
+  AddFilter(horizontal_filters_[0]);
+  horizontal_pass_count_ = 1;
+  vertical_pass_count_ = 1;
+  return true;
+}
+
+std::shared_ptr<SummedAreaTablePassFilter> SummedAreaTableFilter::CreatePass(
+    SummedAreaTablePassFilter::Direction direction,
+    int step,
+    SummedAreaTablePassFilter::Transform transform /* = NONE*/) {
+  auto pass = SummedAreaTablePassFilter::Create(direction, transform);
+  if (pass) {
+    pass->SetStep(step);
+    pass->SetOutputFormat(content_ == LUMINANCE_MOMENTS ? RG32F : RGBA32F);
+  }
+  return pass;
+}
+
+void SummedAreaTableFilter::SetInputFramebuffer(
+    std::shared_ptr<GPUPixelFramebuffer> framebuffer,
+    RotationMode rotation_mode /* = NoRotation*/,
+    int texIdx /* = 0*/) {
+  if (framebuffer) {
+    int width = framebuffer->GetWidth();
+    int height = framebuffer->GetHeight();
+    if (rotationSwapsSize(rotation_mode)) {
+      std::swap(width, height);
+    }
+    UpdatePasses(width, height);
+  }
+  FilterGroup::SetInputFramebuffer(framebuffer, rotation_mode, texIdx);
+}
+
+void SummedAreaTableFilter::UpdatePasses(int width, int height) {
+  int horizontal_count = PassCount(width);
+  int vertical_count = PassCount(height);
+  if (horizontal_count == horizontal_pass_count_ &&
+      vertical_count == vertical_pass_count_) {
+    return;
+  }
+
+  while ((int)horizontal_filters_.size() < horizontal_count) {
+    horizontal_filters_.push_back(
+        CreatePass(SummedAreaTablePassFilter::HORIZONTAL,
+                   1 << (2 * horizontal_filters_.size())));
+  }
+  while ((int)vertical_filters_.size() < vertical_count) {
+    vertical_filters_.push_back(
+        CreatePass(SummedAreaTablePassFilter::VERTICAL,
+                   1 << (2 * vertical_filters_.size())));
+  }
+
+  // The sinks of vertical_filters_[0] are the group's, the rest is rewired
+  std::vector<std::shared_ptr<SummedAreaTablePassFilter>> chain(
+      horizontal_filters_.begin(),
+      horizontal_filters_.begin() + horizontal_count);
+  chain.insert(chain.end(), vertical_filters_.rbegin() +
+                                (vertical_filters_.size() - vertical_count),
+               vertical_filters_.rend());
+  for (auto& filter : horizontal_filters_) {
+    filter->RemoveAllSinks();
+  }
+  for (size_t i = 1; i < vertical_filters_.size(); i++) {
+    vertical_filters_[i]->RemoveAllSinks();
+  }
+  for (size_t i = 0; i + 1 < chain.size(); i++) {
+    chain[i]->AddSink(chain[i + 1]);
+  }
+
+  horizontal_pass_count_ = horizontal_count;
+  vertical_pass_count_ = vertical_count;
+}
+
+}  // namespace gpupixel
@@ -0,0 +1,159 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "gpupixel/filter/summed_area_table_pass_filter.h"
+#include "core/gpupixel_context.h"
+#include "utils/util.h"
+namespace gpupixel {
+
+// |pixelCoordinate| is the output pixel, the steps are counted in output
+// pixels whatever the rotation of the input is
+const std::string kSummedAreaTablePassVertexShaderString = R"(
+    attribute vec4 position; attribute vec4 inputTextureCoordinate;
+    uniform vec2 outputSize;
+
+    varying vec2 textureCoordinate;
+    varying vec2 pixelCoordinate;
+
+    void main() {
+      gl_Position = position;
+      textureCoordinate = inputTextureCoordinate.xy;
+      pixelCoordinate = (position.xy * 0.5 + 0.5) * outputSize;
+    })";
+
+#if defined(GPUPIXEL_GLES_SHADER)
+const std::string kSummedAreaTablePassFragmentShaderString = R"(
+    varying highp vec2 textureCoordinate; varying highp vec2 pixelCoordinate;
+    uniform highp sampler2D inputImageTexture;
+    uniform highp vec2 stepOffset;
+    uniform highp float stepPixels;
+    uniform highp vec2 axis;
+
+    highp vec4 Fetch(highp vec2 coordinate) {
+      highp vec4 color = texture2D(inputImageTexture, coordinate);
+#if defined(MOMENTS)
+      highp float luminance =
+          dot(color.rgb, vec3(0.2125, 0.7154, 0.0721)) - 0.5;
+      return vec4(luminance, luminance * luminance, 0.0, 0.0);
+#elif defined(CENTER_AND_SQUARE)
+      highp float luminance =
+          dot(color.rgb, vec3(0.2125, 0.7154, 0.0721)) - 0.5;
+      return vec4(color.rgb - 0.5, luminance * luminance);
+#elif defined(CENTER)
+      return color - 0.5;
+#else
+      return color;
+#endif
+    }
+
+    void main() {
+      highp float index = dot(floor(pixelCoordinate), axis);
+      highp vec4 sum = Fetch(textureCoordinate);
+      sum += Fetch(textureCoordinate - stepOffset) *
+             step(stepPixels - 0.5, index);
+      sum += Fetch(textureCoordinate - stepOffset * 2.0) *
+             step(stepPixels * 2.0 - 0.5, index);
+      sum += Fetch(textureCoordinate - stepOffset * 3.0) *
+             step(stepPixels * 3.0 - 0.5, index);
+      gl_FragColor = sum;
+    })";
+#elif defined(GPUPIXEL_GL_SHADER)
+const std::string kSummedAreaTablePassFragmentShaderString = R"(
+    varying vec2 textureCoordinate; varying vec2 pixelCoordinate;
+    uniform sampler2D inputImageTexture;
+    uniform vec2 stepOffset;
+    uniform float stepPixels;
+    uniform vec2 axis;
+
+    vec4 Fetch(vec2 coordinate) {
+      vec4 color = texture2D(inputImageTexture, coordinate);
+#if defined(MOMENTS)
+      float luminance = dot(color.rgb, vec3(0.2125, 0.7154, 0.0721)) - 0.5;
+      return vec4(luminance, luminance * luminance, 0.0, 0.0);
+#elif defined(CENTER_AND_SQUARE)
+      float luminance = dot(color.rgb, vec3(0.2125, 0.7154, 0.0721)) - 0.5;
+      return vec4(color.rgb - 0.5, luminance * luminance);
+#elif defined(CENTER)
+      return color - 0.5;
+#else
+      return color;
+#endif
+    }
+
+    void main() {
+      float index = dot(floor(pixelCoordinate), axis);
+      vec4 sum = Fetch(textureCoordinate);
+      sum += Fetch(textureCoordinate - stepOffset) *
+             step(stepPixels - 0.5, index);
+      sum += Fetch(textureCoordinate - stepOffset * 2.0) *
+             step(stepPixels * 2.0 - 0.5, index);
+      sum += Fetch(textureCoordinate - stepOffset * 3.0) *
+             step(stepPixels * 3.0 - 0.5, index);
+      gl_FragColor = sum;
+    })";
+#endif
+
+SummedAreaTablePassFilter::SummedAreaTablePassFilter(Direction direction,
+                                                     Transform transform)
+    : direction_(direction), transform_(transform), step_(1) {}
+
+SummedAreaTablePassFilter::~SummedAreaTablePassFilter() {}
+
+std::shared_ptr<SummedAreaTablePassFilter> SummedAreaTablePassFilter::Create(
+    Direction direction,
+    Transform transform /* = NONE*/) {
+  auto ret = std::shared_ptr<SummedAreaTablePassFilter>(
+      new SummedAreaTablePassFilter(direction, transform));
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (ret && !ret->Init()) {
+      ret.reset();
+    }
+  });
+  return ret;
+}
+
+bool SummedAreaTablePassFilter::Init() {
+  std::string defines;
+  if (transform_ == MOMENTS) {
+    defines = "#define MOMENTS\n";
+  } else if (transform_ == CENTER_AND_SQUARE) {
+    defines = "#define CENTER_AND_SQUARE\n";
+  } else if (transform_ == CENTER) {
+    defines = "#define CENTER\n";
+  }
+  SetOutputFormat(transform_ == MOMENTS ? RG32F : RGBA32F);
+  return InitWithShaderString(kSummedAreaTablePassVertexShaderString,
+                              defines +
+                                  kSummedAreaTablePassFragmentShaderString);
+}
+
+bool SummedAreaTablePassFilter::DoRender(bool updateSinks) {
+  auto& input = input_framebuffers_.begin()->second;
+  int width = framebuffer_->GetWidth();
+  int height = framebuffer_->GetHeight();
+
+  // Texture coordinates of the bottom left, bottom right and top left
+  // corners give the texture space direction of the output axes
+  const float* coordinates = GetTextureCoordinate(input.rotation_mode);
+  Vector2 step_offset;
+  if (direction_ == HORIZONTAL) {
+    step_offset = Vector2((coordinates[2] - coordinates[0]) * step_ / width,
+                          (coordinates[3] - coordinates[1]) * step_ / width);
+  } else {
+    step_offset = Vector2((coordinates[4] - coordinates[0]) * step_ / height,
+                          (coordinates[5] - coordinates[1]) * step_ / height);
+  }
+
+  filter_program_->SetUniformValue("outputSize",
+                                   Vector2((float)width, (float)height));
+  filter_program_->SetUniformValue("stepOffset", step_offset);
+  filter_program_->SetUniformValue("stepPixels", (float)step_);
+  filter_program_->SetUniformValue(
+      "axis", direction_ == HORIZONTAL ? Vector2(1, 0) : Vector2(0, 1));
+  return Filter::DoRender(updateSinks);
+}
+
+}  // namespace gpupixel
@@ -7,27 +7,209 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "gpupixel/gpupixel_define.h"
+#include "gpupixel/utils/face_landmarks.h"
 
 namespace mars_face_kit {
 class MarsFaceDetector;
+struct FaceDetectionInfo;
 }
 
 namespace gpupixel {
 
+// Landmarks per face: the 106 model points followed by 5 derived centers
+constexpr int kFaceLandmarkCount = FaceLandmarks::kPointCount;
+
+// One detected face, coordinates normalized to the upright frame
+struct GPUPIXEL_API FaceInfo {
+  int face_id = 0;
+  float score = 0;
+  // left, top, right, bottom
+  float rect[4] = {0, 0, 0, 0};
+  float pitch = 0;
+  float yaw = 0;
+  float roll = 0;
+  // kFaceLandmarkCount x,y pairs
+  std::vector<float> landmarks;
+};
+
 class GPUPIXEL_API FaceDetector {
  public:
   static std::shared_ptr<FaceDetector> Create();
+  ~FaceDetector();
+
+  // Returns normalized landmarks of the upright frame, see SetMaxFaces.
+  // RGBA/BGRA frames are detected in color, YUV and GRAY frames on their luma
+  // plane only, so |stride| is the row pitch of the first plane. |rotation|
+  // is the clockwise rotation in degrees (0, 90, 180, 270) that makes the
+  // frame upright.
   std::vector<float> Detect(const uint8_t* data,
                             int width,
                             int height,
                             int stride,
                             GPUPIXEL_MODE_FMT fmt,
-                            GPUPIXEL_FRAME_TYPE type);
+                            GPUPIXEL_FRAME_TYPE type,
+                            int rotation = 0);
+
+  // Same as Detect(), filled into a pooled FaceLandmarks that can be handed
+  // to the face filters as is. Nothing is allocated per frame.
+  std::shared_ptr<const FaceLandmarks> DetectLandmarks(
+      const uint8_t* data,
+      int width,
+      int height,
+      int stride,
+      GPUPIXEL_MODE_FMT fmt,
+      GPUPIXEL_FRAME_TYPE type,
+      int rotation = 0,
+      int64_t timestamp = 0);
+
+  // Same as Detect() but with the details of every face
+  std::vector<FaceInfo> DetectFaces(const uint8_t* data,
+                                    int width,
+                                    int height,
+                                    int stride,
+                                    GPUPIXEL_MODE_FMT fmt,
+                                    GPUPIXEL_FRAME_TYPE type,
+                                    int rotation = 0);
+
+  // Faces returned per frame, 1 by default and at most
+  // FaceLandmarks::kMaxFaces. Landmark vectors hold kFaceLandmarkCount * 2
+  // floats per face, face after face.
+  void SetMaxFaces(int count);
+  int GetMaxFaces() const { return max_faces_; }
+
+  // Frames whose longer side exceeds |size| are downscaled to it before
+  // detection. 0 detects at full resolution.
+  void SetDetectSize(int size);
+  int GetDetectSize() const { return detect_size_; }
+
+  // In GPUPIXEL_MODE_FMT_VIDEO the whole frame is searched every |interval|
+  // frames. Frames in between only search a region around the last face and
+  // fall back to a full search when the face is lost. 1 disables tracking.
+  void SetDetectInterval(int interval);
+  int GetDetectInterval() const { return detect_interval_; }
+
+  // Tracked faces scoring below this trigger a full-frame search
+  void SetTrackingThreshold(float score);
+
+  // Forget the tracked face, the next frame is searched in full
+  void ResetTracking();
+
+  // Whether the last Detect() call searched the whole frame
+  bool IsLastDetectFull() const { return last_detect_full_; }
+
+  // Queue a frame for detection on a worker thread and return immediately.
+  // The frame is copied into a single slot; a frame still waiting there is
+  // replaced, so the worker always picks up the newest one. Results carry
+  // |timestamp| of the frame they were detected on.
+  void DetectAsync(const uint8_t* data,
+                   int width,
+                   int height,
+                   int stride,
+                   GPUPIXEL_MODE_FMT fmt,
+                   GPUPIXEL_FRAME_TYPE type,
+                   int rotation,
+                   int64_t timestamp);
+
+  // Newest asynchronous result, nullptr if none has been published yet
+  std::shared_ptr<const FaceLandmarks> GetLatestFaceLandmarks();
+  bool GetLatestLandmarks(std::vector<float>& landmarks, int64_t& timestamp);
+
+  // Newest asynchronous result moved to |timestamp| along the motion between
+  // the last two results, extrapolating at most one result interval ahead
+  std::shared_ptr<const FaceLandmarks> GetFaceLandmarksAt(int64_t timestamp);
+  std::vector<float> GetLandmarksAt(int64_t timestamp);
+
+  // Called on the worker thread whenever a result is published
+  using ResultCallback =
+      std::function<void(std::shared_ptr<const FaceLandmarks> landmarks)>;
+  void SetResultCallback(ResultCallback callback);
 
  private:
   FaceDetector();
+  void PrepareImage(const uint8_t*& data,
+                    int& width,
+                    int& height,
+                    int& stride,
+                    GPUPIXEL_FRAME_TYPE& type,
+                    int rotation);
+  void DetectFrame(const uint8_t* data,
+                   int width,
+                   int height,
+                   int stride,
+                   GPUPIXEL_FRAME_TYPE type,
+                   std::vector<mars_face_kit::FaceDetectionInfo>& faces);
+  bool TrackFace(const uint8_t* data,
+                 int width,
+                 int height,
+                 int stride,
+                 GPUPIXEL_FRAME_TYPE type,
+                 std::vector<mars_face_kit::FaceDetectionInfo>& faces);
+  void UpdateTrack(const std::vector<mars_face_kit::FaceDetectionInfo>& faces);
+  void AsyncWorker();
+
   std::shared_ptr<mars_face_kit::MarsFaceDetector> mars_face_detector_;
+
+  int max_faces_ = 1;
+
+  // Tracking state, in pixels of the detection image. The tracked region
+  // covers all faces found in the last frame.
+  int detect_interval_ = 10;
+  float tracking_threshold_ = 0.5f;
+  int frames_since_detect_ = 0;
+  bool has_track_ = false;
+  int tracked_faces_ = 0;
+  bool last_detect_full_ = true;
+  float track_left_ = 0;
+  float track_top_ = 0;
+  float track_right_ = 0;
+  float track_bottom_ = 0;
+  int last_width_ = 0;
+  int last_height_ = 0;
+  std::vector<uint8_t> crop_buffer_;
+
+  // Downscaled and rotated copies handed to the detector
+  int detect_size_ = 0;
+  std::vector<uint8_t> scale_buffer_;
+  std::vector<uint8_t> rotate_buffer_;
+
+  // Serializes Detect() between callers and the async worker
+  std::mutex detect_mutex_;
+
+  // Latest-wins mailbox feeding the async worker
+  struct AsyncFrame {
+    std::vector<uint8_t> data;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    GPUPIXEL_MODE_FMT fmt = GPUPIXEL_MODE_FMT_VIDEO;
+    GPUPIXEL_FRAME_TYPE type = GPUPIXEL_FRAME_TYPE_RGBA;
+    int rotation = 0;
+    int64_t timestamp = 0;
+  };
+  std::thread async_thread_;
+  std::mutex async_mutex_;
+  std::condition_variable async_cv_;
+  AsyncFrame pending_frame_;
+  bool has_pending_frame_ = false;
+  bool async_stop_ = false;
+
+  // Results handed out, recycled once released
+  std::shared_ptr<FaceLandmarksPool> landmarks_pool_;
+  // Reused across frames
+  std::vector<mars_face_kit::FaceDetectionInfo> face_info_;
+
+  // Last two published results, for extrapolation
+  std::mutex result_mutex_;
+  std::shared_ptr<const FaceLandmarks> result_landmarks_;
+  std::shared_ptr<const FaceLandmarks> previous_landmarks_;
+  ResultCallback result_callback_;
 };
 }  // namespace gpupixel
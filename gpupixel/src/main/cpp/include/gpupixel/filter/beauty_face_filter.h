@@ -11,10 +11,19 @@
 #include "gpupixel/filter/box_blur_filter.h"
 #include "gpupixel/filter/box_high_pass_filter.h"
 #include "gpupixel/filter/gaussian_blur_filter.h"
+#include "gpupixel/filter/guided_filter.h"
 
 namespace gpupixel {
 class GPUPIXEL_API BeautyFaceFilter : public FilterGroup {
  public:
+  // What feeds the smoothed image and high pass of skin_smoothing
+  enum SmoothingEngine {
+    // Box mean and the box high pass around it
+    BOX_HIGH_PASS = 0,
+    // Edge-preserving guided filter, needs float render targets
+    GUIDED,
+  };
+
   static std::shared_ptr<BeautyFaceFilter> Create();
 
   ~BeautyFaceFilter();
@@ -26,6 +35,8 @@ class GPUPIXEL_API BeautyFaceFilter : public FilterGroup {
   void SetBlurAlpha(float blurAlpha);
   void SetWhite(float white);
   void SetRadius(float sigma);
+  void SetSmoothingEngine(SmoothingEngine engine);
+  SmoothingEngine GetSmoothingEngine() const { return smoothing_engine_; }
 
   virtual void SetInputFramebuffer(
       std::shared_ptr<GPUPixelFramebuffer> framebuffer,
@@ -34,9 +45,16 @@ class GPUPIXEL_API BeautyFaceFilter : public FilterGroup {
 
  private:
   BeautyFaceFilter();
-  std::shared_ptr<BoxBlurFilter> box_blur_filter_;
+  // Connects the engine's outputs to the unit filter
+  void ConnectSmoothing(std::shared_ptr<Source> smoothed_output,
+                        std::shared_ptr<Source> high_pass_output);
+
   std::shared_ptr<BoxHighPassFilter> box_high_pass_filter_;
+  std::shared_ptr<GuidedFilter> guided_filter_;
   std::shared_ptr<BeautyFaceUnitFilter> beauty_face_filter_;
+  SmoothingEngine smoothing_engine_;
+  float radius_;
+  float high_pass_delta_;
 };
 
 }  // namespace gpupixel
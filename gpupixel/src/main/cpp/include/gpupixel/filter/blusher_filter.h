@@ -12,6 +12,9 @@ namespace gpupixel {
 class GPUPIXEL_API BlusherFilter : public FaceMakeupFilter {
  public:
   static std::shared_ptr<BlusherFilter> Create();
+  // The layer, for drawing it with others in one FaceMakeupFilter
+  static std::shared_ptr<SourceImage> CreateTexture();
+  static FrameBounds GetTextureBounds();
   bool Init() override;
 
  private:
@@ -10,9 +10,19 @@
 
 #include "gpupixel/filter/box_mono_blur_filter.h"
 #include "gpupixel/filter/filter_group.h"
+#include "gpupixel/filter/summed_area_box_filter.h"
+#include "gpupixel/filter/summed_area_table_filter.h"
 namespace gpupixel {
 class GPUPIXEL_API BoxBlurFilter : public FilterGroup {
  public:
+  enum Engine {
+    // Horizontal and vertical passes of 2 * radius + 1 taps
+    SEPARABLE = 0,
+    // Summed-area table and 4 reads per pixel, the box is contiguous even
+    // with a texel spacing multiplier. Needs float render targets.
+    SUMMED_AREA_TABLE,
+  };
+
   virtual ~BoxBlurFilter();
 
   static std::shared_ptr<BoxBlurFilter> Create(int radius = 4,
@@ -21,13 +31,22 @@ class GPUPIXEL_API BoxBlurFilter : public FilterGroup {
   void SetRadius(int radius);
   void setSigma(float sigma);
   void SetTexelSpacingMultiplier(float value);
+  void SetEngine(Engine engine);
+  Engine GetEngine() const { return engine_; }
 
  protected:
   BoxBlurFilter();
 
  private:
+  // Half width in pixels of the box the separable passes cover
+  int GetBoxRadius() const;
+
   std::shared_ptr<BoxMonoBlurFilter> horizontal_blur_filter_;
   std::shared_ptr<BoxMonoBlurFilter> vertical_blur_filter_;
+  std::shared_ptr<SummedAreaTableFilter> summed_area_table_filter_;
+  std::shared_ptr<SummedAreaBoxFilter> summed_area_box_filter_;
+  float texel_spacing_;
+  Engine engine_;
 };
 
 }  // namespace gpupixel
@@ -8,18 +8,31 @@
 
 #include "gpupixel/gpupixel_define.h"
 
-#include "gpupixel/filter/box_blur_filter.h"
-#include "gpupixel/filter/box_difference_filter.h"
+#include "gpupixel/filter/box_high_pass_mono_filter.h"
+#include "gpupixel/filter/box_mono_blur_filter.h"
 #include "gpupixel/filter/filter_group.h"
+#include "gpupixel/filter/summed_area_box_filter.h"
+#include "gpupixel/filter/summed_area_table_filter.h"
 namespace gpupixel {
 class GPUPIXEL_API BoxHighPassFilter : public FilterGroup {
  public:
+  // See BoxBlurFilter::Engine
+  enum Engine { SEPARABLE = 0, SUMMED_AREA_TABLE };
+
   static std::shared_ptr<BoxHighPassFilter> Create();
   ~BoxHighPassFilter();
   bool Init();
 
   void SetRadius(float radius);
   void SetDelta(float delta);
+  // Sinks of the mean output move along
+  void SetEngine(Engine engine);
+  Engine GetEngine() const { return engine_; }
+
+  // The box blurred input, rendered by the same pass as the high pass
+  std::shared_ptr<Source> GetMeanOutput() const;
+  // Half width in pixels of the box the separable passes cover
+  int GetBoxRadius() const;
 
   virtual void SetInputFramebuffer(
       std::shared_ptr<GPUPixelFramebuffer> framebuffer,
@@ -29,8 +42,12 @@ class GPUPIXEL_API BoxHighPassFilter : public FilterGroup {
  protected:
   BoxHighPassFilter();
 
-  std::shared_ptr<BoxBlurFilter> box_blur_filter_;
-  std::shared_ptr<BoxDifferenceFilter> box_difference_filter_;
+  std::shared_ptr<BoxMonoBlurFilter> horizontal_blur_filter_;
+  std::shared_ptr<BoxHighPassMonoFilter> vertical_high_pass_filter_;
+  std::shared_ptr<SummedAreaTableFilter> summed_area_table_filter_;
+  std::shared_ptr<SummedAreaBoxFilter> summed_area_high_pass_filter_;
+  float delta_;
+  Engine engine_;
 };
 
 }  // namespace gpupixel
@@ -0,0 +1,41 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/gpupixel_define.h"
+
+#include "gpupixel/filter/box_mono_blur_filter.h"
+
+namespace gpupixel {
+// Vertical half of BoxHighPassFilter. Finishes the box blur of input 0, which
+// is blurred horizontally already, and compares it with the unblurred input 1
+// in the same pass. Output 0 is the squared difference scaled by delta, output
+// 1 the blurred mean.
+class GPUPIXEL_API BoxHighPassMonoFilter : public BoxMonoBlurFilter {
+ public:
+  static std::shared_ptr<BoxHighPassMonoFilter> Create(int radius = 4);
+  ~BoxHighPassMonoFilter();
+  bool Init(int radius);
+
+  virtual bool DoRender(bool updateSinks = true) override;
+  // FilterGroup only passes on output 0 of a shared filter
+  virtual std::string GetRenderSignature() const override { return ""; }
+
+  void SetDelta(float delta);
+
+ protected:
+  BoxHighPassMonoFilter();
+
+  std::string GenerateOptimizedVertexShaderString(int radius,
+                                                  float sigma) override;
+  std::string GenerateOptimizedFragmentShaderString(int radius,
+                                                    float sigma) override;
+
+  float delta_;
+};
+
+}  // namespace gpupixel
@@ -20,6 +20,10 @@ class GPUPIXEL_API BoxMonoBlurFilter : public GaussianBlurMonoFilter {
   bool Init(int radius, float sigma);
   void SetRadius(int radius);
 
+  // Half width in pixels of the box that a pass with |radius| covers when
+  // its 2 * radius + 1 taps are spaced |texel_spacing| apart
+  static int GetBoxRadius(int radius, float texel_spacing);
+
  protected:
   BoxMonoBlurFilter(Type type);
 
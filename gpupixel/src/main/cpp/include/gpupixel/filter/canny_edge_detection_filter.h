@@ -9,6 +9,7 @@
 #include "gpupixel/filter/directional_non_maximum_suppression_filter.h"
 #include "gpupixel/filter/directional_sobel_edge_detection_filter.h"
 #include "gpupixel/filter/filter_group.h"
+#include "gpupixel/filter/gaussian_sobel_pass_filter.h"
 #include "gpupixel/filter/grayscale_filter.h"
 #include "gpupixel/filter/single_component_gaussian_blur_filter.h"
 #include "gpupixel/filter/weak_pixel_inclusion_filter.h"
@@ -17,10 +18,26 @@
 namespace gpupixel {
 class GPUPIXEL_API CannyEdgeDetectionFilter : public FilterGroup {
  public:
+  // How the luminance, blur and gradient steps are rendered
+  enum Engine {
+    // Grayscale, two blur passes and Sobel, each to an RGBA8 target
+    SEPARATE_PASSES = 0,
+    // Two GaussianSobelPassFilter passes, needs float render targets
+    FUSED,
+  };
+
   static std::shared_ptr<CannyEdgeDetectionFilter> Create();
   ~CannyEdgeDetectionFilter();
   bool Init();
 
+  void SetEngine(Engine engine);
+  Engine GetEngine() const { return engine_; }
+
+  // The horizontal and vertical gradients of the blurred luminance in r and g,
+  // written by the same pass as the gradient magnitude and direction. Either
+  // engine writes them only while a sink is connected.
+  std::shared_ptr<Source> GetGradientOutput() const;
+
  protected:
   CannyEdgeDetectionFilter();
 
@@ -30,6 +47,10 @@ class GPUPIXEL_API CannyEdgeDetectionFilter : public FilterGroup {
   std::shared_ptr<DirectionalNonMaximumSuppressionFilter>
       non_maximum_suppression_filter_;
   std::shared_ptr<WeakPixelInclusionFilter> weak_pixel_inclusion_filter_;
+  // FUSED front end, created on first use
+  std::shared_ptr<GaussianSobelPassFilter> horizontal_pass_filter_;
+  std::shared_ptr<GaussianSobelPassFilter> vertical_pass_filter_;
+  Engine engine_;
 };
 
 }  // namespace gpupixel
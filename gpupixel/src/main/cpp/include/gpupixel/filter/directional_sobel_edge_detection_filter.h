@@ -13,8 +13,11 @@ namespace gpupixel {
 class GPUPIXEL_API DirectionalSobelEdgeDetectionFilter
     : public NearbySampling3x3Filter {
  public:
-  static std::shared_ptr<DirectionalSobelEdgeDetectionFilter> Create();
-  bool Init();
+  // |gradient_output| adds output 1 with the horizontal and vertical
+  // gradients in r and g, from the same samples
+  static std::shared_ptr<DirectionalSobelEdgeDetectionFilter> Create(
+      bool gradient_output = false);
+  bool Init(bool gradient_output = false);
 
  protected:
   DirectionalSobelEdgeDetectionFilter() {};
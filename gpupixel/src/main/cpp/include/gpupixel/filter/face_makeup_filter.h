@@ -7,8 +7,10 @@
 #pragma once
 
 #include "gpupixel/filter/filter.h"
+#include "gpupixel/utils/face_landmarks.h"
 
 namespace gpupixel {
+class GPUPixelFramebuffer;
 class SourceImage;
 
 typedef struct GPUPIXEL_API {
@@ -20,35 +22,74 @@ typedef struct GPUPIXEL_API {
 
 class GPUPIXEL_API FaceMakeupFilter : public Filter {
  public:
+  // Layers drawn in one pass, must match MAX_LAYERS in the shader
+  static constexpr int kMaxLayers = 4;
+
   static std::shared_ptr<FaceMakeupFilter> Create();
   ~FaceMakeupFilter();
   virtual bool Init();
   virtual bool DoRender(bool updateSinks = true) override;
 
-  inline void SetBlendLevel(float level) { this->blend_level_ = level; }
-  void SetFaceLandmarks(std::vector<float> landmarks);
+  // Level of the first layer
+  inline void SetBlendLevel(float level) { SetLayerLevel(0, level); }
+  // Adds a layer drawn over the previous ones, |bounds| is where the face
+  // template sits in |texture|, in pixels of a 1280 wide template. Returns
+  // the layer index, or -1 when all layers are taken.
+  int AddLayer(std::shared_ptr<SourceImage> texture, FrameBounds bounds);
+  void SetLayerLevel(int layer, float level);
+  // Landmarks of up to 4 faces, 111 x,y pairs each, one after another
+  void SetFaceLandmarks(const std::vector<float>& landmarks);
+  // Shares a detector result without copying it
+  void SetFaceLandmarks(std::shared_ptr<const FaceLandmarks> landmarks);
 
  protected:
   FaceMakeupFilter();
+  // Texture and bounds of the first layer
   void SetImageTexture(std::shared_ptr<SourceImage> texture);
-  void SetTextureBounds(FrameBounds bounds) { texture_bounds_ = bounds; }
+  void SetTextureBounds(FrameBounds bounds);
 
  private:
+  struct Layer {
+    std::shared_ptr<SourceImage> texture;
+    FrameBounds bounds;
+    float level = 0;  //[0. 0.5]
+    // Where the texture sits in the atlas, in pixels
+    int atlas_x = 0;
+    int atlas_y = 0;
+  };
+
   std::vector<uint32_t> GetFaceIndexs();
   std::vector<float> FaceTextureCoordinates();
+  // Uploads the template mesh for the most faces once
+  void InitFaceMesh();
+  // Packs the layer textures into one when the layers changed
+  void UpdateAtlas();
+  Layer& GetLayer(int layer);
 
  private:
-  std::vector<float> face_landmarks_;
-  float blend_level_ = 0;  //[0. 0.5]
-  bool has_face_ = false;
+  std::shared_ptr<const FaceLandmarks> face_landmarks_;
+  // Landmarks set through the vector property
+  std::shared_ptr<FaceLandmarksPool> landmarks_pool_;
+  float vertex_positions_[FaceLandmarks::kMaxFaces *
+                          FaceLandmarks::kPointCount * 2];
   //
   GPUPixelGLProgram* filter_program2_ = nullptr;
   uint32_t filter_position_attribute2_ = 0;
   uint32_t filter_tex_coord_attribute_ = 0;
   uint32_t filter_tex_coord_attribute2_ = 0;
 
-  FrameBounds texture_bounds_;
-  std::shared_ptr<SourceImage> image_texture_;
+  std::vector<Layer> layers_;
+  // Per layer the atlas transform, the atlas bounds and the level, as vec4s
+  std::vector<float> layer_uniforms_;
+  std::shared_ptr<GPUPixelFramebuffer> atlas_;
+  bool atlas_dirty_ = true;
+
+  // Template coordinates and indices of the face mesh repeated for every
+  // face, constant, and the landmark positions streamed each frame
+  uint32_t texture_coordinate_buffer_ = 0;
+  uint32_t index_buffer_ = 0;
+  uint32_t position_buffer_ = 0;
+  size_t face_index_count_ = 0;
 };
 
 }  // namespace gpupixel
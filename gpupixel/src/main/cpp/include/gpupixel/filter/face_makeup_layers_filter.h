@@ -0,0 +1,30 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/filter/face_makeup_filter.h"
+
+namespace gpupixel {
+// Blusher and lipstick drawn in one pass, instead of a LipstickFilter and a
+// BlusherFilter that each copy the whole frame
+class GPUPIXEL_API FaceMakeupLayersFilter : public FaceMakeupFilter {
+ public:
+  static std::shared_ptr<FaceMakeupLayersFilter> Create();
+
+  bool Init() override;
+
+  void SetLipstickLevel(float level);
+  void SetBlusherLevel(float level);
+
+ private:
+  FaceMakeupLayersFilter();
+
+  int lipstick_layer_ = -1;
+  int blusher_layer_ = -1;
+};
+
+}  // namespace gpupixel
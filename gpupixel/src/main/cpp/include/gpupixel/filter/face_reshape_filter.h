@@ -8,10 +8,19 @@
 #pragma once
 
 #include "gpupixel/filter/filter.h"
+#include "gpupixel/utils/face_landmarks.h"
 
 namespace gpupixel {
 class GPUPIXEL_API FaceReshapeFilter : public Filter {
  public:
+  enum WarpMode {
+    // Every pixel runs the warps in the fragment shader
+    PER_PIXEL = 0,
+    // The warps run on the CPU for the vertices of a grid, which is drawn
+    // as a deformed mesh with a plain texture lookup
+    MESH,
+  };
+
   static std::shared_ptr<FaceReshapeFilter> Create();
   FaceReshapeFilter();
   ~FaceReshapeFilter();
@@ -21,14 +30,46 @@ class GPUPIXEL_API FaceReshapeFilter : public Filter {
 
   void SetFaceSlimLevel(float level);
   void SetEyeZoomLevel(float level);
-  void SetFaceLandmarks(std::vector<float> landmarks);
+  void SetWarpMode(WarpMode mode);
+  // Grid cells along the longer side of the output in MESH mode
+  void SetMeshDensity(int cells);
+  // Landmarks of up to 4 faces, 111 x,y pairs each, one face after another
+  void SetFaceLandmarks(const std::vector<float>& landmarks);
+  // Shares a detector result without copying it
+  void SetFaceLandmarks(std::shared_ptr<const FaceLandmarks> landmarks);
 
  private:
+  // Rebuilds the grid when the output size, rotation or density changed
+  void UpdateMesh(int width, int height, RotationMode rotation);
+  // Warped texture coordinates of every grid vertex
+  void WarpMesh(int face_count, float aspect);
+  bool RenderMesh(int face_count, bool updateSinks);
+
   float thin_face_delta_ = 0.0;
   float big_eye_delta_ = 0.0;
 
-  std::vector<float> face_landmarks_;
-  int has_face_ = 0;
+  std::shared_ptr<const FaceLandmarks> face_landmarks_;
+  // Landmarks set through the vector property
+  std::shared_ptr<FaceLandmarksPool> landmarks_pool_;
+  // Landmark pairs each face is warped with, 4 floats per pair
+  float face_warps_[FaceLandmarks::kMaxFaces * 11 * 4];
+
+  WarpMode warp_mode_ = PER_PIXEL;
+  int mesh_density_ = 64;
+  GPUPixelGLProgram* mesh_program_ = nullptr;
+  uint32_t mesh_position_attribute_ = 0;
+  uint32_t mesh_tex_coord_attribute_ = 0;
+  // Grid the mesh was built for
+  int mesh_columns_ = 0;
+  int mesh_rows_ = 0;
+  int mesh_width_ = 0;
+  int mesh_height_ = 0;
+  RotationMode mesh_rotation_ = NoRotation;
+  std::vector<float> mesh_positions_;
+  // Unwarped texture coordinates, the input rotation already applied
+  std::vector<float> mesh_base_coordinates_;
+  std::vector<float> mesh_texture_coordinates_;
+  std::vector<uint16_t> mesh_indexs_;
 };
 
 }  // namespace gpupixel
@@ -55,13 +55,20 @@ class GPUPIXEL_API Filter : public Source, public Sink {
   static std::shared_ptr<Filter> CreateWithFragmentShaderString(
       const std::string& fragment_shader_source);
 
+  // With |output_number| > 1 the fragment shader writes OUTPUT0 to
+  // OUTPUT<n-1> instead of gl_FragColor. They are rendered in one pass to
+  // several color attachments where glDrawBuffers is available, otherwise in
+  // one pass per output. Outputs after the first get a target and are
+  // written only while a sink is connected to them.
   bool InitWithShaderString(const std::string& vertex_shader_source,
                             const std::string& fragment_shader_source,
-                            int input_number = 1);
+                            int input_number = 1,
+                            int output_number = 1);
 
   virtual bool InitWithFragmentShaderString(
       const std::string& fragment_shader_source,
-      int input_number = 1);
+      int input_number = 1,
+      int output_number = 1);
 
   void SetFilterClassName(const std::string filter_class_name) {
     filter_class_name_ = filter_class_name;
@@ -73,8 +80,41 @@ class GPUPIXEL_API Filter : public Source, public Sink {
 
   virtual bool DoRender(bool update_sinks = true) override;
 
+  virtual void DoUpdateSinks() override;
+
   GPUPixelGLProgram* GetGlProgram() const { return filter_program_; };
 
+  // Renders at this size instead of the input size times the framebuffer
+  // scale, 0 follows the input again
+  void SetOutputSize(int width, int height) {
+    output_width_ = width;
+    output_height_ = height;
+    GraphChanged();
+  }
+
+  // Pixel format of the output framebuffers. The float formats keep values
+  // outside [0, 1] and need GPUPixelContext::IsFloatRenderTargetAvailable(),
+  // their textures are sampled with nearest filtering.
+  enum OutputFormat { RGBA8 = 0, RGBA32F, RG32F };
+  void SetOutputFormat(OutputFormat format) { output_format_ = format; }
+  OutputFormat GetOutputFormat() const { return output_format_; }
+
+  int GetOutputCount() const { return output_count_; }
+  // Source of output |index|, connect sinks to it like to any other source.
+  // Output 0 is the filter itself, there is no separate source for it.
+  std::shared_ptr<Source> GetOutput(int index) const;
+
+  static const int kMaxOutputs = 4;
+  // Whether several outputs can be rendered in a single pass
+  static bool IsMultipleOutputsSupported();
+
+  // Describes everything besides the inputs that decides the output. Two
+  // filters with the same non-empty signature and the same inputs render the
+  // same image, so FilterGroup renders it once and hands it to both. Empty
+  // means the output is never shared. Setters of anything it covers call
+  // GraphChanged().
+  virtual std::string GetRenderSignature() const { return ""; }
+
   // property setters & getters
   bool RegisterProperty(const std::string& name,
                         int default_value,
@@ -108,7 +148,7 @@ class GPUPIXEL_API Filter : public Source, public Sink {
 
   bool GetProperty(const std::string& name, float& ret_value);
 
-  bool SetProperty(const std::string& name, std::vector<float> value);
+  bool SetProperty(const std::string& name, const std::vector<float>& value);
 
   bool GetProperty(const std::string& name, std::string& ret_value);
 
@@ -131,10 +171,26 @@ class GPUPIXEL_API Filter : public Source, public Sink {
     float a;
   } background_color_;
 
+  int output_width_;
+  int output_height_;
+  OutputFormat output_format_;
+  // Output 0 is framebuffer_, the others are held by their sources
+  int output_count_;
+  std::vector<std::shared_ptr<Source>> extra_outputs_;
+  // Renders all outputs at once, 0 when rendering one output per pass
+  uint32_t output_framebuffer_;
+  std::vector<uint32_t> output_textures_;
+  // The output rendered by the current pass without multiple render targets
+  int current_output_;
+
   Filter();
 
   std::string GetVertexShaderString(int input_number) const;
 
+  // Binds the target(s) of the current pass
+  void ActivateOutputs();
+  void DeactivateOutputs();
+
   const float* GetTextureCoordinate(const RotationMode& rotation_mode) const;
 
   // properties
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include "gpupixel/filter/filter.h"
 #include "gpupixel/gpupixel_define.h"
@@ -34,6 +35,7 @@ class GPUPIXEL_API FilterGroup : public Filter {
   // manually, as the terminal filter will be specified automatically.
   void SetTerminalFilter(std::shared_ptr<Filter> filter) {
     terminal_filter_ = filter;
+    GraphChanged();
   }
 
   virtual std::shared_ptr<Source> AddSink(std::shared_ptr<Sink> sink) override;
@@ -59,13 +61,41 @@ class GPUPIXEL_API FilterGroup : public Filter {
   virtual bool IsReady() const override;
   virtual void ResetAndClean() override;
 
+  // Non-empty when every member has a signature, see Filter
+  virtual std::string GetRenderSignature() const override;
+
  protected:
   std::vector<std::shared_ptr<Filter>> filters_;
   std::shared_ptr<Filter> terminal_filter_;
+  // Render signatures of filters_, kept until the graph version changes
+  std::vector<std::string> member_signatures_;
+  int signed_member_count_;
+  uint64_t member_signatures_version_;
+  mutable std::string render_signature_;
+  mutable uint64_t render_signature_version_;
 
   FilterGroup();
+  void UpdateMemberSignatures();
   static std::shared_ptr<Filter> PredictTerminalFilter(
       std::shared_ptr<Filter> filter);
+
+  // Signature of |filter| and everything it feeds up to the terminal filter
+  std::string GetChainSignature(const std::shared_ptr<Filter>& filter,
+                                int depth = 0) const;
+  // The filter whose framebuffer is the output of |filter|
+  static std::shared_ptr<Filter> GetOutputFilter(
+      const std::shared_ptr<Filter>& filter);
+  // Feeds the sinks of |duplicate| with the output |original| rendered
+  static void ShareOutput(const std::shared_ptr<Filter>& original,
+                          const std::shared_ptr<Filter>& duplicate);
+  static void ReleaseInputs(const std::shared_ptr<Filter>& filter);
+
+  // Swaps member |from| for |to|, the group's sinks move to the terminal
+  // filter that |to| leads to
+  void ReplaceFilter(const std::shared_ptr<Filter>& from,
+                     const std::shared_ptr<Filter>& to);
+  static void MoveSinks(const std::shared_ptr<Source>& from,
+                        const std::shared_ptr<Source>& to);
 };
 
 }  // namespace gpupixel
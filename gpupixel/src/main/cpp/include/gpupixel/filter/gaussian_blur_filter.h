@@ -9,11 +9,20 @@
 
 #include "gpupixel/filter/filter_group.h"
 #include "gpupixel/filter/gaussian_blur_mono_filter.h"
+#include "gpupixel/filter/pyramid_blur_filter.h"
 #include "gpupixel/gpupixel_define.h"
 
 namespace gpupixel {
 class GPUPIXEL_API GaussianBlurFilter : public FilterGroup {
  public:
+  enum Engine {
+    // Horizontal and vertical passes of 2 * radius + 1 taps
+    SEPARABLE = 0,
+    // Down and up sampling pyramid matching the same sigma, its cost hardly
+    // grows with the radius
+    PYRAMID,
+  };
+
   virtual ~GaussianBlurFilter();
 
   static std::shared_ptr<GaussianBlurFilter> Create(int radius = 4,
@@ -21,13 +30,21 @@ class GPUPIXEL_API GaussianBlurFilter : public FilterGroup {
   bool Init(int radius, float sigma);
   void SetRadius(int radius);
   void setSigma(float sigma);
+  void SetEngine(Engine engine);
+  Engine GetEngine() const { return engine_; }
 
  protected:
   GaussianBlurFilter();
 
  private:
+  // Standard deviation of the kernel the separable passes apply, which the
+  // radius may cut short
+  float GetKernelSigma() const;
+
   std::shared_ptr<GaussianBlurMonoFilter> horizontal_blur_filter_;
   std::shared_ptr<GaussianBlurMonoFilter> vertical_blur_filter_;
+  std::shared_ptr<PyramidBlurFilter> pyramid_blur_filter_;
+  Engine engine_;
 };
 
 }  // namespace gpupixel
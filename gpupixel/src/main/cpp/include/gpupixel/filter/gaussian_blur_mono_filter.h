@@ -22,9 +22,12 @@ class GPUPIXEL_API GaussianBlurMonoFilter : public Filter {
 
   void SetRadius(int radius);
   void setSigma(float sigma);
+  int GetRadius() const { return radius_; }
+  float GetSigma() const { return sigma_; }
 
   virtual bool DoRender(bool updateSinks = true) override;
   void SetTexelSpacingMultiplier(float value);
+  virtual std::string GetRenderSignature() const override;
 
  protected:
   GaussianBlurMonoFilter(Type type = HORIZONTAL);
@@ -0,0 +1,53 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/filter/filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// One pass of the fused Canny front end. A Gaussian blur followed by a Sobel
+// operator is the same as two separable kernels per gradient, so the
+// luminance, blur and Sobel steps take two passes:
+// - HORIZONTAL converts to luminance and renders the horizontal derivative
+//   and the horizontal [1 2 1] smoothing of the blurred luminance in rg of
+//   a float target
+// - VERTICAL applies the vertical halves and writes the gradient magnitude
+//   and direction like DirectionalSobelEdgeDetectionFilter
+class GPUPIXEL_API GaussianSobelPassFilter : public Filter {
+ public:
+  enum Direction { HORIZONTAL, VERTICAL };
+  // Taps are passed as uniforms, larger blurs are cut to this radius
+  static constexpr int kMaxRadius = 8;
+
+  // |gradient_output| adds the signed gradients as a second output to the
+  // VERTICAL pass, like DirectionalSobelEdgeDetectionFilter::Create(true).
+  // It is only rendered while a sink is connected to it.
+  static std::shared_ptr<GaussianSobelPassFilter> Create(
+      Direction direction,
+      bool gradient_output = false);
+  ~GaussianSobelPassFilter();
+  bool Init(bool gradient_output);
+
+  virtual bool DoRender(bool updateSinks = true) override;
+
+  void SetRadius(int radius);
+  void SetSigma(float sigma);
+
+ protected:
+  GaussianSobelPassFilter(Direction direction);
+  // Combined kernels for the current radius and sigma
+  void UpdateTaps();
+
+  Direction direction_;
+  int radius_;
+  float sigma_;
+  // Per tap the offset in pixels, the derivative and the smoothing weight
+  std::vector<float> taps_;
+};
+
+}  // namespace gpupixel
@@ -0,0 +1,84 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/filter/filter_group.h"
+#include "gpupixel/filter/summed_area_box_filter.h"
+#include "gpupixel/filter/summed_area_table_filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// Last pass of GuidedFilter. Interpolates the mean coefficients of input 1,
+// which may be smaller, and applies them to the image of input 0.
+// Output 0 is mean_a * p + mean_b for each channel p of the image, output 1
+// the squared difference to the image scaled by delta, like
+// BoxHighPassMonoFilter.
+class GPUPIXEL_API GuidedFilterOutputFilter : public Filter {
+ public:
+  static std::shared_ptr<GuidedFilterOutputFilter> Create();
+  ~GuidedFilterOutputFilter();
+  bool Init();
+
+  virtual bool DoRender(bool updateSinks = true) override;
+
+  void SetDelta(float delta) { delta_ = delta; }
+
+ protected:
+  GuidedFilterOutputFilter();
+
+  float delta_;
+};
+
+// Edge-preserving smoothing after the self-guided filter of He et al., with
+// one a shared by the color channels. The exact filter with each channel p
+// as its own guide takes a = var(p) / (var(p) + epsilon) per channel. Here
+// a = var(Y) / (var(Y) + epsilon) of the luminance Y is used for all of them
+// and b = (1 - a) * mean(p) per channel, the output is mean(a) * p + mean(b).
+// Sharing a keeps colors from shifting and fits the coefficients in one
+// RGBA32F target. It is not a filter guided by luminance, which would need
+// the covariance of Y with each channel.
+// Box means come from summed-area tables, the cost does not depend on the
+// radius. The coefficients are computed at 1 / |downsampling| of the size
+// and interpolated, as the fast guided filter does.
+// Needs float render targets, Create() returns null without them.
+class GPUPIXEL_API GuidedFilter : public FilterGroup {
+ public:
+  virtual ~GuidedFilter();
+
+  static std::shared_ptr<GuidedFilter> Create(int radius = 16,
+                                              float epsilon = 0.01);
+  bool Init(int radius, float epsilon);
+
+  // Half the box width in input pixels
+  void SetRadius(int radius);
+  // Variance at which a box is half smoothed, larger smooths more
+  void SetEpsilon(float epsilon);
+  void SetDownsampling(float downsampling);
+
+  // Scale of the high pass output
+  void SetDelta(float delta);
+  // What the smoothing removed, squared and scaled by delta. Small at edges
+  // the guided filter keeps.
+  std::shared_ptr<Source> GetHighPassOutput() const;
+
+ protected:
+  GuidedFilter();
+
+  void UpdateRadius();
+
+  std::shared_ptr<Filter> downsample_filter_;
+  std::shared_ptr<SummedAreaTableFilter> image_table_filter_;
+  std::shared_ptr<SummedAreaBoxFilter> coefficient_filter_;
+  std::shared_ptr<SummedAreaTableFilter> coefficient_table_filter_;
+  std::shared_ptr<SummedAreaBoxFilter> coefficient_mean_filter_;
+  std::shared_ptr<GuidedFilterOutputFilter> output_filter_;
+
+  int radius_;
+  float downsampling_;
+};
+
+}  // namespace gpupixel
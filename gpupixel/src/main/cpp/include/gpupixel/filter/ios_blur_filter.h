@@ -25,6 +25,8 @@ class GPUPIXEL_API IOSBlurFilter : public FilterGroup {
   void setSaturation(float saturation);
   void setRangeReductionFactor(float range_reduction_factor);
   void setDownSampling(float down_sampling);
+  // GaussianBlurFilter::Engine
+  void setBlurEngine(int blur_engine);
 
  protected:
   IOSBlurFilter();
@@ -36,6 +38,7 @@ class GPUPIXEL_API IOSBlurFilter : public FilterGroup {
   float saturation_;
   float range_reduction_factor_;
   float down_sampling_;
+  int blur_engine_;
 };
 
 }  // namespace gpupixel
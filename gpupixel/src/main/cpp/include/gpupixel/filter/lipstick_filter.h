@@ -13,6 +13,9 @@ namespace gpupixel {
 class GPUPIXEL_API LipstickFilter : public FaceMakeupFilter {
  public:
   static std::shared_ptr<LipstickFilter> Create();
+  // The layer, for drawing it with others in one FaceMakeupFilter
+  static std::shared_ptr<SourceImage> CreateTexture();
+  static FrameBounds GetTextureBounds();
 
   bool Init() override;
 
@@ -0,0 +1,36 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/filter/filter_group.h"
+#include "gpupixel/filter/summed_area_box_filter.h"
+#include "gpupixel/filter/summed_area_table_filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// Mean and spread of the luminance around each pixel, for telling smooth skin
+// from texture and edges. Outputs the box mean in r and 2 * the standard
+// deviation in g, the cost does not depend on the radius.
+// Needs float render targets, Create() returns null without them.
+class GPUPIXEL_API LocalVarianceFilter : public FilterGroup {
+ public:
+  virtual ~LocalVarianceFilter();
+
+  static std::shared_ptr<LocalVarianceFilter> Create(int radius = 8);
+  bool Init(int radius);
+
+  // Half the box width in pixels
+  void SetRadius(int radius);
+
+ protected:
+  LocalVarianceFilter();
+
+  std::shared_ptr<SummedAreaTableFilter> summed_area_table_filter_;
+  std::shared_ptr<SummedAreaBoxFilter> variance_filter_;
+};
+
+}  // namespace gpupixel
@@ -18,7 +18,8 @@ class GPUPIXEL_API NearbySampling3x3Filter : public Filter {
  public:
   virtual bool InitWithFragmentShaderString(
       const std::string& fragmentShaderSource,
-      int inputNumber = 1) override;
+      int inputNumber = 1,
+      int outputNumber = 1) override;
   virtual bool DoRender(bool updateSinks = true) override;
 
   void setTexelSizeMultiplier(float texel_size_multiplier);
@@ -0,0 +1,55 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include <vector>
+#include "gpupixel/filter/filter_group.h"
+#include "gpupixel/filter/pyramid_blur_pass_filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// Gaussian-like blur built from a pyramid of half resolution down passes and
+// matching up passes (dual Kawase). Every level halves the work of the one
+// above, so a blur costs about as much as two full resolution passes and the
+// number of levels grows with log(sigma) instead of the taps with sigma.
+class GPUPIXEL_API PyramidBlurFilter : public FilterGroup {
+ public:
+  static const int kMaxLevels = 7;
+
+  virtual ~PyramidBlurFilter();
+
+  static std::shared_ptr<PyramidBlurFilter> Create(float sigma = 2.0);
+  bool Init(float sigma);
+  // Standard deviation of the Gaussian to approximate, in input pixels
+  void SetSigma(float sigma);
+  float GetSigma() const { return sigma_; }
+  int GetLevelCount() const { return level_count_; }
+
+  virtual void SetInputFramebuffer(
+      std::shared_ptr<GPUPixelFramebuffer> framebuffer,
+      RotationMode rotation_mode = NoRotation,
+      int texIdx = 0) override;
+
+ protected:
+  PyramidBlurFilter();
+
+  // Picks the levels and tap offset for |sigma_| at the input size and wires
+  // the passes of that many levels
+  void UpdateLevels();
+
+  // down_filters_[i] renders level i + 1, up_filters_[i] renders level i
+  std::vector<std::shared_ptr<PyramidBlurPassFilter>> down_filters_;
+  std::vector<std::shared_ptr<PyramidBlurPassFilter>> up_filters_;
+
+  float sigma_;
+  int level_count_;
+  int input_width_;
+  int input_height_;
+  bool levels_dirty_;
+};
+
+}  // namespace gpupixel
@@ -0,0 +1,39 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/filter/filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// One level of the dual filter blur used by PyramidBlurFilter. DOWN halves
+// the resolution with 5 taps, UP doubles it with 8 taps. |offset| spreads the
+// taps in texels of the input.
+class GPUPIXEL_API PyramidBlurPassFilter : public Filter {
+ public:
+  enum Type { DOWN, UP };
+
+  static std::shared_ptr<PyramidBlurPassFilter> Create(Type type = DOWN);
+  ~PyramidBlurPassFilter();
+  bool Init();
+
+  virtual bool DoRender(bool updateSinks = true) override;
+  virtual std::string GetRenderSignature() const override;
+
+  void SetOffset(float offset) {
+    offset_ = offset;
+    GraphChanged();
+  }
+
+ protected:
+  PyramidBlurPassFilter(Type type);
+
+  Type type_;
+  float offset_;
+};
+
+}  // namespace gpupixel
@@ -23,6 +23,8 @@ class GPUPIXEL_API SmoothToonFilter : public FilterGroup {
   void setBlurRadius(int blur_radius);
   void setToonThreshold(float toon_threshold);
   void setToonQuantizationLevels(float toon_quantization_levels);
+  // GaussianBlurFilter::Engine
+  void setBlurEngine(int blur_engine);
 
  protected:
   SmoothToonFilter();
@@ -34,6 +36,7 @@ class GPUPIXEL_API SmoothToonFilter : public FilterGroup {
   float blur_radius_;
   float toon_threshold_;
   float toon_quantization_levels_;
+  int blur_engine_;
 };
 
 }  // namespace gpupixel
@@ -0,0 +1,64 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/filter/filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// Box statistics read from the summed-area table rendered by
+// SummedAreaTableFilter, with 4 reads per pixel whatever the radius. The box
+// is cut at the frame edges and only averages the pixels inside.
+class GPUPIXEL_API SummedAreaBoxFilter : public Filter {
+ public:
+  enum Mode {
+    // Box mean of a COLOR table
+    MEAN,
+    // Input 1 is the unfiltered image. Output 0 is its squared difference to
+    // the mean scaled by delta, output 1 the mean, like
+    // BoxHighPassMonoFilter.
+    HIGH_PASS,
+    // Of a LUMINANCE_MOMENTS table: the mean luminance in r and the standard
+    // deviation times 2 in g, so 8 bits still resolve fine texture
+    VARIANCE,
+    // Of a COLOR_AND_LUMINANCE_SQUARE table: the shared-a guided filter
+    // coefficients of GuidedFilter, a = variance / (variance + epsilon) of
+    // the luminance in r and b = (1 - a) * mean of each channel in gba, into
+    // an RGBA32F target
+    GUIDED_COEFFICIENTS,
+  };
+
+  static std::shared_ptr<SummedAreaBoxFilter> Create(Mode mode = MEAN,
+                                                     int radius = 4);
+  ~SummedAreaBoxFilter();
+  bool Init(int radius);
+
+  virtual bool DoRender(bool updateSinks = true) override;
+  virtual std::string GetRenderSignature() const override;
+
+  // Half the box width in pixels, not counting the center
+  void SetRadius(int radius) {
+    radius_ = radius;
+    GraphChanged();
+  }
+  int GetRadius() const { return radius_; }
+  void SetDelta(float delta) { delta_ = delta; }
+  void SetEpsilon(float epsilon) {
+    epsilon_ = epsilon;
+    GraphChanged();
+  }
+
+ protected:
+  SummedAreaBoxFilter(Mode mode);
+
+  Mode mode_;
+  int radius_;
+  float delta_;
+  float epsilon_;
+};
+
+}  // namespace gpupixel
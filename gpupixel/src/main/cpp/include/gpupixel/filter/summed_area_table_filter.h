@@ -0,0 +1,72 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include <vector>
+#include "gpupixel/filter/filter_group.h"
+#include "gpupixel/filter/summed_area_table_pass_filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// Renders the summed-area table of its input into a float target: every
+// pixel holds the sum of all pixels at or before it in both directions, so
+// the sum over any rectangle takes 4 reads (see SummedAreaBoxFilter).
+// Built with recursive doubling passes that add 3 texels each, which takes
+// log4(width) + log4(height) passes.
+//
+// Needs GPUPixelContext::IsFloatRenderTargetAvailable(). The values are
+// shifted by -0.5 before summing to keep the float sums small, the absolute
+// error still grows with the frame area.
+class GPUPIXEL_API SummedAreaTableFilter : public FilterGroup {
+ public:
+  enum Content {
+    // rgba - 0.5 in an RGBA32F target
+    COLOR,
+    // luminance - 0.5 and its square in an RG32F target, for local variance
+    LUMINANCE_MOMENTS,
+    // rgb - 0.5 and the square of luminance - 0.5 in an RGBA32F target, for
+    // the guided filter
+    COLOR_AND_LUMINANCE_SQUARE,
+  };
+
+  virtual ~SummedAreaTableFilter();
+
+  static std::shared_ptr<SummedAreaTableFilter> Create(Content content = COLOR);
+  bool Init(Content content);
+  static bool IsSupported();
+
+  Content GetContent() const { return content_; }
+
+  virtual void SetInputFramebuffer(
+      std::shared_ptr<GPUPixelFramebuffer> framebuffer,
+      RotationMode rotation_mode = NoRotation,
+      int texIdx = 0) override;
+
+ protected:
+  SummedAreaTableFilter();
+
+  // A pass rendering into the float format of the table content
+  std::shared_ptr<SummedAreaTablePassFilter> CreatePass(
+      SummedAreaTablePassFilter::Direction direction,
+      int step,
+      SummedAreaTablePassFilter::Transform transform =
+          SummedAreaTablePassFilter::NONE);
+  // Creates and chains as many passes as the input size needs
+  void UpdatePasses(int width, int height);
+
+  // Passes with a step of 4^i, the first horizontal one transforms the input
+  // and the first vertical one is the terminal filter. Passes commute, so
+  // the longer steps are chained in between.
+  std::vector<std::shared_ptr<SummedAreaTablePassFilter>> horizontal_filters_;
+  std::vector<std::shared_ptr<SummedAreaTablePassFilter>> vertical_filters_;
+
+  Content content_;
+  int horizontal_pass_count_;
+  int vertical_pass_count_;
+};
+
+}  // namespace gpupixel
@@ -0,0 +1,48 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include "gpupixel/filter/filter.h"
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+// One recursive doubling pass of SummedAreaTableFilter. Adds the texels 1, 2
+// and 3 steps before each pixel along |direction| to it, texels before the
+// edge count as 0. Renders a float target.
+class GPUPIXEL_API SummedAreaTablePassFilter : public Filter {
+ public:
+  enum Direction { HORIZONTAL, VERTICAL };
+  // Applied to every texel read, so the first pass can prepare the input
+  enum Transform {
+    NONE,
+    // rgba - 0.5, keeps the sums small for float precision
+    CENTER,
+    // luminance - 0.5 and its square in rg
+    MOMENTS,
+    // rgb - 0.5 and the square of luminance - 0.5 in a
+    CENTER_AND_SQUARE,
+  };
+
+  static std::shared_ptr<SummedAreaTablePassFilter> Create(
+      Direction direction,
+      Transform transform = NONE);
+  ~SummedAreaTablePassFilter();
+  bool Init();
+
+  virtual bool DoRender(bool updateSinks = true) override;
+
+  void SetStep(int step) { step_ = step; }
+
+ protected:
+  SummedAreaTablePassFilter(Direction direction, Transform transform);
+
+  Direction direction_;
+  Transform transform_;
+  int step_;
+};
+
+}  // namespace gpupixel
@@ -9,6 +9,8 @@
 // core
 #include "gpupixel/gpupixel_define.h"
 // utils
+#include "gpupixel/utils/face_landmarks.h"
+#include "gpupixel/utils/frame_pool.h"
 #include "gpupixel/utils/math_toolbox.h"
 
 // source
@@ -34,6 +36,7 @@
 #include "gpupixel/filter/beauty_face_filter.h"
 #include "gpupixel/filter/blusher_filter.h"
 #include "gpupixel/filter/face_makeup_filter.h"
+#include "gpupixel/filter/face_makeup_layers_filter.h"
 #include "gpupixel/filter/face_reshape_filter.h"
 #include "gpupixel/filter/lipstick_filter.h"
 
@@ -54,17 +57,21 @@
 #include "gpupixel/filter/exposure_filter.h"
 #include "gpupixel/filter/gaussian_blur_filter.h"
 #include "gpupixel/filter/gaussian_blur_mono_filter.h"
+#include "gpupixel/filter/gaussian_sobel_pass_filter.h"
 #include "gpupixel/filter/glass_sphere_filter.h"
 #include "gpupixel/filter/grayscale_filter.h"
+#include "gpupixel/filter/guided_filter.h"
 #include "gpupixel/filter/halftone_filter.h"
 #include "gpupixel/filter/hsb_filter.h"
 #include "gpupixel/filter/hue_filter.h"
 #include "gpupixel/filter/ios_blur_filter.h"
+#include "gpupixel/filter/local_variance_filter.h"
 #include "gpupixel/filter/luminance_range_filter.h"
 #include "gpupixel/filter/nearby_sampling3x3_filter.h"
 #include "gpupixel/filter/non_maximum_suppression_filter.h"
 #include "gpupixel/filter/pixellation_filter.h"
 #include "gpupixel/filter/posterize_filter.h"
+#include "gpupixel/filter/pyramid_blur_filter.h"
 #include "gpupixel/filter/rgb_filter.h"
 #include "gpupixel/filter/saturation_filter.h"
 #include "gpupixel/filter/single_component_gaussian_blur_filter.h"
@@ -73,6 +80,7 @@
 #include "gpupixel/filter/smooth_toon_filter.h"
 #include "gpupixel/filter/sobel_edge_detection_filter.h"
 #include "gpupixel/filter/sphere_refraction_filter.h"
+#include "gpupixel/filter/summed_area_table_filter.h"
 #include "gpupixel/filter/toon_filter.h"
 #include "gpupixel/filter/weak_pixel_inclusion_filter.h"
 #include "gpupixel/filter/white_balance_filter.h"
@@ -89,6 +97,18 @@ class GPUPIXEL_API GPUPixel {
    * @param root Root directory path
    */
   static void SetResourcePath(const std::string& path);
+
+  // Core selection for SetCpuThreads
+  enum CpuAffinity { ANY_CORES = 0, BIG_CORES, LITTLE_CORES };
+
+  /**
+   * Configure the worker pool used for CPU pixel work (YUV conversion,
+   * rotation, CPU-side copies)
+   * @param thread_count Threads including the caller, 0 picks min(cores, 4)
+   * @param affinity Cluster the workers are pinned to
+   */
+  static void SetCpuThreads(int thread_count,
+                            CpuAffinity affinity = ANY_CORES);
 };
 
 }  // namespace gpupixel
@@ -77,6 +77,9 @@ typedef enum GPUPIXEL_API {
   GPUPIXEL_FRAME_TYPE_YUVI420,
   GPUPIXEL_FRAME_TYPE_RGBA,
   GPUPIXEL_FRAME_TYPE_BGRA,
+  GPUPIXEL_FRAME_TYPE_NV12,
+  GPUPIXEL_FRAME_TYPE_NV21,
+  GPUPIXEL_FRAME_TYPE_GRAY,
 } GPUPIXEL_FRAME_TYPE;
 
 typedef enum GPUPIXEL_API {
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <map>
+#include <string>
 #include "gpupixel/gpupixel_define.h"
 namespace gpupixel {
 enum GPUPIXEL_API RotationMode {
@@ -38,6 +39,9 @@ class GPUPIXEL_API Sink {
   virtual void ResetAndClean();
   virtual void Render() {};
   virtual int NextAvailableTextureIndex() const;
+  // Identifies the current inputs, equal strings mean the same framebuffers
+  // bound with the same rotations at the same indices
+  std::string GetInputSignature() const;
   // virtual void SetInputSizeWithIdx(int width, int height, int texture_idx)
   // {};
  protected:
@@ -13,8 +13,10 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "gpupixel/sink/sink.h"
+#include "gpupixel/utils/frame_pool.h"
 
 #if defined(GPUPIXEL_IOS) || defined(GPUPIXEL_MAC)
 #import <AVFoundation/AVFoundation.h>
@@ -25,17 +27,104 @@ namespace gpupixel {
 class GPUPixelGLProgram;
 class GPUPIXEL_API SinkRawData : public Sink {
  public:
+  // Layout of the buffer returned by GetYuvBuffer()
+  enum YuvFormat { I420 = 0, NV12, NV21 };
+  // Conversion matrix and output range used for YUV readback
+  enum YuvMatrix { BT601 = 0, BT709 };
+  enum YuvRange { LIMITED_RANGE = 0, FULL_RANGE };
+
   static std::shared_ptr<SinkRawData> Create();
   virtual ~SinkRawData();
   void Render() override;
 
   const uint8_t* GetRgbaBuffer();
   const uint8_t* GetI420Buffer();
+
+  // Converts the frame to YUV on the GPU and reads back only the packed
+  // planes (width * height * 3 / 2 bytes). Falls back to libyuv when the
+  // width is not a multiple of 8 or the height not a multiple of 4.
+  const uint8_t* GetYuvBuffer();
+  void SetYuvFormat(YuvFormat format,
+                    YuvMatrix matrix = BT601,
+                    YuvRange range = LIMITED_RANGE);
+
+  // Read the current frame straight into caller-owned memory, without going
+  // through the internal output buffers. |dst_stride| is the row pitch in
+  // bytes, 0 for tightly packed rows. Return false when nothing has been
+  // rendered yet or |dst_size| bytes cannot hold the frame at that stride.
+  bool ReadRgbaInto(uint8_t* dst, size_t dst_size, int dst_stride = 0);
+  // Writes the layout chosen by SetYuvFormat. Luma rows use |y_stride|,
+  // I420 chroma planes half of it and NV12/NV21 chroma rows all of it.
+  bool ReadYuvInto(uint8_t* dst, size_t dst_size, int y_stride = 0);
+  // Output geometry and format, applied in the sink's own render pass so
+  // several sinks on one graph can each read back a different size without
+  // rendering the graph again. |width|/|height| of 0 keep the cropped input
+  // size. The crop rectangle is normalized to the input frame.
+  void SetOutputSize(int width, int height);
+  void SetCropRect(float x, float y, float width, float height);
+  // GPUPIXEL_FRAME_TYPE_RGBA (default) or GPUPIXEL_FRAME_TYPE_BGRA. Affects
+  // GetRgbaBuffer, ReadRgbaInto and the async callback.
+  void SetOutputFormat(GPUPIXEL_FRAME_TYPE format);
+
   int GetWidth() const { return width_; }
   int GetHeight() const { return height_; }
 
+  // Read the current frame into a buffer leased from the sink's frame pool.
+  // The frame stays valid until every holder drops it, independently of
+  // later renders. Returns nullptr when nothing has been rendered yet or all
+  // pool buffers are still held.
+  std::shared_ptr<VideoFrame> AcquireRgbaFrame();
+  // In the layout chosen by SetYuvFormat
+  std::shared_ptr<VideoFrame> AcquireYuvFrame();
+  // Maximum number of frames leased at once, 3 by default
+  void SetFramePoolDepth(int depth);
+
+  // Called on the GL thread with a completed RGBA readback. |rgba| is only
+  // valid for the duration of the call.
+  using RgbaFrameCallback = std::function<
+      void(const uint8_t* rgba, int width, int height, int64_t timestamp)>;
+
+  // Reads every rendered frame back through a ring of |ring_size| pixel pack
+  // buffers instead of stalling in GetRgbaBuffer(). A buffer is mapped only
+  // once its fence has signalled, so frames reach |callback| a few frames
+  // late, tagged with their source timestamp. Without ES 3.0 / GL 3.0 frames
+  // are read back synchronously and delivered immediately.
+  void EnableAsyncReadback(RgbaFrameCallback callback, int ring_size = 3);
+  void DisableAsyncReadback();
+
+  // Delivers readbacks that have completed, without waiting
+  void PollAsyncReadback();
+
+  // Blocks until every pending readback has been delivered
+  void FlushAsyncReadback();
+
  private:
+  struct PendingReadback {
+    uint32_t buffer = 0;
+    size_t size = 0;
+    void* fence = nullptr;
+    int width = 0;
+    int height = 0;
+    int64_t timestamp = 0;
+  };
+
   int RenderToOutput();
+  int RenderToOutput(uint8_t* dst, int dst_stride);
+  int RenderToYuvOutput(YuvFormat format, uint8_t* dst, int y_stride);
+  void ReadPixels(int x,
+                  int y,
+                  int width,
+                  int height,
+                  uint8_t* dst,
+                  int dst_stride);
+  void IssueAsyncReadback(int64_t timestamp);
+  // Delivers readbacks in order until one is still in flight, or with
+  // |wait| until the ring is empty
+  void DeliverAsyncReadbacks(bool wait);
+  // Delivers the oldest readback only, false if none is pending or, without
+  // |wait|, it is still in flight
+  bool DeliverOldestReadback(bool wait);
+  void ReleaseAsyncReadback();
   bool InitWithShaderString(const std::string& vertex_shader_source,
                             const std::string& fragment_shader_source);
   void InitTextureCache(int width, int height);
@@ -51,6 +140,26 @@ class GPUPIXEL_API SinkRawData : public Sink {
 
   std::shared_ptr<GPUPixelFramebuffer> framebuffer_;
 
+  // Packs Y/U/V bytes four per RGBA texel into a (width / 4) x
+  // (height * 3 / 2) target
+  GPUPixelGLProgram* yuv_program_ = nullptr;
+  uint32_t yuv_position_attribute_ = 0;
+  std::shared_ptr<GPUPixelFramebuffer> yuv_framebuffer_;
+  // Output geometry, see SetOutputSize/SetCropRect
+  int output_width_ = 0;
+  int output_height_ = 0;
+  struct {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+  } crop_rect_;
+  GPUPIXEL_FRAME_TYPE output_format_ = GPUPIXEL_FRAME_TYPE_RGBA;
+
+  YuvFormat yuv_format_ = I420;
+  YuvMatrix yuv_matrix_ = BT601;
+  YuvRange yuv_range_ = LIMITED_RANGE;
+
   bool is_initialized_ = false;
 
   // Image dimensions
@@ -60,6 +169,16 @@ class GPUPIXEL_API SinkRawData : public Sink {
   // Frame buffers for pixel data
   uint8_t* rgba_buffer_ = nullptr;  // RGBA buffer
   uint8_t* yuv_buffer_ = nullptr;   // YUV buffer
+
+  // Leased output frames and the timestamp of the frame last rendered
+  std::shared_ptr<FramePool> frame_pool_;
+  int64_t frame_timestamp_ = 0;
+
+  // Asynchronous readback ring, touched only on the GL thread
+  RgbaFrameCallback async_callback_;
+  std::vector<PendingReadback> readback_ring_;
+  int readback_head_ = 0;
+  int readback_count_ = 0;
 };
 
 }  // namespace gpupixel
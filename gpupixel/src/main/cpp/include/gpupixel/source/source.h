@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include "gpupixel/gpupixel_define.h"
@@ -29,10 +30,12 @@ class GPUPIXEL_API Source {
       std::shared_ptr<GPUPixelFramebuffer> fb,
       RotationMode outputRotation = RotationMode::NoRotation);
   virtual std::shared_ptr<GPUPixelFramebuffer> GetFramebuffer() const;
+  RotationMode GetOutputRotation() const { return output_rotation_; }
   virtual void ReleaseFramebuffer(bool returnToCache = true);
 
   void SetFramebufferScale(float framebufferScale) {
     framebuffer_scale_ = framebufferScale;
+    GraphChanged();
   }
   int GetRotatedFramebufferWidth() const;
   int GetRotatedFramebufferHeight() const;
@@ -40,7 +43,13 @@ class GPUPIXEL_API Source {
   virtual bool DoRender(bool updateSinks = true);
   virtual void DoUpdateSinks();
 
+  // Changes whenever sinks are connected anywhere or a setter changes what a
+  // filter renders, so results derived from the graph can be kept until then
+  static uint64_t GetGraphVersion();
+
  protected:
+  static void GraphChanged();
+
   std::shared_ptr<GPUPixelFramebuffer> framebuffer_;
   RotationMode output_rotation_;
   std::map<std::shared_ptr<Sink>, int> sinks_;
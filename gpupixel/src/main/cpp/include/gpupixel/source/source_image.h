@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -22,8 +23,17 @@ class GPUPIXEL_API SourceImage : public Source {
       int channel_count,
       const unsigned char* pixels);
 
+  // Decodes and uploads |path| once per process: while any returned image
+  // is alive, calls for the same file content share its texture.
+  static std::shared_ptr<SourceImage> CreateShared(const std::string& path);
+  // Directory CreateShared keeps decoded RGBA files in, so later runs skip
+  // the PNG decode. Empty, the default, turns the files off.
+  static void SetDecodedCacheDirectory(const std::string& directory);
+
   ~SourceImage() {};
 
+  // Pixels as uploaded. Unless Init was asked to keep them, they are read
+  // back from the texture on the first call and kept from then on.
   const unsigned char* GetRgbaImageBuffer() const;
   int GetWidth() const;
   int GetHeight() const;
@@ -33,15 +43,19 @@ class GPUPIXEL_API SourceImage : public Source {
   void Init(int width,
             int height,
             int channel_count,
-            const unsigned char* pixels);
+            const unsigned char* pixels,
+            bool keep_cpu_copy = false);
 
 #if defined(GPUPIXEL_ANDROID)
   static std::shared_ptr<SourceImage> CreateImageForAndroid(std::string name);
 #endif
-  std::vector<unsigned char> image_bytes_;
 
  private:
   SourceImage() {}
+
+  // CPU copy of the texture, filled on demand
+  mutable std::vector<unsigned char> image_bytes_;
+  mutable std::mutex image_bytes_mutex_;
 };
 
 }  // namespace gpupixel
@@ -8,6 +8,7 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
 
 #include "gpupixel/filter/filter.h"
 #include "gpupixel/source/source.h"
@@ -20,18 +21,56 @@ class GPUPIXEL_API SourceRawData : public Filter {
 
   ~SourceRawData() override;
 
+  // |type| is one of GPUPIXEL_FRAME_TYPE_RGBA, GPUPIXEL_FRAME_TYPE_BGRA
+  // (Apple platforms only) or GPUPIXEL_FRAME_TYPE_YUVI420. Other types are
+  // logged as errors and the frame is dropped.
   void ProcessData(const uint8_t* data,
                    int width,
                    int height,
                    int stride,
                    GPUPIXEL_FRAME_TYPE type);
 
+  // Uploads a frame and orients it within the same draw. |rotation| is the
+  // clockwise angle in degrees (0, 90, 180, 270) and |mirror| flips the
+  // rotated result horizontally. For 90/270 the output is height x width.
+  // |timestamp| tags the frame for downstream sinks; a negative value stamps
+  // it with the upload time in microseconds of a monotonic clock.
+  void ProcessData(const uint8_t* data,
+                   int width,
+                   int height,
+                   int stride,
+                   GPUPIXEL_FRAME_TYPE type,
+                   int rotation,
+                   bool mirror,
+                   int64_t timestamp = -1);
+
   void SetRotation(RotationMode rotation);
 
+  static RotationMode RotationModeFromDegrees(int rotation, bool mirror);
+
   bool Init();
 
+  // CPU time spent handing frame pixels to GL, measured per ProcessData call
+  struct UploadStats {
+    int64_t frame_count = 0;
+    int64_t last_upload_us = 0;
+    int64_t average_upload_us = 0;
+    bool pixel_buffer_enabled = false;
+  };
+  UploadStats GetUploadStats();
+
  private:
   SourceRawData();
+  void ProcessData(const uint8_t* data,
+                   int width,
+                   int height,
+                   int stride,
+                   GPUPIXEL_FRAME_TYPE type,
+                   RotationMode rotation,
+                   int64_t timestamp);
+
+  void PrepareFramebuffer(int width, int height, RotationMode rotation);
+
   int GenerateTextureWithI420(int width,
                               int height,
                               const uint8_t* dataY,
@@ -39,13 +78,28 @@ class GPUPIXEL_API SourceRawData : public Filter {
                               const uint8_t* dataU,
                               int strideU,
                               const uint8_t* dataV,
-                              int strideV);
+                              int strideV,
+                              RotationMode rotation);
 
   int GenerateTextureWithPixels(const uint8_t* pixels,
                                 int width,
                                 int height,
                                 int stride,
-                                GPUPIXEL_FRAME_TYPE type);
+                                GPUPIXEL_FRAME_TYPE type,
+                                RotationMode rotation);
+
+  void EnsureTextureStorage(int index,
+                            int width,
+                            int height,
+                            uint32_t format);
+  // Copies the planes into the next unpack buffer of the ring and rewrites
+  // |planes| as offsets into it. Returns false if pixel buffers are not
+  // available, leaving |planes| pointing at client memory.
+  bool BeginStagedUpload(const uint8_t** planes,
+                         const size_t* sizes,
+                         int count);
+  void EndStagedUpload();
+  void RecordUploadTime(int64_t upload_us, bool staged);
 
  private:
   GPUPixelGLProgram* filter_program_;
@@ -53,7 +107,19 @@ class GPUPIXEL_API SourceRawData : public Filter {
   uint32_t filter_tex_coord_attribute_;
 
   uint32_t textures_[4] = {0};
+  int texture_widths_[4] = {0};
+  int texture_heights_[4] = {0};
+
+  static const int kPixelUnpackBufferCount = 3;
+  uint32_t pixel_unpack_buffers_[kPixelUnpackBufferCount] = {0};
+  size_t pixel_unpack_buffer_sizes_[kPixelUnpackBufferCount] = {0};
+  int pixel_unpack_buffer_index_ = 0;
+
+  std::mutex stats_mutex_;
+  UploadStats upload_stats_;
+  int64_t total_upload_us_ = 0;
   RotationMode rotation_ = NoRotation;
+  int64_t frame_timestamp_ = 0;
   std::shared_ptr<GPUPixelFramebuffer> framebuffer_;
 };
 
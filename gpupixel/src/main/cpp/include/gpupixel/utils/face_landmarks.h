@@ -0,0 +1,71 @@
+/*
+ * GPUPixel
+ *
+ * Created by PixPark on 2021/6/24.
+ * Copyright © 2021 PixPark. All rights reserved.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+
+// Landmarks of every face in one frame, in fixed storage so a result can be
+// filled once, published as std::shared_ptr<const FaceLandmarks> and read by
+// the detector's consumers and the face filters without copying.
+// Coordinates are normalized to the upright frame.
+struct GPUPIXEL_API FaceLandmarks {
+  static constexpr int kMaxFaces = 4;
+  // The 106 model points followed by 5 derived centers
+  static constexpr int kPointCount = 111;
+
+  struct Face {
+    int face_id = 0;
+    float score = 0;
+    // left, top, right, bottom
+    float rect[4] = {0, 0, 0, 0};
+    float pitch = 0;
+    float yaw = 0;
+    float roll = 0;
+    float x[kPointCount];
+    float y[kPointCount];
+  };
+
+  int64_t timestamp = 0;
+  int face_count = 0;
+  Face faces[kMaxFaces];
+
+  // Floats in the interleaved x,y layout of the "face_landmark" property
+  size_t InterleavedSize() const {
+    return (size_t)face_count * kPointCount * 2;
+  }
+  // Writes at most |capacity| floats, returns the number written
+  size_t ToInterleaved(float* dst, size_t capacity) const;
+  // Reads whole faces from |count| interleaved floats. A single shorter face
+  // is accepted, its missing points are zero.
+  void FromInterleaved(const float* src, size_t count);
+};
+
+// Recycles FaceLandmarks so results can be published every frame without
+// allocating. A slot is reused once nobody else holds it.
+class GPUPIXEL_API FaceLandmarksPool {
+ public:
+  static std::shared_ptr<FaceLandmarksPool> Create(int depth = 4);
+
+  // Never fails, grows past |depth| while all slots are held
+  std::shared_ptr<FaceLandmarks> Acquire();
+
+ private:
+  explicit FaceLandmarksPool(int depth);
+
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<FaceLandmarks>> slots_;
+};
+
+}  // namespace gpupixel
@@ -0,0 +1,92 @@
+/*
+ * GPUPixel
+ *
+ * Created by PixPark on 2021/6/24.
+ * Copyright © 2021 PixPark. All rights reserved.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "gpupixel/gpupixel_define.h"
+
+namespace gpupixel {
+
+// A frame leased from a FramePool. Holders share it through std::shared_ptr
+// and its memory goes back to the pool once the last holder releases it, so
+// consumers on other threads can keep a frame without copying it.
+class GPUPIXEL_API VideoFrame {
+ public:
+  enum Format { RGBA = 0, BGRA, I420, NV12, NV21 };
+
+  uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+  int GetWidth() const { return width_; }
+  int GetHeight() const { return height_; }
+  // Row pitch of the first plane in bytes. I420 chroma planes use half of
+  // it, NV12/NV21 chroma rows all of it.
+  int GetStride() const { return stride_; }
+  Format GetFormat() const { return format_; }
+  int64_t GetTimestamp() const { return timestamp_; }
+  void SetTimestamp(int64_t timestamp) { timestamp_ = timestamp; }
+
+ private:
+  friend class FramePool;
+  VideoFrame() {}
+
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+  int stride_ = 0;
+  Format format_ = RGBA;
+  int64_t timestamp_ = 0;
+};
+
+// Fixed-depth pool of frame buffers. At most |depth| frames are leased at a
+// time; when all are held Acquire() returns nullptr so a slow consumer drops
+// frames instead of growing memory. Buffers are reused as long as the frame
+// size does not change.
+class GPUPIXEL_API FramePool {
+ public:
+  static std::shared_ptr<FramePool> Create(int depth = 3);
+  ~FramePool();
+
+  std::shared_ptr<VideoFrame> Acquire(int width,
+                                      int height,
+                                      VideoFrame::Format format,
+                                      int stride = 0);
+
+  void SetDepth(int depth);
+  int GetDepth() const;
+  int GetLeasedCount() const;
+
+  // Bytes needed for a frame, |stride| of 0 means tightly packed
+  static size_t FrameSize(int width,
+                          int height,
+                          VideoFrame::Format format,
+                          int& stride);
+
+ private:
+  struct State {
+    std::mutex mutex;
+    int depth = 3;
+    int leased = 0;
+    std::vector<std::unique_ptr<uint8_t[]>> free_buffers;
+    std::vector<size_t> free_sizes;
+  };
+
+  explicit FramePool(int depth);
+  static void Release(const std::shared_ptr<State>& state,
+                      VideoFrame* frame);
+
+  // Shared with outstanding frames so they can be released after the pool
+  // itself is gone
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace gpupixel
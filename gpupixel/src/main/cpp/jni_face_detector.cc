@@ -5,6 +5,8 @@
 
 #include "jni_helpers.h"
 #include "gpupixel/face_detector/face_detector.h"
+#include "gpupixel/filter/face_makeup_filter.h"
+#include "gpupixel/filter/face_reshape_filter.h"
 
 using namespace gpupixel;
 
@@ -45,7 +47,8 @@ Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorDetect(
     jint height,
     jint stride,
     jint format,
-    jint frameType) {
+    jint frameType,
+    jint rotation) {
   // Get Java byte array
   jbyte* data = env->GetByteArrayElements(jData, nullptr);
 
@@ -53,7 +56,8 @@ Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorDetect(
   std::vector<float> landmarks =
       ((FaceDetector*)classId)
           ->Detect((const uint8_t*)data, width, height, stride,
-                   (GPUPIXEL_MODE_FMT)format, (GPUPIXEL_FRAME_TYPE)frameType);
+                   (GPUPIXEL_MODE_FMT)format, (GPUPIXEL_FRAME_TYPE)frameType,
+                   rotation);
 
   // Release Java byte array
   env->ReleaseByteArrayElements(jData, data, JNI_ABORT);
@@ -69,3 +73,236 @@ Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorDetect(
 
   return result;
 }
+
+// Set how often the whole frame is searched in video mode
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorSetDetectInterval(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jint interval) {
+  ((FaceDetector*)classId)->SetDetectInterval(interval);
+}
+
+// Set the score below which tracking falls back to a full search
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorSetTrackingThreshold(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jfloat score) {
+  ((FaceDetector*)classId)->SetTrackingThreshold(score);
+}
+
+// Forget the tracked face
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorResetTracking(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId) {
+  ((FaceDetector*)classId)->ResetTracking();
+}
+
+// Queue a frame for asynchronous detection
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorDetectAsync(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jbyteArray jData,
+    jint width,
+    jint height,
+    jint stride,
+    jint format,
+    jint frameType,
+    jint rotation,
+    jlong timestamp) {
+  // The frame is copied into the mailbox, so a critical section is enough
+  void* data = env->GetPrimitiveArrayCritical(jData, nullptr);
+  if (data == nullptr) {
+    return;
+  }
+  ((FaceDetector*)classId)
+      ->DetectAsync((const uint8_t*)data, width, height, stride,
+                    (GPUPIXEL_MODE_FMT)format, (GPUPIXEL_FRAME_TYPE)frameType,
+                    rotation, timestamp);
+  env->ReleasePrimitiveArrayCritical(jData, data, JNI_ABORT);
+}
+
+// Queue a frame held in a direct buffer, e.g. a camera luma plane
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorDetectAsyncBuffer(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jobject jBuffer,
+    jint width,
+    jint height,
+    jint stride,
+    jint format,
+    jint frameType,
+    jint rotation,
+    jlong timestamp) {
+  void* data = env->GetDirectBufferAddress(jBuffer);
+  if (data == nullptr ||
+      env->GetDirectBufferCapacity(jBuffer) < (jlong)stride * height) {
+    return;
+  }
+  ((FaceDetector*)classId)
+      ->DetectAsync((const uint8_t*)data, width, height, stride,
+                    (GPUPIXEL_MODE_FMT)format, (GPUPIXEL_FRAME_TYPE)frameType,
+                    rotation, timestamp);
+}
+
+// Set the longer side frames are downscaled to before detection
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorSetDetectSize(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jint size) {
+  ((FaceDetector*)classId)->SetDetectSize(size);
+}
+
+// Newest asynchronous landmarks moved to the given frame time
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorGetLandmarksAt(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jlong timestamp) {
+  std::vector<float> landmarks =
+      ((FaceDetector*)classId)->GetLandmarksAt(timestamp);
+
+  jfloatArray result = env->NewFloatArray(landmarks.size());
+  if (result == nullptr) {
+    return nullptr;
+  }
+  env->SetFloatArrayRegion(result, 0, landmarks.size(), landmarks.data());
+  return result;
+}
+
+// Timestamp of the frame the newest asynchronous result belongs to, -1 if none
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorGetLatestTimestamp(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId) {
+  std::vector<float> landmarks;
+  int64_t timestamp = 0;
+  if (!((FaceDetector*)classId)->GetLatestLandmarks(landmarks, timestamp)) {
+    return -1;
+  }
+  return timestamp;
+}
+
+// Limit the faces returned per frame
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorSetMaxFaces(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jint count) {
+  ((FaceDetector*)classId)->SetMaxFaces(count);
+}
+
+// Detect faces with their ids, boxes, scores and poses
+extern "C" JNIEXPORT jobjectArray JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorDetectFaces(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jbyteArray jData,
+    jint width,
+    jint height,
+    jint stride,
+    jint format,
+    jint frameType,
+    jint rotation) {
+  jbyte* data = env->GetByteArrayElements(jData, nullptr);
+  std::vector<FaceInfo> faces =
+      ((FaceDetector*)classId)
+          ->DetectFaces((const uint8_t*)data, width, height, stride,
+                        (GPUPIXEL_MODE_FMT)format,
+                        (GPUPIXEL_FRAME_TYPE)frameType, rotation);
+  env->ReleaseByteArrayElements(jData, data, JNI_ABORT);
+
+  jclass face_class = env->FindClass("com/pixpark/gpupixel/FaceDetector$Face");
+  if (face_class == nullptr) {
+    return nullptr;
+  }
+  jmethodID constructor =
+      env->GetMethodID(face_class, "<init>", "(IF[FFFF[F)V");
+  jobjectArray result = env->NewObjectArray(faces.size(), face_class, nullptr);
+  if (constructor == nullptr || result == nullptr) {
+    return nullptr;
+  }
+
+  for (size_t i = 0; i < faces.size(); i++) {
+    const FaceInfo& face = faces[i];
+    jfloatArray rect = env->NewFloatArray(4);
+    env->SetFloatArrayRegion(rect, 0, 4, face.rect);
+    jfloatArray landmarks = env->NewFloatArray(face.landmarks.size());
+    env->SetFloatArrayRegion(landmarks, 0, face.landmarks.size(),
+                             face.landmarks.data());
+    jobject item = env->NewObject(face_class, constructor, face.face_id,
+                                  face.score, rect, face.pitch, face.yaw,
+                                  face.roll, landmarks);
+    env->SetObjectArrayElement(result, i, item);
+    env->DeleteLocalRef(item);
+    env->DeleteLocalRef(rect);
+    env->DeleteLocalRef(landmarks);
+  }
+  env->DeleteLocalRef(face_class);
+  return result;
+}
+
+// Copy the newest asynchronous landmarks, moved to the given frame time, into
+// a direct FloatBuffer. Returns the number of faces written.
+extern "C" JNIEXPORT jint JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorGetLandmarksInto(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jlong timestamp,
+    jobject jBuffer,
+    jint position,
+    jint remaining) {
+  // Java checked the byte order, the range is position() to limit()
+  float* dst = (float*)env->GetDirectBufferAddress(jBuffer);
+  jlong capacity = env->GetDirectBufferCapacity(jBuffer);
+  auto landmarks = ((FaceDetector*)classId)->GetFaceLandmarksAt(timestamp);
+  if (dst == nullptr || !landmarks || position < 0 || remaining < 0 ||
+      position + (jlong)remaining > capacity) {
+    return 0;
+  }
+  size_t written = landmarks->ToInterleaved(dst + position, remaining);
+  return written / (FaceLandmarks::kPointCount * 2);
+}
+
+// Hand the newest asynchronous landmarks to face filters by reference
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_FaceDetector_nativeFaceDetectorApplyLandmarksAt(
+    JNIEnv* env,
+    jclass obj,
+    jlong classId,
+    jlong timestamp,
+    jlongArray jFilterIds) {
+  auto landmarks = ((FaceDetector*)classId)->GetFaceLandmarksAt(timestamp);
+
+  jsize count = env->GetArrayLength(jFilterIds);
+  jlong* filter_ids = env->GetLongArrayElements(jFilterIds, nullptr);
+  for (jsize i = 0; i < count; i++) {
+    auto* ptr = reinterpret_cast<std::shared_ptr<Filter>*>(filter_ids[i]);
+    if (!ptr || !*ptr) {
+      continue;
+    }
+    if (auto reshape = std::dynamic_pointer_cast<FaceReshapeFilter>(*ptr)) {
+      reshape->SetFaceLandmarks(landmarks);
+    } else if (auto makeup =
+                   std::dynamic_pointer_cast<FaceMakeupFilter>(*ptr)) {
+      makeup->SetFaceLandmarks(landmarks);
+    }
+  }
+  env->ReleaseLongArrayElements(jFilterIds, filter_ids, JNI_ABORT);
+}
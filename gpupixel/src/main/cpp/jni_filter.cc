@@ -128,16 +128,12 @@ Java_com_pixpark_gpupixel_GPUPixelFilter_nativeFilterSetPropertyFloatArray(
   const char* property = env->GetStringUTFChars(jProperty, 0);
   jsize length = env->GetArrayLength(jarray);
 
-  // Get pointer to the original Java array
-  jfloat* c_array = env->GetFloatArrayElements(jarray, nullptr);
-  std::vector<float> vector;
-  for (int i = 0; i < length; i++) {
-    vector.push_back(c_array[i]);
-  }
+  // Reused per thread, landmarks arrive every frame
+  static thread_local std::vector<float> vector;
+  vector.resize(length);
+  env->GetFloatArrayRegion(jarray, 0, length, vector.data());
 
   (*ptr)->SetProperty(property, vector);
 
   env->ReleaseStringUTFChars(jProperty, property);
-  // Release Java array memory
-  env->ReleaseFloatArrayElements(jarray, c_array, JNI_ABORT);
 }
@@ -6,6 +6,8 @@
 
 #include "jni_helpers.h"
 
+#include "gpupixel/gpupixel.h"
+
 #include <android/log.h>
 #include <asm/unistd.h>
 #include <sys/prctl.h>
@@ -14,10 +16,7 @@
 #include <cstring>
 #include <sstream>
 #include <string>
-#include "libyuv/convert.h"
-#include "libyuv/convert_argb.h"
-#include "libyuv/planar_functions.h"
-#include "libyuv/rotate.h"
+#include "utils/image_converter.h"
 #include "utils/logging.h"
 #include "utils/util.h"
 
@@ -64,118 +63,44 @@ Java_com_pixpark_gpupixel_GPUPixel_nativeYUV420ToRGBA(JNIEnv* env,
   uint8_t* y_data = (uint8_t*)env->GetDirectBufferAddress(y_buffer);
   uint8_t* u_data = (uint8_t*)env->GetDirectBufferAddress(u_buffer);
   uint8_t* v_data = (uint8_t*)env->GetDirectBufferAddress(v_buffer);
-
-  // Get output array
-  jbyte* rgba_data = env->GetByteArrayElements(rgba_out, nullptr);
-
-  if (!y_data || !u_data || !v_data || !rgba_data) {
+  if (!y_data || !u_data || !v_data) {
     LOG_ERROR("Failed to get buffer addresses");
-    if (rgba_data) {
-      env->ReleaseByteArrayElements(rgba_out, rgba_data, 0);
-    }
     return;
   }
-
-  // If pixel stride is 1, use standard libyuv conversion function
-  if (y_pixel_stride == 1 && u_pixel_stride == 1 && v_pixel_stride == 1) {
-    // Create temporary NV12/NV21 buffer (Y plane and interleaved UV plane)
-    uint8_t* nv21_data = new uint8_t[width * height * 3 / 2];
-    if (!nv21_data) {
-      LOG_ERROR("Memory allocation failed");
-      env->ReleaseByteArrayElements(rgba_out, rgba_data, 0);
-      return;
-    }
-
-    // Copy Y plane
-    for (int i = 0; i < height; i++) {
-      memcpy(nv21_data + i * width, y_data + i * y_row_stride, width);
-    }
-
-    // Build NV21 format (VU interleaved) UV plane
-    uint8_t* nv21_vu_data = nv21_data + width * height;
-    int uv_height = height / 2;
-    int uv_width = width / 2;
-
-    for (int i = 0; i < uv_height; i++) {
-      for (int j = 0; j < uv_width; j++) {
-        int offset = i * u_row_stride + j;
-        nv21_vu_data[i * width + j * 2] = v_data[offset];      // V
-        nv21_vu_data[i * width + j * 2 + 1] = u_data[offset];  // U
-      }
-    }
-
-    // Use libyuv to convert NV21 to RGBA
-    libyuv::NV21ToABGR(nv21_data,                   // Y
-                       width,                       // Y stride
-                       nv21_data + width * height,  // VU
-                       width,                       // VU stride
-                       (uint8_t*)rgba_data,         // RGBA
-                       width * 4,                   // RGBA stride
-                       width, height);
-
-    delete[] nv21_data;
-  } else {
-    // Non-standard pixel stride, handle manually
+  if (u_pixel_stride != v_pixel_stride) {
     std::stringstream ss;
-    ss << "Non-standard pixel stride: Y=" << y_pixel_stride
-       << " U=" << u_pixel_stride << " V=" << v_pixel_stride;
-    LOG_INFO("{}", ss.str());
-
-    // Create temporary buffers
-    uint8_t* y_plane = new uint8_t[width * height];
-    uint8_t* u_plane = new uint8_t[width * height / 4];
-    uint8_t* v_plane = new uint8_t[width * height / 4];
-
-    if (!y_plane || !u_plane || !v_plane) {
-      LOG_ERROR("Memory allocation failed");
-      delete[] y_plane;
-      delete[] u_plane;
-      delete[] v_plane;
-      env->ReleaseByteArrayElements(rgba_out, rgba_data, 0);
-      return;
-    }
-
-    // Extract continuous plane data from stride data
-    for (int i = 0; i < height; i++) {
-      for (int j = 0; j < width; j++) {
-        y_plane[i * width + j] = y_data[i * y_row_stride + j * y_pixel_stride];
-      }
-    }
-
-    int uv_height = height / 2;
-    int uv_width = width / 2;
+    ss << "Mismatched chroma pixel strides: U=" << u_pixel_stride
+       << " V=" << v_pixel_stride;
+    LOG_ERROR("{}", ss.str());
+    return;
+  }
+  if (env->GetArrayLength(rgba_out) < width * height * 4) {
+    std::stringstream ss;
+    ss << "RGBA array too small for " << width << "x" << height;
+    LOG_ERROR("{}", ss.str());
+    return;
+  }
 
-    for (int i = 0; i < uv_height; i++) {
-      for (int j = 0; j < uv_width; j++) {
-        u_plane[i * uv_width + j] =
-            u_data[i * u_row_stride + j * u_pixel_stride];
-        v_plane[i * uv_width + j] =
-            v_data[i * v_row_stride + j * v_pixel_stride];
-      }
-    }
+  // Critical access avoids the copy GetByteArrayElements may make
+  void* rgba_data = env->GetPrimitiveArrayCritical(rgba_out, nullptr);
+  if (!rgba_data) {
+    LOG_ERROR("Failed to get array elements");
+    return;
+  }
 
-    // Use libyuv to convert I420(YUV420) to RGBA
-    libyuv::I420ToABGR(y_plane,              // Y
-                       width,                // Y stride
-                       u_plane,              // U
-                       uv_width,             // U stride
-                       v_plane,              // V
-                       uv_width,             // V stride
-                       (uint8_t*)rgba_data,  // RGBA
-                       width * 4,            // RGBA stride
-                       width, height);
+  bool ok = gpupixel::ImageConverter::Android420ToRGBA(
+      y_data, y_row_stride, y_pixel_stride, u_data, u_row_stride, v_data,
+      v_row_stride, u_pixel_stride, static_cast<uint8_t*>(rgba_data),
+      width * 4, width, height);
 
-    delete[] y_plane;
-    delete[] u_plane;
-    delete[] v_plane;
+  env->ReleasePrimitiveArrayCritical(rgba_out, rgba_data, 0);
+  if (!ok) {
+    LOG_ERROR("YUV420 to RGBA conversion failed");
   }
-
-  // Release Java array
-  env->ReleaseByteArrayElements(rgba_out, rgba_data, 0);
 }
 
 /**
- * Rotate RGBA format image
+ * Rotate RGBA format image, optionally mirroring the rotated result
  */
 extern "C" JNIEXPORT void JNICALL
 Java_com_pixpark_gpupixel_GPUPixel_nativeRotateRGBA(JNIEnv* env,
@@ -186,106 +111,47 @@ Java_com_pixpark_gpupixel_GPUPixel_nativeRotateRGBA(JNIEnv* env,
                                                     jbyteArray rgba_out,
                                                     jint out_width,
                                                     jint out_height,
-                                                    jint rotation_degrees) {
-  // Get input and output arrays
-  jbyte* rgba_in_data = env->GetByteArrayElements(rgba_in, nullptr);
-  jbyte* rgba_out_data = env->GetByteArrayElements(rgba_out, nullptr);
+                                                    jint rotation_degrees,
+                                                    jboolean mirror) {
+  if (env->GetArrayLength(rgba_in) < width * height * 4 ||
+      env->GetArrayLength(rgba_out) < out_width * out_height * 4) {
+    std::stringstream ss;
+    ss << "RGBA array too small for " << width << "x" << height;
+    LOG_ERROR("{}", ss.str());
+    return;
+  }
+
+  // Critical access avoids the copies GetByteArrayElements may make, no JNI
+  // calls are allowed until both arrays are released
+  void* rgba_in_data = env->GetPrimitiveArrayCritical(rgba_in, nullptr);
+  void* rgba_out_data = env->GetPrimitiveArrayCritical(rgba_out, nullptr);
 
   if (!rgba_in_data || !rgba_out_data) {
-    LOG_ERROR("Failed to get array elements");
-    if (rgba_in_data) {
-      env->ReleaseByteArrayElements(rgba_in, rgba_in_data, JNI_ABORT);
-    }
     if (rgba_out_data) {
-      env->ReleaseByteArrayElements(rgba_out, rgba_out_data, JNI_ABORT);
+      env->ReleasePrimitiveArrayCritical(rgba_out, rgba_out_data, JNI_ABORT);
+    }
+    if (rgba_in_data) {
+      env->ReleasePrimitiveArrayCritical(rgba_in, rgba_in_data, JNI_ABORT);
     }
+    LOG_ERROR("Failed to get array elements");
     return;
   }
 
-  // Rotate RGBA image using pure C++ code
-  uint8_t* src = (uint8_t*)rgba_in_data;
-  uint8_t* dst = (uint8_t*)rgba_out_data;
-
-  // Process based on rotation angle
-  switch (rotation_degrees) {
-    case 0:  // No rotation
-      memcpy(dst, src, width * height * 4);
-      break;
-
-    case 90:  // Rotate 90 degrees clockwise
-      for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-          // Source pixel position in RGBA array
-          int srcIdx = (y * width + x) * 4;
-
-          // Target pixel position: (height - 1 - y, x) -> (x, height - 1 - y)
-          // After 90° rotation, x coordinate becomes row(y), y coordinate
-          // becomes column(x)
-          int dstX = height - 1 - y;
-          int dstY = x;
-          int dstIdx = (dstY * out_width + dstX) * 4;
-
-          // Copy all four RGBA channels
-          dst[dstIdx] = src[srcIdx];          // R
-          dst[dstIdx + 1] = src[srcIdx + 1];  // G
-          dst[dstIdx + 2] = src[srcIdx + 2];  // B
-          dst[dstIdx + 3] = src[srcIdx + 3];  // A
-        }
-      }
-      break;
-
-    case 180:  // Rotate 180 degrees
-      for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-          // Source pixel position in RGBA array
-          int srcIdx = (y * width + x) * 4;
-
-          // Target pixel position: (width - 1 - x, height - 1 - y)
-          int dstX = width - 1 - x;
-          int dstY = height - 1 - y;
-          int dstIdx = (dstY * out_width + dstX) * 4;
-
-          // Copy all four RGBA channels
-          dst[dstIdx] = src[srcIdx];          // R
-          dst[dstIdx + 1] = src[srcIdx + 1];  // G
-          dst[dstIdx + 2] = src[srcIdx + 2];  // B
-          dst[dstIdx + 3] = src[srcIdx + 3];  // A
-        }
-      }
-      break;
-
-    case 270:  // Rotate 270 degrees clockwise (90 degrees counterclockwise)
-      for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-          // Source pixel position in RGBA array
-          int srcIdx = (y * width + x) * 4;
-
-          // Target pixel position: (y, width - 1 - x)
-          int dstX = y;
-          int dstY = width - 1 - x;
-          int dstIdx = (dstY * out_width + dstX) * 4;
+  bool ok = gpupixel::ImageConverter::RotateRGBA(
+      static_cast<const uint8_t*>(rgba_in_data), width * 4,
+      static_cast<uint8_t*>(rgba_out_data), out_width * 4, width, height,
+      rotation_degrees, mirror);
+  if (!ok) {
+    // Unsupported angle, pass the frame through unrotated
+    memcpy(rgba_out_data, rgba_in_data, width * height * 4);
+  }
 
-          // Copy all four RGBA channels
-          dst[dstIdx] = src[srcIdx];          // R
-          dst[dstIdx + 1] = src[srcIdx + 1];  // G
-          dst[dstIdx + 2] = src[srcIdx + 2];  // B
-          dst[dstIdx + 3] = src[srcIdx + 3];  // A
-        }
-      }
-      break;
+  env->ReleasePrimitiveArrayCritical(rgba_out, rgba_out_data, 0);
+  env->ReleasePrimitiveArrayCritical(rgba_in, rgba_in_data, JNI_ABORT);
 
-    default: {
-      std::stringstream ss;
-      ss << "Unsupported rotation angle: " << rotation_degrees;
-      LOG_ERROR("{}", ss.str());
-    }
-      memcpy(dst, src, width * height * 4);
-      break;
+  if (!ok) {
+    LOG_ERROR("Unsupported rotation angle: {}", rotation_degrees);
   }
-
-  // Release Java arrays
-  env->ReleaseByteArrayElements(rgba_in, rgba_in_data, JNI_ABORT);
-  env->ReleaseByteArrayElements(rgba_out, rgba_out_data, 0);
 }
 
 /**
@@ -317,3 +183,15 @@ Java_com_pixpark_gpupixel_GPUPixel_nativeSetResourcePath(JNIEnv* env,
   ss << "Set resource path to: " << c_path;
   LOG_INFO("{}", ss.str());
 }
+
+/**
+ * Configure the CPU worker pool
+ */
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixel_nativeSetCpuThreads(JNIEnv* env,
+                                                       jclass clazz,
+                                                       jint thread_count,
+                                                       jint affinity) {
+  gpupixel::GPUPixel::SetCpuThreads(
+      thread_count, static_cast<gpupixel::GPUPixel::CpuAffinity>(affinity));
+}
@@ -144,3 +144,277 @@ Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeGetI420Buffer(
 
   return result;
 }
+
+// Get YUV buffer data in the configured layout
+extern "C" JNIEXPORT jbyteArray JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeGetYuvBuffer(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (!ptr || !*ptr) {
+    return NULL;
+  }
+
+  const uint8_t* buffer = (*ptr)->GetYuvBuffer();
+  if (!buffer) {
+    return NULL;
+  }
+
+  int width = (*ptr)->GetWidth();
+  int height = (*ptr)->GetHeight();
+  if (width <= 0 || height <= 0) {
+    return NULL;
+  }
+  if (width > INT_MAX / height || width * height > INT_MAX / 2) {
+    return NULL;
+  }
+
+  int size = width * height * 3 / 2;
+  jbyteArray result = env->NewByteArray(size);
+  if (!result) {
+    return NULL;
+  }
+
+  env->SetByteArrayRegion(result, 0, size, (jbyte*)buffer);
+  return result;
+}
+
+// Select YUV layout, matrix and range
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeSetYuvFormat(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jint format,
+    jint matrix,
+    jint range) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->SetYuvFormat(static_cast<SinkRawData::YuvFormat>(format),
+                         static_cast<SinkRawData::YuvMatrix>(matrix),
+                         static_cast<SinkRawData::YuvRange>(range));
+  }
+}
+
+// Set output size, 0 keeps the cropped input size
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeSetOutputSize(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jint width,
+    jint height) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->SetOutputSize(width, height);
+  }
+}
+
+// Set normalized crop rectangle
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeSetCropRect(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jfloat x,
+    jfloat y,
+    jfloat width,
+    jfloat height) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->SetCropRect(x, y, width, height);
+  }
+}
+
+// Set output pixel format
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeSetOutputFormat(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jint format) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->SetOutputFormat(static_cast<GPUPIXEL_FRAME_TYPE>(format));
+  }
+}
+
+// Read RGBA into a direct ByteBuffer owned by the caller
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeReadRgbaInto(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jobject buffer,
+    jint row_stride) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (!ptr || !*ptr || !buffer) {
+    return JNI_FALSE;
+  }
+
+  void* address = env->GetDirectBufferAddress(buffer);
+  jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (!address || capacity <= 0) {
+    return JNI_FALSE;
+  }
+
+  return (*ptr)->ReadRgbaInto(static_cast<uint8_t*>(address),
+                              static_cast<size_t>(capacity), row_stride)
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+// Read YUV in the configured layout into a direct ByteBuffer
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeReadYuvInto(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jobject buffer,
+    jint row_stride) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (!ptr || !*ptr || !buffer) {
+    return JNI_FALSE;
+  }
+
+  void* address = env->GetDirectBufferAddress(buffer);
+  jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (!address || capacity <= 0) {
+    return JNI_FALSE;
+  }
+
+  return (*ptr)->ReadYuvInto(static_cast<uint8_t*>(address),
+                             static_cast<size_t>(capacity), row_stride)
+             ? JNI_TRUE
+             : JNI_FALSE;
+}
+
+// Lease the current frame as RGBA, returns a handle owned by the Java frame
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeAcquireRgbaFrame(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (!ptr || !*ptr) {
+    return 0;
+  }
+  auto frame = (*ptr)->AcquireRgbaFrame();
+  if (!frame) {
+    return 0;
+  }
+  return reinterpret_cast<jlong>(new std::shared_ptr<VideoFrame>(frame));
+}
+
+// Lease the current frame as YUV in the configured layout
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeAcquireYuvFrame(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (!ptr || !*ptr) {
+    return 0;
+  }
+  auto frame = (*ptr)->AcquireYuvFrame();
+  if (!frame) {
+    return 0;
+  }
+  return reinterpret_cast<jlong>(new std::shared_ptr<VideoFrame>(frame));
+}
+
+// Set the maximum number of frames leased at once
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeSetFramePoolDepth(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jint depth) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->SetFramePoolDepth(depth);
+  }
+}
+
+// Enable asynchronous RGBA readback, frames are delivered to |callback|
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeEnableAsyncReadback(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jobject callback,
+    jint ring_size) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (!ptr || !*ptr || !callback) {
+    return;
+  }
+
+  jclass callback_class = env->GetObjectClass(callback);
+  jmethodID on_frame = env->GetMethodID(callback_class, "onFrame",
+                                        "(Ljava/nio/ByteBuffer;IIJ)V");
+  env->DeleteLocalRef(callback_class);
+  if (!on_frame) {
+    return;
+  }
+
+  // The global reference lives as long as the native callback does
+  std::shared_ptr<_jobject> callback_ref(
+      env->NewGlobalRef(callback), [](jobject ref) {
+        AttachThreadScoped ats(GetJVM());
+        ats.env()->DeleteGlobalRef(ref);
+      });
+
+  (*ptr)->EnableAsyncReadback(
+      [callback_ref, on_frame](const uint8_t* rgba, int width, int height,
+                               int64_t timestamp) {
+        AttachThreadScoped ats(GetJVM());
+        JNIEnv* jni = ats.env();
+        // Wraps the mapped buffer, only valid until onFrame returns
+        jobject buffer = jni->NewDirectByteBuffer(
+            const_cast<uint8_t*>(rgba), (jlong)width * height * 4);
+        if (!buffer) {
+          return;
+        }
+        jni->CallVoidMethod(callback_ref.get(), on_frame, buffer, width,
+                            height, (jlong)timestamp);
+        jni->DeleteLocalRef(buffer);
+      },
+      ring_size);
+}
+
+// Disable asynchronous readback, pending frames are delivered first
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeDisableAsyncReadback(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->DisableAsyncReadback();
+  }
+}
+
+// Deliver completed readbacks without waiting
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativePollAsyncReadback(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->PollAsyncReadback();
+  }
+}
+
+// Wait for and deliver all pending readbacks
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSinkRawData_nativeFlushAsyncReadback(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SinkRawData>*>(native_obj);
+  if (ptr && *ptr) {
+    (*ptr)->FlushAsyncReadback();
+  }
+}
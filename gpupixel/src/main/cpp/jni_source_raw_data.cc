@@ -68,7 +68,36 @@ Java_com_pixpark_gpupixel_GPUPixelSourceRawData_nativeProcessData(
   (*ptr)->ProcessData((uint8_t*)bytes, width, height, stride,
                       (GPUPIXEL_FRAME_TYPE)type);
 
-  env->ReleaseByteArrayElements(data, bytes, 0);
+  // The frame is only read, so skip copying it back into the Java array
+  env->ReleaseByteArrayElements(data, bytes, JNI_ABORT);
+}
+
+// Process data with per-frame rotation (degrees), mirroring and timestamp
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSourceRawData_nativeProcessDataWithRotation(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj,
+    jbyteArray data,
+    jint width,
+    jint height,
+    jint stride,
+    jint type,
+    jint rotation,
+    jboolean mirror,
+    jlong timestamp) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SourceRawData>*>(native_obj);
+  if (!ptr || !*ptr) {
+    return;
+  }
+
+  jbyte* bytes = env->GetByteArrayElements(data, NULL);
+
+  (*ptr)->ProcessData((uint8_t*)bytes, width, height, stride,
+                      (GPUPIXEL_FRAME_TYPE)type, rotation, mirror == JNI_TRUE,
+                      timestamp);
+
+  env->ReleaseByteArrayElements(data, bytes, JNI_ABORT);
 }
 
 // Set rotation mode
@@ -83,3 +112,23 @@ Java_com_pixpark_gpupixel_GPUPixelSourceRawData_nativeSetRotation(
     (*ptr)->SetRotation((RotationMode)rotation);
   }
 }
+
+// Get the CPU time spent uploading the last frame, in microseconds
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSourceRawData_nativeGetLastUploadTimeUs(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SourceRawData>*>(native_obj);
+  return ptr && *ptr ? (*ptr)->GetUploadStats().last_upload_us : 0;
+}
+
+// Get the average CPU time spent uploading a frame, in microseconds
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_pixpark_gpupixel_GPUPixelSourceRawData_nativeGetAverageUploadTimeUs(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<SourceRawData>*>(native_obj);
+  return ptr && *ptr ? (*ptr)->GetUploadStats().average_upload_us : 0;
+}
@@ -0,0 +1,90 @@
+#include <jni.h>
+
+#include "gpupixel/utils/frame_pool.h"
+#include "jni_helpers.h"
+
+using namespace gpupixel;
+
+// Release a leased frame reference
+extern "C" JNIEXPORT void JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeRelease(JNIEnv* env,
+                                                           jclass clazz,
+                                                           jlong native_obj) {
+  // The pooled buffer returns to its pool once the last reference is gone
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  delete ptr;
+}
+
+// Take an additional reference to the same frame
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeRetain(JNIEnv* env,
+                                                          jclass clazz,
+                                                          jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  if (!ptr || !*ptr) {
+    return 0;
+  }
+  return reinterpret_cast<jlong>(new std::shared_ptr<VideoFrame>(*ptr));
+}
+
+// Wrap the frame memory in a direct ByteBuffer, valid until release
+extern "C" JNIEXPORT jobject JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeGetBuffer(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  if (!ptr || !*ptr) {
+    return NULL;
+  }
+  return env->NewDirectByteBuffer((*ptr)->GetData(), (*ptr)->GetSize());
+}
+
+// Get width
+extern "C" JNIEXPORT jint JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeGetWidth(JNIEnv* env,
+                                                            jclass clazz,
+                                                            jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  return ptr && *ptr ? (*ptr)->GetWidth() : 0;
+}
+
+// Get height
+extern "C" JNIEXPORT jint JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeGetHeight(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  return ptr && *ptr ? (*ptr)->GetHeight() : 0;
+}
+
+// Get row stride in bytes
+extern "C" JNIEXPORT jint JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeGetStride(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  return ptr && *ptr ? (*ptr)->GetStride() : 0;
+}
+
+// Get pixel format
+extern "C" JNIEXPORT jint JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeGetFormat(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  return ptr && *ptr ? (*ptr)->GetFormat() : 0;
+}
+
+// Get timestamp in microseconds
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_pixpark_gpupixel_GPUPixelVideoFrame_nativeGetTimestamp(
+    JNIEnv* env,
+    jclass clazz,
+    jlong native_obj) {
+  auto* ptr = reinterpret_cast<std::shared_ptr<VideoFrame>*>(native_obj);
+  return ptr && *ptr ? (*ptr)->GetTimestamp() : 0;
+}
@@ -42,6 +42,18 @@ int Sink::NextAvailableTextureIndex() const {
   return input_count_ - 1;
 }
 
+std::string Sink::GetInputSignature() const {
+  std::string signature;
+  for (const auto& it : input_framebuffers_) {
+    if (it.second.frame_buffer) {
+      signature += Util::StringFormat("%d:%p:%d;", it.first,
+                                      it.second.frame_buffer.get(),
+                                      (int)it.second.rotation_mode);
+    }
+  }
+  return signature;
+}
+
 bool Sink::IsReady() const {
   int prepared_num = 0;
   int ignore_for_prepare_num = 0;
@@ -7,9 +7,11 @@
 //
 
 #include "gpupixel/sink/sink_raw_data.h"
+#include <algorithm>
 #include <cstring>
 #include "core/gpupixel_context.h"
 #include "libyuv.h"
+#include "utils/thread_pool.h"
 #include "utils/util.h"
 
 namespace gpupixel {
@@ -28,15 +30,160 @@ const std::string kRGBToI420VertexShaderString = R"(
 const std::string kRGBToI420FragmentShaderString = R"(
     varying mediump vec2 textureCoordinate;
     uniform sampler2D sTexture;
+    uniform mediump vec2 tapOffset;
+    uniform lowp float swapRedBlue;
     void main() {
-      gl_FragColor = texture2D(sTexture, textureCoordinate);
+      // Four bilinear taps cover the source footprint when downscaling
+      lowp vec4 color =
+          (texture2D(sTexture, textureCoordinate - tapOffset) +
+           texture2D(sTexture, textureCoordinate + tapOffset) +
+           texture2D(sTexture,
+                     textureCoordinate + vec2(tapOffset.x, -tapOffset.y)) +
+           texture2D(sTexture,
+                     textureCoordinate + vec2(-tapOffset.x, tapOffset.y))) *
+          0.25;
+      gl_FragColor = mix(color, color.bgra, swapRedBlue);
     })";
 #elif defined(GPUPIXEL_GL_SHADER)
 const std::string kRGBToI420FragmentShaderString = R"(
     varying vec2 textureCoordinate;
     uniform sampler2D sTexture;
+    uniform vec2 tapOffset;
+    uniform float swapRedBlue;
     void main() {
-      gl_FragColor = texture2D(sTexture, textureCoordinate);
+      // Four bilinear taps cover the source footprint when downscaling
+      vec4 color =
+          (texture2D(sTexture, textureCoordinate - tapOffset) +
+           texture2D(sTexture, textureCoordinate + tapOffset) +
+           texture2D(sTexture,
+                     textureCoordinate + vec2(tapOffset.x, -tapOffset.y)) +
+           texture2D(sTexture,
+                     textureCoordinate + vec2(-tapOffset.x, tapOffset.y))) *
+          0.25;
+      gl_FragColor = mix(color, color.bgra, swapRedBlue);
+    })";
+#endif
+
+// Each output texel holds four bytes of the packed YUV buffer. Rows
+// [0, height) are luma, the rest is chroma: for I420 two U rows, then two V
+// rows, share one output row; for NV12/NV21 each output row is one
+// interleaved chroma row. Chroma is sampled at the centre of its 2x2 block so
+// bilinear filtering averages the four source pixels.
+const std::string kYuvPackVertexShaderString = R"(
+    attribute vec4 position;
+
+    void main() {
+      gl_Position = position;
+    })";
+
+#if defined(GPUPIXEL_GLES_SHADER)
+const std::string kYuvPackFragmentShaderString = R"(
+    precision highp float;
+    uniform sampler2D sTexture;
+    uniform vec2 sourceSize;
+    uniform float chromaLayout;
+    uniform mat3 colorMatrix;
+    uniform float lumaOffset;
+
+    vec3 fetch(vec2 pos) {
+      return texture2D(sTexture, pos / sourceSize).rgb;
+    }
+
+    float luma(vec2 pos) {
+      return dot(fetch(pos), colorMatrix[0]) + lumaOffset;
+    }
+
+    vec2 chroma(vec2 pos) {
+      vec3 rgb = fetch(pos);
+      return vec2(dot(rgb, colorMatrix[1]), dot(rgb, colorMatrix[2])) +
+             128.0 / 255.0;
+    }
+
+    void main() {
+      vec2 texel = floor(gl_FragCoord.xy);
+      float x = texel.x * 4.0;
+      if (texel.y < sourceSize.y) {
+        float y = texel.y + 0.5;
+        gl_FragColor = vec4(luma(vec2(x + 0.5, y)), luma(vec2(x + 1.5, y)),
+                            luma(vec2(x + 2.5, y)), luma(vec2(x + 3.5, y)));
+        return;
+      }
+
+      float row = texel.y - sourceSize.y;
+      if (chromaLayout < 0.5) {
+        float planeRows = sourceSize.y * 0.25;
+        float plane = step(planeRows, row);
+        float halfWidth = sourceSize.x * 0.5;
+        float cy = (row - plane * planeRows) * 2.0 + step(halfWidth, x);
+        float sx = mod(x, halfWidth) * 2.0 + 1.0;
+        float sy = cy * 2.0 + 1.0;
+        vec4 u = vec4(chroma(vec2(sx, sy)).x, chroma(vec2(sx + 2.0, sy)).x,
+                      chroma(vec2(sx + 4.0, sy)).x,
+                      chroma(vec2(sx + 6.0, sy)).x);
+        vec4 v = vec4(chroma(vec2(sx, sy)).y, chroma(vec2(sx + 2.0, sy)).y,
+                      chroma(vec2(sx + 4.0, sy)).y,
+                      chroma(vec2(sx + 6.0, sy)).y);
+        gl_FragColor = mix(u, v, plane);
+      } else {
+        float sy = row * 2.0 + 1.0;
+        vec2 c0 = chroma(vec2(x + 1.0, sy));
+        vec2 c1 = chroma(vec2(x + 3.0, sy));
+        gl_FragColor = chromaLayout < 1.5 ? vec4(c0, c1) : vec4(c0.yx, c1.yx);
+      }
+    })";
+#elif defined(GPUPIXEL_GL_SHADER)
+const std::string kYuvPackFragmentShaderString = R"(
+    uniform sampler2D sTexture;
+    uniform vec2 sourceSize;
+    uniform float chromaLayout;
+    uniform mat3 colorMatrix;
+    uniform float lumaOffset;
+
+    vec3 fetch(vec2 pos) {
+      return texture2D(sTexture, pos / sourceSize).rgb;
+    }
+
+    float luma(vec2 pos) {
+      return dot(fetch(pos), colorMatrix[0]) + lumaOffset;
+    }
+
+    vec2 chroma(vec2 pos) {
+      vec3 rgb = fetch(pos);
+      return vec2(dot(rgb, colorMatrix[1]), dot(rgb, colorMatrix[2])) +
+             128.0 / 255.0;
+    }
+
+    void main() {
+      vec2 texel = floor(gl_FragCoord.xy);
+      float x = texel.x * 4.0;
+      if (texel.y < sourceSize.y) {
+        float y = texel.y + 0.5;
+        gl_FragColor = vec4(luma(vec2(x + 0.5, y)), luma(vec2(x + 1.5, y)),
+                            luma(vec2(x + 2.5, y)), luma(vec2(x + 3.5, y)));
+        return;
+      }
+
+      float row = texel.y - sourceSize.y;
+      if (chromaLayout < 0.5) {
+        float planeRows = sourceSize.y * 0.25;
+        float plane = step(planeRows, row);
+        float halfWidth = sourceSize.x * 0.5;
+        float cy = (row - plane * planeRows) * 2.0 + step(halfWidth, x);
+        float sx = mod(x, halfWidth) * 2.0 + 1.0;
+        float sy = cy * 2.0 + 1.0;
+        vec4 u = vec4(chroma(vec2(sx, sy)).x, chroma(vec2(sx + 2.0, sy)).x,
+                      chroma(vec2(sx + 4.0, sy)).x,
+                      chroma(vec2(sx + 6.0, sy)).x);
+        vec4 v = vec4(chroma(vec2(sx, sy)).y, chroma(vec2(sx + 2.0, sy)).y,
+                      chroma(vec2(sx + 4.0, sy)).y,
+                      chroma(vec2(sx + 6.0, sy)).y);
+        gl_FragColor = mix(u, v, plane);
+      } else {
+        float sy = row * 2.0 + 1.0;
+        vec2 c0 = chroma(vec2(x + 1.0, sy));
+        vec2 c1 = chroma(vec2(x + 3.0, sy));
+        gl_FragColor = chromaLayout < 1.5 ? vec4(c0, c1) : vec4(c0.yx, c1.yx);
+      }
     })";
 #endif
 
@@ -50,9 +197,23 @@ std::shared_ptr<SinkRawData> SinkRawData::Create() {
 SinkRawData::SinkRawData() {
   InitWithShaderString(kRGBToI420VertexShaderString,
                        kRGBToI420FragmentShaderString);
+
+  yuv_program_ = GPUPixelGLProgram::CreateWithShaderString(
+      kYuvPackVertexShaderString, kYuvPackFragmentShaderString);
+  yuv_position_attribute_ = yuv_program_->GetAttribLocation("position");
+
+  frame_pool_ = FramePool::Create();
 }
 
 SinkRawData::~SinkRawData() {
+  GPUPixelContext::GetInstance()->SyncRunWithContext(
+      [=] { ReleaseAsyncReadback(); });
+
+  if (yuv_program_) {
+    delete yuv_program_;
+    yuv_program_ = nullptr;
+  }
+
   // Clean up RGBA frame buffer
   if (rgba_buffer_ != nullptr) {
     delete[] rgba_buffer_;
@@ -71,8 +232,17 @@ void SinkRawData::Render() {
     return;
   }
 
-  int width = input_framebuffers_[0].frame_buffer->GetWidth();
-  int height = input_framebuffers_[0].frame_buffer->GetHeight();
+  int input_width = input_framebuffers_[0].frame_buffer->GetWidth();
+  int input_height = input_framebuffers_[0].frame_buffer->GetHeight();
+
+  // Output defaults to the cropped input size
+  float crop_width = input_width * crop_rect_.width;
+  float crop_height = input_height * crop_rect_.height;
+  int width = output_width_ > 0 ? output_width_ : (int)(crop_width + 0.5f);
+  int height = output_height_ > 0 ? output_height_ : (int)(crop_height + 0.5f);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
   if (width_ != width || height_ != height) {
     width_ = width;
     height_ = height;
@@ -95,8 +265,12 @@ void SinkRawData::Render() {
       1.0,  1.0    // Top right
   };
 
+  float x0 = crop_rect_.x;
+  float y0 = crop_rect_.y;
+  float x1 = crop_rect_.x + crop_rect_.width;
+  float y1 = crop_rect_.y + crop_rect_.height;
   float texture_vertices[] = {
-      0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+      x0, y0, x1, y0, x0, y1, x1, y1,
   };
 
   GL_CALL(glEnableVertexAttribArray(position_attribute_));
@@ -112,10 +286,26 @@ void SinkRawData::Render() {
                 input_framebuffers_[0].frame_buffer->GetTexture());
 
   GL_CALL(shader_program_->SetUniformValue("sTexture", 0));
+  // Spread the taps over a quarter of the footprint per output pixel, so a
+  // 1:1 copy stays sharp and large reductions do not alias
+  float scale_x = crop_width / width_;
+  float scale_y = crop_height / height_;
+  Vector2 tap_offset(
+      scale_x > 1.0f ? 0.25f * scale_x / input_width : 0.0f,
+      scale_y > 1.0f ? 0.25f * scale_y / input_height : 0.0f);
+  shader_program_->SetUniformValue("tapOffset", tap_offset);
+  shader_program_->SetUniformValue(
+      "swapRedBlue", output_format_ == GPUPIXEL_FRAME_TYPE_BGRA ? 1.0f : 0.0f);
   // Draw frame buffer
   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
   framebuffer_->Deactivate();
+  frame_timestamp_ = input_framebuffers_[0].frame_buffer->GetTimestamp();
+
+  if (async_callback_) {
+    DeliverAsyncReadbacks(false);
+    IssueAsyncReadback(frame_timestamp_);
+  }
 }
 
 bool SinkRawData::InitWithShaderString(
@@ -132,14 +322,125 @@ bool SinkRawData::InitWithShaderString(
 }
 
 int SinkRawData::RenderToOutput() {
+  return RenderToOutput(rgba_buffer_, width_ * 4);
+}
+
+int SinkRawData::RenderToOutput(uint8_t* dst, int dst_stride) {
+  if (!framebuffer_) {
+    return -1;
+  }
   framebuffer_->Activate();
+  ReadPixels(0, 0, width_, height_, dst, dst_stride);
+  framebuffer_->Deactivate();
+  return 0;
+}
 
-  // Read pixel data directly using glReadPixels
-  GL_CALL(glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE,
+void SinkRawData::ReadPixels(int x,
+                             int y,
+                             int width,
+                             int height,
+                             uint8_t* dst,
+                             int dst_stride) {
+  int row_bytes = width * 4;
+  if (dst_stride == row_bytes) {
+    GL_CALL(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, dst));
+    return;
+  }
+#if defined(GPUPIXEL_GL3_API)
+  if (GPUPixelContext::GetInstance()->IsGL3Available() &&
+      dst_stride % 4 == 0) {
+    GL_CALL(glPixelStorei(GL_PACK_ROW_LENGTH, dst_stride / 4));
+    GL_CALL(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, dst));
+    GL_CALL(glPixelStorei(GL_PACK_ROW_LENGTH, 0));
+    return;
+  }
+#endif
+  // No pack row length on ES 2.0, go through the preallocated RGBA buffer
+  GL_CALL(glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
                        rgba_buffer_));
+  libyuv::CopyPlane(rgba_buffer_, row_bytes, dst, dst_stride, row_bytes,
+                    height);
+}
 
-  framebuffer_->Deactivate();
-  return 0;
+bool SinkRawData::ReadRgbaInto(uint8_t* dst,
+                               size_t dst_size,
+                               int dst_stride /* = 0*/) {
+  if (!dst) {
+    return false;
+  }
+  bool ok = false;
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (dst_stride == 0) {
+      dst_stride = width_ * 4;
+    }
+    size_t required = (size_t)dst_stride * (height_ - 1) + width_ * 4;
+    if (width_ > 0 && dst_stride >= width_ * 4 && dst_size >= required) {
+      ok = RenderToOutput(dst, dst_stride) == 0;
+    }
+  });
+  return ok;
+}
+
+bool SinkRawData::ReadYuvInto(uint8_t* dst,
+                              size_t dst_size,
+                              int y_stride /* = 0*/) {
+  if (!dst) {
+    return false;
+  }
+  bool ok = false;
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    if (y_stride == 0) {
+      y_stride = width_;
+    }
+    size_t required = (size_t)y_stride * height_ * 3 / 2;
+    if (width_ > 0 && y_stride >= width_ && y_stride % 2 == 0 &&
+        dst_size >= required) {
+      ok = RenderToYuvOutput(yuv_format_, dst, y_stride) == 0;
+    }
+  });
+  return ok;
+}
+
+std::shared_ptr<VideoFrame> SinkRawData::AcquireRgbaFrame() {
+  std::shared_ptr<VideoFrame> frame;
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    VideoFrame::Format format = output_format_ == GPUPIXEL_FRAME_TYPE_BGRA
+                                    ? VideoFrame::BGRA
+                                    : VideoFrame::RGBA;
+    frame = frame_pool_->Acquire(width_, height_, format);
+    if (!frame) {
+      return;
+    }
+    if (RenderToOutput(frame->GetData(), frame->GetStride()) != 0) {
+      frame = nullptr;
+      return;
+    }
+    frame->SetTimestamp(frame_timestamp_);
+  });
+  return frame;
+}
+
+std::shared_ptr<VideoFrame> SinkRawData::AcquireYuvFrame() {
+  std::shared_ptr<VideoFrame> frame;
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    static const VideoFrame::Format kFormats[] = {
+        VideoFrame::I420, VideoFrame::NV12, VideoFrame::NV21};
+    frame = frame_pool_->Acquire(width_, height_, kFormats[yuv_format_]);
+    if (!frame) {
+      return;
+    }
+    if (RenderToYuvOutput(yuv_format_, frame->GetData(), frame->GetStride()) !=
+        0) {
+      frame = nullptr;
+      return;
+    }
+    frame->SetTimestamp(frame_timestamp_);
+  });
+  return frame;
+}
+
+void SinkRawData::SetFramePoolDepth(int depth) {
+  frame_pool_->SetDepth(depth);
 }
 
 const uint8_t* SinkRawData::GetRgbaBuffer() {
@@ -150,17 +451,323 @@ const uint8_t* SinkRawData::GetRgbaBuffer() {
 
 const uint8_t* SinkRawData::GetI420Buffer() {
   gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext(
-      [=] { RenderToOutput(); });
-
-  // Convert RGBA to I420 format
-  libyuv::ARGBToI420(rgba_buffer_, width_ * 4, yuv_buffer_, width_,
-                     yuv_buffer_ + width_ * height_, width_ / 2,
-                     yuv_buffer_ + width_ * height_ * 5 / 4, width_ / 2, width_,
-                     height_);
+      [=] { RenderToYuvOutput(I420, yuv_buffer_, width_); });
+  return yuv_buffer_;
+}
 
+const uint8_t* SinkRawData::GetYuvBuffer() {
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext(
+      [=] { RenderToYuvOutput(yuv_format_, yuv_buffer_, width_); });
   return yuv_buffer_;
 }
 
+void SinkRawData::SetYuvFormat(YuvFormat format,
+                               YuvMatrix matrix /* = BT601*/,
+                               YuvRange range /* = LIMITED_RANGE*/) {
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([=] {
+    yuv_format_ = format;
+    yuv_matrix_ = matrix;
+    yuv_range_ = range;
+  });
+}
+
+int SinkRawData::RenderToYuvOutput(YuvFormat format,
+                                   uint8_t* dst,
+                                   int y_stride) {
+  if (!framebuffer_ || !dst) {
+    return -1;
+  }
+
+  // Chroma planes follow the luma plane; I420 planes use half the stride,
+  // NV12/NV21 interleaved rows use the full stride
+  uint8_t* dst_y = dst;
+  uint8_t* dst_uv = dst + y_stride * height_;
+  int uv_stride = format == I420 ? y_stride / 2 : y_stride;
+  uint8_t* dst_v = dst_uv + uv_stride * (height_ / 2);
+
+  int planar_alignment = format == I420 ? 4 : 2;
+  if (width_ % 8 != 0 || height_ % planar_alignment != 0) {
+    // Packed chroma rows would straddle texels, convert on the CPU instead.
+    // libyuv only provides BT.601 here, limited or full (JPEG) range.
+    // libyuv names formats by little-endian word order: RGBA bytes are
+    // "ABGR", BGRA bytes are "ARGB".
+    RenderToOutput();
+    bool full = yuv_range_ == FULL_RANGE;
+    bool bgra = output_format_ == GPUPIXEL_FRAME_TYPE_BGRA;
+    int stride = width_ * 4;
+    // Bands of row pairs so each band starts on a chroma row
+    ThreadPool::GetInstance()->ParallelFor(
+        (height_ + 1) / 2, 16, [&](int begin, int end) {
+          int y = begin * 2;
+          int rows = std::min(end * 2, height_) - y;
+          const uint8_t* src = rgba_buffer_ + (size_t)y * stride;
+          uint8_t* band_y = dst_y + (size_t)y * y_stride;
+          uint8_t* band_uv = dst_uv + (size_t)begin * uv_stride;
+          if (format == I420) {
+            auto convert =
+                full ? (bgra ? libyuv::ARGBToJ420 : libyuv::ABGRToJ420)
+                     : (bgra ? libyuv::ARGBToI420 : libyuv::ABGRToI420);
+            convert(src, stride, band_y, y_stride, band_uv, uv_stride,
+                    dst_v + (size_t)begin * uv_stride, uv_stride, width_,
+                    rows);
+          } else if (format == NV12) {
+            auto convert = bgra ? libyuv::ARGBToNV12 : libyuv::ABGRToNV12;
+            convert(src, stride, band_y, y_stride, band_uv, uv_stride, width_,
+                    rows);
+          } else {
+            auto convert = bgra ? libyuv::ARGBToNV21 : libyuv::ABGRToNV21;
+            convert(src, stride, band_y, y_stride, band_uv, uv_stride, width_,
+                    rows);
+          }
+        });
+    return 0;
+  }
+
+  int packed_width = width_ / 4;
+  int packed_height = height_ * 3 / 2;
+  if (!yuv_framebuffer_ || yuv_framebuffer_->GetWidth() != packed_width ||
+      yuv_framebuffer_->GetHeight() != packed_height) {
+    // Nearest filtering so every output texel is written exactly once
+    TextureAttributes attributes =
+        GPUPixelFramebuffer::default_texture_attributes;
+    attributes.minFilter = GL_NEAREST;
+    attributes.magFilter = GL_NEAREST;
+    yuv_framebuffer_ = GPUPixelContext::GetInstance()
+                           ->GetFramebufferFactory()
+                           ->CreateFramebuffer(packed_width, packed_height,
+                                               false, attributes);
+  }
+
+  // Kr/Kb of the selected matrix, scaled to the selected range
+  float kr = yuv_matrix_ == BT709 ? 0.2126f : 0.299f;
+  float kb = yuv_matrix_ == BT709 ? 0.0722f : 0.114f;
+  float kg = 1.0f - kr - kb;
+  bool full = yuv_range_ == FULL_RANGE;
+  float luma_scale = full ? 1.0f : 219.0f / 255.0f;
+  float chroma_scale = full ? 1.0f : 224.0f / 255.0f;
+  float u_scale = chroma_scale * 0.5f / (1.0f - kb);
+  float v_scale = chroma_scale * 0.5f / (1.0f - kr);
+  // Columns are the Y, U and V weights. The framebuffer holds BGRA when that
+  // output format is selected, so swap the red and blue weights to match.
+  float color_matrix[9] = {kr * luma_scale,  kg * luma_scale,
+                           kb * luma_scale,  -kr * u_scale,
+                           -kg * u_scale,    (1.0f - kb) * u_scale,
+                           (1.0f - kr) * v_scale, -kg * v_scale,
+                           -kb * v_scale};
+  if (output_format_ == GPUPIXEL_FRAME_TYPE_BGRA) {
+    for (int column = 0; column < 3; column++) {
+      std::swap(color_matrix[column * 3], color_matrix[column * 3 + 2]);
+    }
+  }
+
+  GPUPixelContext::GetInstance()->SetActiveGlProgram(yuv_program_);
+  yuv_framebuffer_->Activate();
+  GL_CALL(glViewport(0, 0, packed_width, packed_height));
+
+  static const float image_vertices[] = {
+      -1.0, -1.0,  // Bottom left
+      1.0,  -1.0,  // Bottom right
+      -1.0, 1.0,   // Top left
+      1.0,  1.0    // Top right
+  };
+  GL_CALL(glEnableVertexAttribArray(yuv_position_attribute_));
+  GL_CALL(glVertexAttribPointer(yuv_position_attribute_, 2, GL_FLOAT, 0, 0,
+                                image_vertices));
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, framebuffer_->GetTexture());
+
+  yuv_program_->SetUniformValue("sTexture", 0);
+  yuv_program_->SetUniformValue("sourceSize",
+                                Vector2((float)width_, (float)height_));
+  yuv_program_->SetUniformValue("chromaLayout", (float)format);
+  yuv_program_->SetUniformValue("colorMatrix", Matrix3(color_matrix));
+  yuv_program_->SetUniformValue("lumaOffset", full ? 0.0f : 16.0f / 255.0f);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+  // Each packed row is exactly |width_| bytes, so a tight destination takes
+  // the whole buffer in one read. Interleaved chroma rows keep the luma
+  // stride; planar chroma packs two rows per texel row and is split up from
+  // the YUV buffer when the stride is not tight.
+  if (y_stride == width_) {
+    GL_CALL(glReadPixels(0, 0, packed_width, packed_height, GL_RGBA,
+                         GL_UNSIGNED_BYTE, dst));
+  } else if (format != I420) {
+    ReadPixels(0, 0, packed_width, packed_height, dst, y_stride);
+  } else {
+    ReadPixels(0, 0, packed_width, height_, dst_y, y_stride);
+    uint8_t* packed_chroma = yuv_buffer_ + width_ * height_;
+    GL_CALL(glReadPixels(0, height_, packed_width, height_ / 2, GL_RGBA,
+                         GL_UNSIGNED_BYTE, packed_chroma));
+    int chroma_size = (width_ / 2) * (height_ / 2);
+    libyuv::CopyPlane(packed_chroma, width_ / 2, dst_uv, uv_stride,
+                      width_ / 2, height_ / 2);
+    libyuv::CopyPlane(packed_chroma + chroma_size, width_ / 2, dst_v,
+                      uv_stride, width_ / 2, height_ / 2);
+  }
+
+  yuv_framebuffer_->Deactivate();
+  return 0;
+}
+
+void SinkRawData::SetOutputSize(int width, int height) {
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([=] {
+    output_width_ = width > 0 ? width : 0;
+    output_height_ = height > 0 ? height : 0;
+  });
+}
+
+void SinkRawData::SetCropRect(float x, float y, float width, float height) {
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext([=] {
+    float left = std::min(std::max(x, 0.0f), 1.0f);
+    float top = std::min(std::max(y, 0.0f), 1.0f);
+    crop_rect_.x = left;
+    crop_rect_.y = top;
+    crop_rect_.width = std::min(std::max(width, 0.0f), 1.0f - left);
+    crop_rect_.height = std::min(std::max(height, 0.0f), 1.0f - top);
+  });
+}
+
+void SinkRawData::SetOutputFormat(GPUPIXEL_FRAME_TYPE format) {
+  if (format != GPUPIXEL_FRAME_TYPE_RGBA &&
+      format != GPUPIXEL_FRAME_TYPE_BGRA) {
+    LOG_ERROR("SinkRawData: output format must be RGBA or BGRA, use "
+              "GetYuvBuffer for YUV");
+    return;
+  }
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext(
+      [=] { output_format_ = format; });
+}
+
+void SinkRawData::EnableAsyncReadback(RgbaFrameCallback callback,
+                                      int ring_size /* = 3*/) {
+  GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    ReleaseAsyncReadback();
+    async_callback_ = callback;
+    readback_ring_.resize(ring_size < 1 ? 1 : ring_size);
+  });
+}
+
+void SinkRawData::DisableAsyncReadback() {
+  GPUPixelContext::GetInstance()->SyncRunWithContext([=] {
+    DeliverAsyncReadbacks(true);
+    ReleaseAsyncReadback();
+  });
+}
+
+void SinkRawData::PollAsyncReadback() {
+  GPUPixelContext::GetInstance()->SyncRunWithContext(
+      [=] { DeliverAsyncReadbacks(false); });
+}
+
+void SinkRawData::FlushAsyncReadback() {
+  GPUPixelContext::GetInstance()->SyncRunWithContext(
+      [=] { DeliverAsyncReadbacks(true); });
+}
+
+void SinkRawData::IssueAsyncReadback(int64_t timestamp) {
+#if defined(GPUPIXEL_GL3_API)
+  if (GPUPixelContext::GetInstance()->IsGL3Available()) {
+    int ring_size = static_cast<int>(readback_ring_.size());
+    if (readback_count_ == ring_size) {
+      // Ring is full, only the oldest readback has to complete before its
+      // buffer can be reused, the newer ones stay in flight
+      DeliverOldestReadback(true);
+    }
+
+    PendingReadback& slot =
+        readback_ring_[(readback_head_ + readback_count_) % ring_size];
+    size_t size = (size_t)width_ * height_ * 4;
+    if (slot.buffer == 0) {
+      GL_CALL(glGenBuffers(1, &slot.buffer));
+    }
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+    if (slot.size != size) {
+      GL_CALL(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr,
+                           GL_STREAM_READ));
+      slot.size = size;
+    }
+
+    framebuffer_->Activate();
+    GL_CALL(glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, 0));
+    framebuffer_->Deactivate();
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width_;
+    slot.height = height_;
+    slot.timestamp = timestamp;
+    readback_count_++;
+
+    // Make sure the fence reaches the GPU so polling can observe it
+    GL_CALL(glFlush());
+    return;
+  }
+#endif
+  RenderToOutput();
+  async_callback_(rgba_buffer_, width_, height_, timestamp);
+}
+
+void SinkRawData::DeliverAsyncReadbacks(bool wait) {
+  while (DeliverOldestReadback(wait)) {
+  }
+}
+
+bool SinkRawData::DeliverOldestReadback(bool wait) {
+#if defined(GPUPIXEL_GL3_API)
+  if (readback_count_ == 0) {
+    return false;
+  }
+  PendingReadback& slot = readback_ring_[readback_head_];
+  GLsync fence = static_cast<GLsync>(slot.fence);
+  GLenum status = glClientWaitSync(fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                   wait ? GL_TIMEOUT_IGNORED : 0);
+  if (status == GL_TIMEOUT_EXPIRED) {
+    return false;
+  }
+  glDeleteSync(fence);
+  slot.fence = nullptr;
+
+  if (status == GL_WAIT_FAILED) {
+    LOG_ERROR("SinkRawData: readback fence wait failed, dropping frame");
+  } else {
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer));
+    const uint8_t* rgba = static_cast<const uint8_t*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT));
+    if (rgba) {
+      async_callback_(rgba, slot.width, slot.height, slot.timestamp);
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    } else {
+      LOG_ERROR("SinkRawData: failed to map pixel pack buffer");
+    }
+    GL_CALL(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+  }
+
+  readback_head_ = (readback_head_ + 1) % readback_ring_.size();
+  readback_count_--;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SinkRawData::ReleaseAsyncReadback() {
+#if defined(GPUPIXEL_GL3_API)
+  for (auto& slot : readback_ring_) {
+    if (slot.fence) {
+      glDeleteSync(static_cast<GLsync>(slot.fence));
+    }
+    if (slot.buffer) {
+      GL_CALL(glDeleteBuffers(1, &slot.buffer));
+    }
+  }
+#endif
+  readback_ring_.clear();
+  readback_head_ = 0;
+  readback_count_ = 0;
+  async_callback_ = nullptr;
+}
+
 void SinkRawData::InitOutputBuffer(int width, int height) {
   uint32_t rgba_size = width * height * 4;
   uint32_t yuv_size = width * height * 3 / 2;
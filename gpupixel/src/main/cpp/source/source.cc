@@ -5,11 +5,17 @@
  */
 
 #include "gpupixel/source/source.h"
+#include <atomic>
 #include "core/gpupixel_context.h"
 #include "utils/util.h"
 
 namespace gpupixel {
 
+namespace {
+// Starts above 0 so a cache that was never filled is always stale
+std::atomic<uint64_t> graph_version(1);
+}  // namespace
+
 Source::Source()
     : framebuffer_(0),
       output_rotation_(RotationMode::NoRotation),
@@ -29,6 +35,7 @@ std::shared_ptr<Source> Source::AddSink(std::shared_ptr<Sink> sink,
   if (!HasSink(sink)) {
     sinks_[sink] = texIdx;
     sink->SetInputFramebuffer(framebuffer_, RotationMode::NoRotation, texIdx);
+    GraphChanged();
   }
   return std::dynamic_pointer_cast<Source>(sink);
 }
@@ -45,11 +52,13 @@ void Source::RemoveSink(std::shared_ptr<Sink> sink) {
   auto itr = sinks_.find(sink);
   if (itr != sinks_.end()) {
     sinks_.erase(itr);
+    GraphChanged();
   }
 }
 
 void Source::RemoveAllSinks() {
   sinks_.clear();
+  GraphChanged();
 }
 
 bool Source::DoRender(bool updateSinks) {
@@ -107,4 +116,12 @@ std::shared_ptr<GPUPixelFramebuffer> Source::GetFramebuffer() const {
 
 void Source::ReleaseFramebuffer(bool returnToCache /* = true*/) {}
 
+uint64_t Source::GetGraphVersion() {
+  return graph_version.load();
+}
+
+void Source::GraphChanged() {
+  graph_version++;
+}
+
 }  // namespace gpupixel
@@ -6,8 +6,13 @@
 
 #include "gpupixel/source/source_image.h"
 #include <cassert>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include "core/gpupixel_context.h"
 #include "utils/logging.h"
+#include "utils/thread_pool.h"
 #include "utils/util.h"
 
 #if defined(GPUPIXEL_ANDROID)
@@ -20,6 +25,107 @@
 
 namespace gpupixel {
 
+namespace {
+// Header of a decoded RGBA file, followed by width * height * 4 bytes
+struct DecodedHeader {
+  char magic[4];
+  uint32_t width;
+  uint32_t height;
+  uint32_t reserved;
+  uint64_t content_hash;
+};
+constexpr char kDecodedMagic[4] = {'G', 'P', 'X', 'R'};
+
+// Images shared by CreateShared, keyed by the hash of the file content
+struct ImageCache {
+  struct FileKey {
+    uintmax_t size;
+    fs::file_time_type time;
+    uint64_t content_hash;
+  };
+  std::mutex mutex;
+  // Saves reading and hashing a file again while it is unchanged
+  std::map<std::string, FileKey> files;
+  std::map<uint64_t, std::weak_ptr<SourceImage>> images;
+  std::string decoded_directory;
+};
+
+ImageCache& GetImageCache() {
+  static ImageCache cache;
+  return cache;
+}
+
+// FNV-1a
+uint64_t HashBytes(const std::vector<unsigned char>& bytes) {
+  uint64_t hash = 14695981039346656037ull;
+  for (unsigned char byte : bytes) {
+    hash = (hash ^ byte) * 1099511628211ull;
+  }
+  return hash;
+}
+
+bool ReadFile(const std::string& path, std::vector<unsigned char>* bytes) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  bytes->resize((size_t)file.tellg());
+  file.seekg(0);
+  return (bool)file.read((char*)bytes->data(), bytes->size());
+}
+
+std::string DecodedPath(const std::string& directory, uint64_t hash) {
+  return (fs::path(directory) /
+          Util::StringFormat("%016llx.rgba", (unsigned long long)hash))
+      .string();
+}
+
+bool ReadDecoded(const std::string& path,
+                 uint64_t hash,
+                 int* width,
+                 int* height,
+                 std::vector<unsigned char>* pixels) {
+  std::ifstream file(path, std::ios::binary);
+  DecodedHeader header;
+  if (!file || !file.read((char*)&header, sizeof(header)) ||
+      memcmp(header.magic, kDecodedMagic, sizeof(kDecodedMagic)) != 0 ||
+      header.content_hash != hash || header.width == 0 || header.height == 0) {
+    return false;
+  }
+  *width = (int)header.width;
+  *height = (int)header.height;
+  pixels->resize((size_t)header.width * header.height * 4);
+  return (bool)file.read((char*)pixels->data(), pixels->size());
+}
+
+void WriteDecoded(const std::string& path,
+                  uint64_t hash,
+                  int width,
+                  int height,
+                  const unsigned char* pixels) {
+  DecodedHeader header = {};
+  memcpy(header.magic, kDecodedMagic, sizeof(kDecodedMagic));
+  header.width = (uint32_t)width;
+  header.height = (uint32_t)height;
+  header.content_hash = hash;
+  // Renamed into place, so a reader never sees a partial file
+  std::string temp_path = path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.write((const char*)&header, sizeof(header)) ||
+        !file.write((const char*)pixels, (size_t)width * height * 4)) {
+      LOG_WARN("SourceImage: cannot write decoded image {}", temp_path);
+      return;
+    }
+  }
+  std::error_code error;
+  fs::rename(temp_path, path, error);
+  if (error) {
+    LOG_WARN("SourceImage: cannot write decoded image {}", path);
+  }
+}
+}  // namespace
+
 std::shared_ptr<SourceImage> SourceImage::CreateFromBuffer(
     int width,
     int height,
@@ -52,10 +158,111 @@ std::shared_ptr<SourceImage> SourceImage::Create(const std::string path) {
   return image;
 }
 
+std::shared_ptr<SourceImage> SourceImage::CreateShared(
+    const std::string& path) {
+  ImageCache& cache = GetImageCache();
+  std::error_code error;
+  uintmax_t size = fs::file_size(path, error);
+  fs::file_time_type time = fs::last_write_time(path, error);
+  if (error) {
+    LOG_ERROR("SourceImage: image path not found: {}", path);
+    return nullptr;
+  }
+
+  uint64_t hash = 0;
+  bool hashed = false;
+  std::string decoded_directory;
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto file = cache.files.find(path);
+    if (file != cache.files.end() && file->second.size == size &&
+        file->second.time == time) {
+      hash = file->second.content_hash;
+      hashed = true;
+      auto image = cache.images.find(hash);
+      if (image != cache.images.end()) {
+        if (auto shared = image->second.lock()) {
+          return shared;
+        }
+      }
+    }
+    decoded_directory = cache.decoded_directory;
+  }
+
+  // Decoded and uploaded without the lock, the upload waits for the GL
+  // thread, which may be asking the cache for another image
+  std::vector<unsigned char> bytes;
+  if (!hashed) {
+    if (!ReadFile(path, &bytes)) {
+      LOG_ERROR("SourceImage: cannot read image {}", path);
+      return nullptr;
+    }
+    hash = HashBytes(bytes);
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.files[path] = ImageCache::FileKey{size, time, hash};
+    // The same content under another path
+    auto image = cache.images.find(hash);
+    if (image != cache.images.end()) {
+      if (auto shared = image->second.lock()) {
+        return shared;
+      }
+    }
+  }
+
+  int width = 0;
+  int height = 0;
+  std::vector<unsigned char> decoded;
+  std::string decoded_path;
+  if (!decoded_directory.empty()) {
+    decoded_path = DecodedPath(decoded_directory, hash);
+  }
+  if (decoded_path.empty() ||
+      !ReadDecoded(decoded_path, hash, &width, &height, &decoded)) {
+    if (bytes.empty() && !ReadFile(path, &bytes)) {
+      LOG_ERROR("SourceImage: cannot read image {}", path);
+      return nullptr;
+    }
+    int channel_count;
+    unsigned char* data =
+        stbi_load_from_memory(bytes.data(), (int)bytes.size(), &width, &height,
+                              &channel_count, 4);
+    if (data == nullptr) {
+      LOG_ERROR("stbi_load create image failed! file path: {}", path);
+      return nullptr;
+    }
+    decoded.assign(data, data + (size_t)width * height * 4);
+    stbi_image_free(data);
+    if (!decoded_path.empty()) {
+      WriteDecoded(decoded_path, hash, width, height, decoded.data());
+    }
+  }
+  LOG_INFO("create shared source image path: {}", path);
+
+  auto image = std::shared_ptr<SourceImage>(new SourceImage());
+  gpupixel::GPUPixelContext::GetInstance()->SyncRunWithContext(
+      [&] { image->Init(width, height, 4, decoded.data(), false); });
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  // Another thread may have uploaded the same image meanwhile
+  auto& entry = cache.images[hash];
+  if (auto shared = entry.lock()) {
+    return shared;
+  }
+  entry = image;
+  return image;
+}
+
+void SourceImage::SetDecodedCacheDirectory(const std::string& directory) {
+  ImageCache& cache = GetImageCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.decoded_directory = directory;
+}
+
 void SourceImage::Init(int width,
                        int height,
                        int channel_count,
-                       const unsigned char* pixels) {
+                       const unsigned char* pixels,
+                       bool keep_cpu_copy /* = true*/) {
   this->SetFramebuffer(0);
   if (!framebuffer_ || (framebuffer_->GetWidth() != width ||
                         framebuffer_->GetHeight() != height)) {
@@ -68,7 +275,18 @@ void SourceImage::Init(int width,
 
   GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
                        GL_UNSIGNED_BYTE, pixels));
-  image_bytes_.assign(pixels, pixels + width * height * 4);
+  // Keep a CPU copy, split across the worker pool for large images
+  size_t row_bytes = (size_t)width * 4;
+  std::lock_guard<std::mutex> lock(image_bytes_mutex_);
+  image_bytes_.clear();
+  if (keep_cpu_copy) {
+    image_bytes_.resize(row_bytes * height);
+    ThreadPool::GetInstance()->ParallelFor(
+        height, 64, [&](int begin, int end) {
+          memcpy(image_bytes_.data() + begin * row_bytes,
+                 pixels + begin * row_bytes, (end - begin) * row_bytes);
+        });
+  }
 
   GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
 }
@@ -79,6 +297,37 @@ void SourceImage::Render() {
 }
 
 const unsigned char* SourceImage::GetRgbaImageBuffer() const {
+  {
+    std::lock_guard<std::mutex> lock(image_bytes_mutex_);
+    if (!image_bytes_.empty() || !framebuffer_) {
+      return image_bytes_.empty() ? nullptr : image_bytes_.data();
+    }
+  }
+
+  // Read back without the lock, the GL thread may be asking for the pixels
+  // of this image too
+  auto framebuffer = framebuffer_;
+  int width = framebuffer->GetWidth();
+  int height = framebuffer->GetHeight();
+  std::vector<unsigned char> bytes((size_t)width * height * 4);
+  GPUPixelContext::GetInstance()->SyncRunWithContext([&] {
+    // The texture has no framebuffer of its own
+    GLuint read_framebuffer = 0;
+    GL_CALL(glGenFramebuffers(1, &read_framebuffer));
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, read_framebuffer));
+    GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                   GL_TEXTURE_2D, framebuffer->GetTexture(),
+                                   0));
+    GL_CALL(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                         bytes.data()));
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CALL(glDeleteFramebuffers(1, &read_framebuffer));
+  });
+
+  std::lock_guard<std::mutex> lock(image_bytes_mutex_);
+  if (image_bytes_.empty()) {
+    image_bytes_.swap(bytes);
+  }
   return image_bytes_.data();
 }
 
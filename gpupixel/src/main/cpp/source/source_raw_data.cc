@@ -5,6 +5,7 @@
  */
 
 #include "gpupixel/source/source_raw_data.h"
+#include <cstring>
 #include "core/gpupixel_context.h"
 #include "utils/util.h"
 
@@ -82,8 +83,14 @@ std::shared_ptr<SourceRawData> SourceRawData::Create() {
 SourceRawData::SourceRawData() {}
 
 SourceRawData::~SourceRawData() {
-  GPUPixelContext::GetInstance()->SyncRunWithContext(
-      [=] { glDeleteTextures(4, textures_); });
+  GPUPixelContext::GetInstance()->SyncRunWithContext([=] {
+    glDeleteTextures(4, textures_);
+#if defined(GPUPIXEL_GL3_API)
+    if (pixel_unpack_buffers_[0] != 0) {
+      glDeleteBuffers(kPixelUnpackBufferCount, pixel_unpack_buffers_);
+    }
+#endif
+  });
 }
 
 bool SourceRawData::Init() {
@@ -117,12 +124,56 @@ void SourceRawData::SetRotation(RotationMode rotation) {
   rotation_ = rotation;
 }
 
+RotationMode SourceRawData::RotationModeFromDegrees(int rotation,
+                                                    bool mirror) {
+  // The combined modes flip the source before rotating it, so mirroring the
+  // rotated output horizontally maps onto the perpendicular flip.
+  switch (((rotation % 360) + 360) % 360) {
+    case 90:
+      return mirror ? RotateRightFlipVertical : RotateRight;
+    case 180:
+      return mirror ? FlipVertical : Rotate180;
+    case 270:
+      return mirror ? RotateRightFlipHorizontal : RotateLeft;
+    default:
+      return mirror ? FlipHorizontal : NoRotation;
+  }
+}
+
 void SourceRawData::ProcessData(const uint8_t* data,
                                 int width,
                                 int height,
                                 int stride,
                                 GPUPIXEL_FRAME_TYPE type) {
+  ProcessData(data, width, height, stride, type, rotation_, -1);
+}
+
+void SourceRawData::ProcessData(const uint8_t* data,
+                                int width,
+                                int height,
+                                int stride,
+                                GPUPIXEL_FRAME_TYPE type,
+                                int rotation,
+                                bool mirror,
+                                int64_t timestamp /* = -1*/) {
+  ProcessData(data, width, height, stride, type,
+              RotationModeFromDegrees(rotation, mirror), timestamp);
+}
+
+void SourceRawData::ProcessData(const uint8_t* data,
+                                int width,
+                                int height,
+                                int stride,
+                                GPUPIXEL_FRAME_TYPE type,
+                                RotationMode rotation,
+                                int64_t timestamp) {
+  if (type != GPUPIXEL_FRAME_TYPE_YUVI420 && type != GPUPIXEL_FRAME_TYPE_RGBA &&
+      type != GPUPIXEL_FRAME_TYPE_BGRA) {
+    LOG_ERROR("SourceRawData: unsupported frame type {}", (int)type);
+    return;
+  }
   GPUPixelContext::GetInstance()->SyncRunWithContext([=] {
+    frame_timestamp_ = timestamp < 0 ? Util::NowTimeUs() : timestamp;
     if (type == GPUPIXEL_FRAME_TYPE_YUVI420) {
       // Calculate the starting pointers and strides for each YUV channel
       const uint8_t* dataY = data;  // Y channel start position
@@ -137,14 +188,35 @@ void SourceRawData::ProcessData(const uint8_t* data,
       int strideV = width / 2;  // V channel stride is half the width
 
       GenerateTextureWithI420(width, height, dataY, strideY, dataU, strideU,
-                              dataV, strideV);
+                              dataV, strideV, rotation);
 
     } else {
-      GenerateTextureWithPixels(data, width, height, stride, type);
+      GenerateTextureWithPixels(data, width, height, stride, type, rotation);
     }
   });
 }
 
+void SourceRawData::PrepareFramebuffer(int width,
+                                       int height,
+                                       RotationMode rotation) {
+  int output_width = width;
+  int output_height = height;
+  if (rotationSwapsSize(rotation)) {
+    output_width = height;
+    output_height = width;
+  }
+
+  if (!framebuffer_ || (framebuffer_->GetWidth() != output_width ||
+                        framebuffer_->GetHeight() != output_height)) {
+    framebuffer_ = GPUPixelContext::GetInstance()
+                       ->GetFramebufferFactory()
+                       ->CreateFramebuffer(output_width, output_height);
+  }
+
+  framebuffer_->SetTimestamp(frame_timestamp_);
+  this->SetFramebuffer(framebuffer_, NoRotation);
+}
+
 int SourceRawData::GenerateTextureWithI420(int width,
                                            int height,
                                            const uint8_t* dataY,
@@ -152,15 +224,9 @@ int SourceRawData::GenerateTextureWithI420(int width,
                                            const uint8_t* dataU,
                                            int strideU,
                                            const uint8_t* dataV,
-                                           int strideV) {
-  if (!framebuffer_ || (framebuffer_->GetWidth() != width ||
-                        framebuffer_->GetHeight() != height)) {
-    framebuffer_ = GPUPixelContext::GetInstance()
-                       ->GetFramebufferFactory()
-                       ->CreateFramebuffer(width, height);
-  }
-
-  this->SetFramebuffer(framebuffer_, NoRotation);
+                                           int strideV,
+                                           RotationMode rotation) {
+  PrepareFramebuffer(width, height, rotation);
 
   GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program_);
   this->GetFramebuffer()->Activate();
@@ -178,7 +244,7 @@ int SourceRawData::GenerateTextureWithI420(int width,
 
   GL_CALL(glEnableVertexAttribArray(filter_tex_coord_attribute_));
   GL_CALL(glVertexAttribPointer(filter_tex_coord_attribute_, 2, GL_FLOAT, 0, 0,
-                                GetTextureCoordinate(rotation_)));
+                                GetTextureCoordinate(rotation)));
 
   filter_program_->SetUniformValue("yTexture", 0);
   filter_program_->SetUniformValue("uTexture", 1);
@@ -187,13 +253,26 @@ int SourceRawData::GenerateTextureWithI420(int width,
   const uint8_t* pixels[3] = {dataY, dataU, dataV};
   const int widths[3] = {width, width / 2, width / 2};
   const int heights[3] = {height, height / 2, height / 2};
+  const size_t sizes[3] = {(size_t)width * height,
+                           (size_t)(width / 2) * (height / 2),
+                           (size_t)(width / 2) * (height / 2)};
 
+  int64_t upload_start_us = Util::NowTimeUs();
+  for (int i = 0; i < 3; ++i) {
+    EnsureTextureStorage(i, widths[i], heights[i], GL_LUMINANCE);
+  }
+
+  bool staged = BeginStagedUpload(pixels, sizes, 3);
   for (int i = 0; i < 3; ++i) {
     glActiveTexture(GL_TEXTURE0 + i);
     glBindTexture(GL_TEXTURE_2D, textures_[i]);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, widths[i], heights[i], 0,
-                 GL_LUMINANCE, GL_UNSIGNED_BYTE, pixels[i]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, widths[i], heights[i],
+                    GL_LUMINANCE, GL_UNSIGNED_BYTE, pixels[i]);
+  }
+  if (staged) {
+    EndStagedUpload();
   }
+  RecordUploadTime(Util::NowTimeUs() - upload_start_us, staged);
 
   filter_program_->SetUniformValue("texture_type", 0);
   // draw frame buffer
@@ -208,28 +287,37 @@ int SourceRawData::GenerateTextureWithPixels(const uint8_t* pixels,
                                              int width,
                                              int height,
                                              int stride,
-                                             GPUPIXEL_FRAME_TYPE type) {
-  if (!framebuffer_ || (framebuffer_->GetWidth() != stride / 4 ||
-                        framebuffer_->GetHeight() != height)) {
-    framebuffer_ = GPUPixelContext::GetInstance()
-                       ->GetFramebufferFactory()
-                       ->CreateFramebuffer(stride / 4, height);
-  }
-  this->SetFramebuffer(framebuffer_, NoRotation);
+                                             GPUPIXEL_FRAME_TYPE type,
+                                             RotationMode rotation) {
+  PrepareFramebuffer(stride / 4, height, rotation);
 
   uint32_t texture = textures_[3];
+  int texture_width = stride / 4;
 
-  GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
+  int64_t upload_start_us = Util::NowTimeUs();
+  EnsureTextureStorage(3, texture_width, height, GL_RGBA);
+
+  const uint8_t* planes[1] = {pixels};
+  const size_t sizes[1] = {(size_t)stride * height};
+  bool staged = false;
 
   if (type == GPUPIXEL_FRAME_TYPE_BGRA) {
 #if defined(GPUPIXEL_IOS) || defined(GPUPIXEL_MAC)
-    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, stride / 4, height, 0,
-                         GL_BGRA, GL_UNSIGNED_BYTE, pixels));
+    staged = BeginStagedUpload(planes, sizes, 1);
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
+    GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture_width, height,
+                            GL_BGRA, GL_UNSIGNED_BYTE, planes[0]));
 #endif
   } else if (type == GPUPIXEL_FRAME_TYPE_RGBA) {
-    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, stride / 4, height, 0,
-                         GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+    staged = BeginStagedUpload(planes, sizes, 1);
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
+    GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture_width, height,
+                            GL_RGBA, GL_UNSIGNED_BYTE, planes[0]));
+  }
+  if (staged) {
+    EndStagedUpload();
   }
+  RecordUploadTime(Util::NowTimeUs() - upload_start_us, staged);
 
   GPUPixelContext::GetInstance()->SetActiveGlProgram(filter_program_);
   this->GetFramebuffer()->Activate();
@@ -246,7 +334,7 @@ int SourceRawData::GenerateTextureWithPixels(const uint8_t* pixels,
 
   GL_CALL(glEnableVertexAttribArray(filter_tex_coord_attribute_));
   GL_CALL(glVertexAttribPointer(filter_tex_coord_attribute_, 2, GL_FLOAT, 0, 0,
-                                GetTextureCoordinate(rotation_)));
+                                GetTextureCoordinate(rotation)));
 
   GL_CALL(glActiveTexture(GL_TEXTURE4));
   GL_CALL(glBindTexture(GL_TEXTURE_2D, texture));
@@ -260,4 +348,104 @@ int SourceRawData::GenerateTextureWithPixels(const uint8_t* pixels,
   return 0;
 }
 
+void SourceRawData::EnsureTextureStorage(int index,
+                                         int width,
+                                         int height,
+                                         uint32_t format) {
+  if (texture_widths_[index] == width && texture_heights_[index] == height) {
+    return;
+  }
+  // Storage is (re)allocated only on size changes, frames are streamed in
+  // with glTexSubImage2D
+  GL_CALL(glBindTexture(GL_TEXTURE_2D, textures_[index]));
+  GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format,
+                       GL_UNSIGNED_BYTE, nullptr));
+  texture_widths_[index] = width;
+  texture_heights_[index] = height;
+}
+
+bool SourceRawData::BeginStagedUpload(const uint8_t** planes,
+                                      const size_t* sizes,
+                                      int count) {
+#if defined(GPUPIXEL_GL3_API)
+  if (!GPUPixelContext::GetInstance()->IsGL3Available()) {
+    return false;
+  }
+
+  size_t total_size = 0;
+  for (int i = 0; i < count; ++i) {
+    total_size += sizes[i];
+  }
+
+  if (pixel_unpack_buffers_[0] == 0) {
+    GL_CALL(glGenBuffers(kPixelUnpackBufferCount, pixel_unpack_buffers_));
+  }
+
+  // Cycle through the ring so the buffer being filled is not the one the
+  // driver may still be copying from
+  int index = pixel_unpack_buffer_index_;
+  pixel_unpack_buffer_index_ = (index + 1) % kPixelUnpackBufferCount;
+
+  GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_unpack_buffers_[index]));
+  if (pixel_unpack_buffer_sizes_[index] != total_size) {
+    GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, total_size, nullptr,
+                         GL_STREAM_DRAW));
+    pixel_unpack_buffer_sizes_[index] = total_size;
+  }
+
+  uint8_t* mapped = static_cast<uint8_t*>(
+      glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total_size,
+                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (!mapped) {
+    LOG_WARN("SourceRawData: failed to map pixel unpack buffer");
+    GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    return false;
+  }
+
+  size_t offset = 0;
+  for (int i = 0; i < count; ++i) {
+    std::memcpy(mapped + offset, planes[i], sizes[i]);
+    offset += sizes[i];
+  }
+
+  if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+    // Buffer contents were lost, upload from client memory instead
+    GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    return false;
+  }
+
+  offset = 0;
+  for (int i = 0; i < count; ++i) {
+    planes[i] = reinterpret_cast<const uint8_t*>(offset);
+    offset += sizes[i];
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+void SourceRawData::EndStagedUpload() {
+#if defined(GPUPIXEL_GL3_API)
+  GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+#endif
+}
+
+void SourceRawData::RecordUploadTime(int64_t upload_us, bool staged) {
+  std::unique_lock<std::mutex> lock(stats_mutex_);
+  upload_stats_.frame_count++;
+  upload_stats_.last_upload_us = upload_us;
+  upload_stats_.pixel_buffer_enabled = staged;
+  total_upload_us_ += upload_us;
+}
+
+SourceRawData::UploadStats SourceRawData::GetUploadStats() {
+  std::unique_lock<std::mutex> lock(stats_mutex_);
+  UploadStats stats = upload_stats_;
+  if (stats.frame_count > 0) {
+    stats.average_upload_us = total_upload_us_ / stats.frame_count;
+  }
+  return stats;
+}
+
 }  // namespace gpupixel
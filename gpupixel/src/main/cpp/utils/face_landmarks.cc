@@ -0,0 +1,85 @@
+/*
+ * GPUPixel
+ *
+ * Created by PixPark on 2021/6/24.
+ * Copyright © 2021 PixPark. All rights reserved.
+ */
+
+#include "gpupixel/utils/face_landmarks.h"
+#include <algorithm>
+#include <cstring>
+
+namespace gpupixel {
+
+constexpr int FaceLandmarks::kMaxFaces;
+constexpr int FaceLandmarks::kPointCount;
+
+size_t FaceLandmarks::ToInterleaved(float* dst, size_t capacity) const {
+  size_t written = 0;
+  for (int face = 0; face < face_count; face++) {
+    for (int i = 0; i < kPointCount; i++) {
+      if (written + 2 > capacity) {
+        return written;
+      }
+      dst[written++] = faces[face].x[i];
+      dst[written++] = faces[face].y[i];
+    }
+  }
+  return written;
+}
+
+void FaceLandmarks::FromInterleaved(const float* src, size_t count) {
+  size_t face_floats = kPointCount * 2;
+  if (count >= face_floats) {
+    face_count = std::min((int)(count / face_floats), kMaxFaces);
+  } else {
+    face_count = count >= 2 ? 1 : 0;
+  }
+
+  for (int face = 0; face < face_count; face++) {
+    Face& dst = faces[face];
+    const float* points = src + face * face_floats;
+    size_t point_count = std::min(face_floats, count - face * face_floats) / 2;
+    for (size_t i = 0; i < point_count; i++) {
+      dst.x[i] = points[i * 2];
+      dst.y[i] = points[i * 2 + 1];
+    }
+    for (size_t i = point_count; i < (size_t)kPointCount; i++) {
+      dst.x[i] = 0;
+      dst.y[i] = 0;
+    }
+    // Boxes and poses are not part of the interleaved layout
+    dst.face_id = face;
+    dst.score = 1;
+    dst.rect[0] = *std::min_element(dst.x, dst.x + point_count);
+    dst.rect[1] = *std::min_element(dst.y, dst.y + point_count);
+    dst.rect[2] = *std::max_element(dst.x, dst.x + point_count);
+    dst.rect[3] = *std::max_element(dst.y, dst.y + point_count);
+    dst.pitch = dst.yaw = dst.roll = 0;
+  }
+}
+
+std::shared_ptr<FaceLandmarksPool> FaceLandmarksPool::Create(
+    int depth /* = 4*/) {
+  return std::shared_ptr<FaceLandmarksPool>(new FaceLandmarksPool(depth));
+}
+
+FaceLandmarksPool::FaceLandmarksPool(int depth) {
+  for (int i = 0; i < std::max(depth, 1); i++) {
+    slots_.push_back(std::make_shared<FaceLandmarks>());
+  }
+}
+
+std::shared_ptr<FaceLandmarks> FaceLandmarksPool::Acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A slot only the pool holds cannot be reached by anyone else
+  for (auto& slot : slots_) {
+    if (slot.use_count() == 1) {
+      return slot;
+    }
+  }
+  slots_.push_back(std::make_shared<FaceLandmarks>());
+  return slots_.back();
+}
+
+}  // namespace gpupixel
@@ -0,0 +1,127 @@
+/*
+ * GPUPixel
+ *
+ * Created by PixPark on 2021/6/24.
+ * Copyright © 2021 PixPark. All rights reserved.
+ */
+
+#include "gpupixel/utils/frame_pool.h"
+
+namespace gpupixel {
+
+std::shared_ptr<FramePool> FramePool::Create(int depth /* = 3*/) {
+  return std::shared_ptr<FramePool>(new FramePool(depth));
+}
+
+FramePool::FramePool(int depth) : state_(std::make_shared<State>()) {
+  state_->depth = depth > 0 ? depth : 1;
+}
+
+FramePool::~FramePool() {}
+
+size_t FramePool::FrameSize(int width,
+                            int height,
+                            VideoFrame::Format format,
+                            int& stride) {
+  bool packed_rgb = format == VideoFrame::RGBA || format == VideoFrame::BGRA;
+  int row_bytes = packed_rgb ? width * 4 : width;
+  if (stride < row_bytes) {
+    stride = row_bytes;
+  }
+  if (packed_rgb) {
+    return (size_t)stride * height;
+  }
+  // Luma plane plus two quarter-size chroma planes or one interleaved plane
+  return (size_t)stride * height + (size_t)stride * ((height + 1) / 2);
+}
+
+std::shared_ptr<VideoFrame> FramePool::Acquire(int width,
+                                               int height,
+                                               VideoFrame::Format format,
+                                               int stride /* = 0*/) {
+  if (width <= 0 || height <= 0) {
+    return nullptr;
+  }
+  size_t size = FrameSize(width, height, format, stride);
+
+  std::unique_ptr<uint8_t[]> buffer;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->leased >= state_->depth) {
+      return nullptr;
+    }
+    state_->leased++;
+
+    // Any cached buffer of the right size will do
+    for (size_t i = 0; i < state_->free_buffers.size(); i++) {
+      if (state_->free_sizes[i] == size) {
+        buffer = std::move(state_->free_buffers[i]);
+        state_->free_buffers.erase(state_->free_buffers.begin() + i);
+        state_->free_sizes.erase(state_->free_sizes.begin() + i);
+        break;
+      }
+    }
+    // The frame size changed, cached buffers of the old size are stale
+    if (!buffer) {
+      state_->free_buffers.clear();
+      state_->free_sizes.clear();
+    }
+  }
+
+  if (!buffer) {
+    buffer.reset(new uint8_t[size]);
+  }
+
+  VideoFrame* frame = new VideoFrame();
+  frame->data_ = buffer.release();
+  frame->size_ = size;
+  frame->width_ = width;
+  frame->height_ = height;
+  frame->stride_ = stride;
+  frame->format_ = format;
+  frame->timestamp_ = 0;
+
+  std::shared_ptr<State> state = state_;
+  return std::shared_ptr<VideoFrame>(
+      frame, [state](VideoFrame* released) { Release(state, released); });
+}
+
+void FramePool::Release(const std::shared_ptr<State>& state,
+                        VideoFrame* frame) {
+  std::unique_ptr<uint8_t[]> buffer(frame->data_);
+  size_t size = frame->size_;
+  delete frame;
+
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->leased--;
+  // Keep at most |depth| buffers around, a size change drops the old ones
+  // once they come back
+  if (state->free_buffers.size() + state->leased <
+      static_cast<size_t>(state->depth)) {
+    state->free_buffers.push_back(std::move(buffer));
+    state->free_sizes.push_back(size);
+  }
+}
+
+void FramePool::SetDepth(int depth) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->depth = depth > 0 ? depth : 1;
+  while (!state_->free_buffers.empty() &&
+         state_->free_buffers.size() + state_->leased >
+             static_cast<size_t>(state_->depth)) {
+    state_->free_buffers.erase(state_->free_buffers.begin());
+    state_->free_sizes.erase(state_->free_sizes.begin());
+  }
+}
+
+int FramePool::GetDepth() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->depth;
+}
+
+int FramePool::GetLeasedCount() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->leased;
+}
+
+}  // namespace gpupixel
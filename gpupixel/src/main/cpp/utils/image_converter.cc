@@ -0,0 +1,196 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "utils/image_converter.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "libyuv/convert_argb.h"
+#include "libyuv/planar_functions.h"
+#include "libyuv/rotate_argb.h"
+#include "utils/thread_pool.h"
+
+namespace gpupixel {
+
+namespace {
+// Smallest band handed to one worker, in pairs of rows
+const int kMinBandRowPairs = 16;
+}  // namespace
+
+bool ImageConverter::RotateRGBA(const uint8_t* src,
+                                int src_stride,
+                                uint8_t* dst,
+                                int dst_stride,
+                                int width,
+                                int height,
+                                int rotation,
+                                bool mirror /* = false*/) {
+  if (!src || !dst || width <= 0 || height <= 0) {
+    return false;
+  }
+
+  if (rotation != 0 && rotation != 90 && rotation != 180 && rotation != 270) {
+    return false;
+  }
+
+  // Channel order does not matter, the ARGB kernels move whole 32-bit
+  // pixels. Mirroring the rotated image equals rotating the vertically
+  // flipped source, which libyuv takes as a negative height.
+  //
+  // Every case works on bands of source rows. For 90/270 this is what keeps
+  // the transpose cache friendly: a whole-frame transpose gathers one column
+  // across every source row and thrashes the cache at 4K, while a band keeps
+  // its rows resident and writes contiguous runs of destination columns.
+  // Source row y lands in destination column y for 270 and transpose (90 +
+  // mirror), and in column height - 1 - y otherwise.
+  const int kBandRows = 32;
+  std::atomic<bool> ok(true);
+  auto rotate_band = [&](int y, int rows) {
+    const uint8_t* band_src = src + (size_t)y * src_stride;
+    int flipped_row = height - y - rows;
+    int result = 0;
+    switch (rotation) {
+      case 0:
+        result = mirror ? libyuv::ARGBMirror(band_src, src_stride,
+                                             dst + (size_t)y * dst_stride,
+                                             dst_stride, width, rows)
+                        : libyuv::ARGBCopy(band_src, src_stride,
+                                           dst + (size_t)y * dst_stride,
+                                           dst_stride, width, rows);
+        break;
+      case 180:
+        result =
+            mirror ? libyuv::ARGBCopy(band_src, src_stride,
+                                      dst + (size_t)flipped_row * dst_stride,
+                                      dst_stride, width, -rows)
+                   : libyuv::ARGBRotate(band_src, src_stride,
+                                        dst + (size_t)flipped_row * dst_stride,
+                                        dst_stride, width, rows,
+                                        libyuv::kRotate180);
+        break;
+      default: {
+        bool reversed = (rotation == 90) != mirror;
+        int dst_column = reversed ? flipped_row : y;
+        result = libyuv::ARGBRotate(
+            band_src, src_stride, dst + dst_column * 4, dst_stride, width,
+            mirror ? -rows : rows,
+            rotation == 90 ? libyuv::kRotate90 : libyuv::kRotate270);
+        break;
+      }
+    }
+    if (result != 0) {
+      ok = false;
+    }
+  };
+
+  ThreadPool::GetInstance()->ParallelFor(
+      height, kBandRows, [&](int begin, int end) {
+        for (int y = begin; y < end; y += kBandRows) {
+          rotate_band(y, std::min(kBandRows, end - y));
+        }
+      });
+  return ok;
+}
+
+bool ImageConverter::Android420ToRGBA(const uint8_t* src_y,
+                                      int y_row_stride,
+                                      int y_pixel_stride,
+                                      const uint8_t* src_u,
+                                      int u_row_stride,
+                                      const uint8_t* src_v,
+                                      int v_row_stride,
+                                      int uv_pixel_stride,
+                                      uint8_t* dst,
+                                      int dst_stride,
+                                      int width,
+                                      int height) {
+  if (!src_y || !src_u || !src_v || !dst || width <= 0 || height <= 0) {
+    return false;
+  }
+
+  // libyuv reads I420 and interleaved NV12/NV21 chroma in place. RGBA bytes
+  // are "ABGR" in libyuv's word-order naming.
+  ptrdiff_t vu_offset = src_v - src_u;
+  bool direct = uv_pixel_stride == 1 ||
+                (uv_pixel_stride == 2 && (vu_offset == 1 || vu_offset == -1) &&
+                 u_row_stride == v_row_stride);
+  if (y_pixel_stride == 1 && direct) {
+    // Bands of row pairs, each starting on a chroma row
+    std::atomic<bool> ok(true);
+    ThreadPool::GetInstance()->ParallelFor(
+        (height + 1) / 2, kMinBandRowPairs, [&](int begin, int end) {
+          int y = begin * 2;
+          int rows = std::min(end * 2, height) - y;
+          if (libyuv::Android420ToABGR(
+                  src_y + (size_t)y * y_row_stride, y_row_stride,
+                  src_u + (size_t)begin * u_row_stride, u_row_stride,
+                  src_v + (size_t)begin * v_row_stride, v_row_stride,
+                  uv_pixel_stride, dst + (size_t)y * dst_stride, dst_stride,
+                  width, rows) != 0) {
+            ok = false;
+          }
+        });
+    return ok;
+  }
+
+  // Rare layouts: repack into NV12 (and a tight luma plane if needed)
+  // instead of letting libyuv allocate per frame
+  int half_width = (width + 1) / 2;
+  int half_height = (height + 1) / 2;
+  size_t uv_size = (size_t)half_width * 2 * half_height;
+  size_t y_size = y_pixel_stride == 1 ? 0 : (size_t)width * height;
+  uint8_t* scratch = ScratchBuffer(uv_size + y_size);
+
+  uint8_t* uv = scratch;
+  for (int y = 0; y < half_height; y++) {
+    const uint8_t* u_row = src_u + (size_t)y * u_row_stride;
+    const uint8_t* v_row = src_v + (size_t)y * v_row_stride;
+    uint8_t* uv_row = uv + (size_t)y * half_width * 2;
+    for (int x = 0; x < half_width; x++) {
+      uv_row[x * 2] = u_row[x * uv_pixel_stride];
+      uv_row[x * 2 + 1] = v_row[x * uv_pixel_stride];
+    }
+  }
+
+  const uint8_t* luma = src_y;
+  int luma_stride = y_row_stride;
+  if (y_pixel_stride != 1) {
+    uint8_t* packed = scratch + uv_size;
+    for (int y = 0; y < height; y++) {
+      const uint8_t* row = src_y + (size_t)y * y_row_stride;
+      for (int x = 0; x < width; x++) {
+        packed[(size_t)y * width + x] = row[x * y_pixel_stride];
+      }
+    }
+    luma = packed;
+    luma_stride = width;
+  }
+
+  std::atomic<bool> ok(true);
+  ThreadPool::GetInstance()->ParallelFor(
+      half_height, kMinBandRowPairs, [&](int begin, int end) {
+        int y = begin * 2;
+        int rows = std::min(end * 2, height) - y;
+        if (libyuv::NV12ToABGR(luma + (size_t)y * luma_stride, luma_stride,
+                               uv + (size_t)begin * half_width * 2,
+                               half_width * 2, dst + (size_t)y * dst_stride,
+                               dst_stride, width, rows) != 0) {
+          ok = false;
+        }
+      });
+  return ok;
+}
+
+uint8_t* ImageConverter::ScratchBuffer(size_t size) {
+  // One buffer per calling thread, conversions may run concurrently
+  static thread_local std::vector<uint8_t> scratch;
+  if (scratch.size() < size) {
+    scratch.resize(size);
+  }
+  return scratch.data();
+}
+
+}  // namespace gpupixel
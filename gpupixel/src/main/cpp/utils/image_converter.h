@@ -0,0 +1,52 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gpupixel {
+
+// CPU pixel kernels backed by libyuv's SIMD rows (NEON on arm, SSE/AVX on
+// x86). All strides are in bytes.
+class ImageConverter {
+ public:
+  // Rotates a packed 32-bit image clockwise by |rotation| degrees (0, 90,
+  // 180, 270) and, if |mirror| is set, flips the rotated result horizontally,
+  // in a single pass. For 90/270 the destination is height x width.
+  static bool RotateRGBA(const uint8_t* src,
+                         int src_stride,
+                         uint8_t* dst,
+                         int dst_stride,
+                         int width,
+                         int height,
+                         int rotation,
+                         bool mirror = false);
+
+  // Converts Android YUV_420_888 planes (BT.601, limited range) to RGBA
+  // bytes. I420, NV12 and NV21 layouts are converted straight from the
+  // strided planes; any other pixel stride is first repacked into a
+  // per-thread scratch buffer that is reused across frames.
+  static bool Android420ToRGBA(const uint8_t* src_y,
+                               int y_row_stride,
+                               int y_pixel_stride,
+                               const uint8_t* src_u,
+                               int u_row_stride,
+                               const uint8_t* src_v,
+                               int v_row_stride,
+                               int uv_pixel_stride,
+                               uint8_t* dst,
+                               int dst_stride,
+                               int width,
+                               int height);
+
+ private:
+  // Grows to the largest request and is never shrunk
+  static uint8_t* ScratchBuffer(size_t size);
+};
+
+}  // namespace gpupixel
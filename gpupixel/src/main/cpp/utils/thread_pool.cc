@@ -0,0 +1,205 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#include "utils/thread_pool.h"
+#include <algorithm>
+#include <cstdio>
+#include "gpupixel/gpupixel_define.h"
+#include "utils/logging.h"
+
+#if defined(GPUPIXEL_ANDROID) || defined(GPUPIXEL_LINUX)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace gpupixel {
+
+namespace {
+// Set on pool workers and on a caller while it runs bands
+thread_local bool in_parallel_for = false;
+
+int DefaultThreadCount() {
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(1, std::min(cores, 4));
+}
+}  // namespace
+
+ThreadPool* ThreadPool::GetInstance() {
+  static ThreadPool instance;
+  return &instance;
+}
+
+ThreadPool::ThreadPool() {
+  thread_count_ = DefaultThreadCount();
+  StartWorkers();
+}
+
+ThreadPool::~ThreadPool() {
+  StopWorkers();
+}
+
+void ThreadPool::Configure(int thread_count,
+                           CoreAffinity affinity /* = ANY_CORES*/) {
+  std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+  StopWorkers();
+  thread_count_ = thread_count > 0 ? thread_count : DefaultThreadCount();
+  affinity_ = affinity;
+  StartWorkers();
+  LOG_INFO("ThreadPool: thread count and affinity: {}", thread_count_.load(),
+           static_cast<int>(affinity_));
+}
+
+int ThreadPool::GetThreadCount() {
+  return thread_count_;
+}
+
+void ThreadPool::StartWorkers() {
+  stopping_ = false;
+  // The submitting thread takes part, so one thread fewer is needed
+  for (int i = 1; i < thread_count_; i++) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+void ThreadPool::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+void ThreadPool::WorkerLoop() {
+  in_parallel_for = true;
+  ApplyAffinity(affinity_);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  uint64_t seen = generation_;
+  while (true) {
+    work_cv_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+    if (stopping_) {
+      return;
+    }
+    seen = generation_;
+    Job* job = job_;
+    if (!job) {
+      continue;
+    }
+    busy_workers_++;
+    lock.unlock();
+    RunBands(job);
+    lock.lock();
+    if (--busy_workers_ == 0) {
+      done_cv_.notify_all();
+    }
+  }
+}
+
+void ThreadPool::RunBands(Job* job) {
+  while (true) {
+    int band = job->next_band.fetch_add(1);
+    if (band >= job->band_count) {
+      return;
+    }
+    int begin = band * job->band;
+    int end = std::min(begin + job->band, job->count);
+    (*job->fn)(begin, end);
+  }
+}
+
+void ThreadPool::ParallelFor(int count,
+                             int min_band,
+                             const std::function<void(int, int)>& fn) {
+  if (count <= 0) {
+    return;
+  }
+  min_band = std::max(min_band, 1);
+
+  std::unique_lock<std::mutex> submit_lock(submit_mutex_, std::try_to_lock);
+  if (in_parallel_for || !submit_lock.owns_lock() || workers_.empty() ||
+      count <= min_band) {
+    fn(0, count);
+    return;
+  }
+
+  // A few bands per thread balance big and little cores
+  int target_bands = thread_count_ * 4;
+  Job job;
+  job.fn = &fn;
+  job.count = count;
+  job.band = std::max(min_band, (count + target_bands - 1) / target_bands);
+  job.band_count = (count + job.band - 1) / job.band;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &job;
+    generation_++;
+  }
+  work_cv_.notify_all();
+
+  in_parallel_for = true;
+  RunBands(&job);
+  in_parallel_for = false;
+
+  // Workers that picked up the job may still be inside a band
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [&] { return busy_workers_ == 0; });
+  job_ = nullptr;
+}
+
+void ThreadPool::ApplyAffinity(CoreAffinity affinity) {
+#if defined(GPUPIXEL_ANDROID) || defined(GPUPIXEL_LINUX)
+  if (affinity == ANY_CORES) {
+    return;
+  }
+
+  // Clusters are told apart by their maximum frequency
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  std::vector<long> max_freq(cores, 0);
+  long highest = 0;
+  long lowest = 0;
+  for (int cpu = 0; cpu < cores; cpu++) {
+    char path[96];
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+    FILE* file = fopen(path, "r");
+    if (!file) {
+      continue;
+    }
+    if (fscanf(file, "%ld", &max_freq[cpu]) != 1) {
+      max_freq[cpu] = 0;
+    }
+    fclose(file);
+    if (max_freq[cpu] > 0) {
+      highest = std::max(highest, max_freq[cpu]);
+      lowest = lowest == 0 ? max_freq[cpu] : std::min(lowest, max_freq[cpu]);
+    }
+  }
+  if (highest == 0 || highest == lowest) {
+    return;  // unknown or symmetric topology
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  long wanted = affinity == BIG_CORES ? highest : lowest;
+  for (int cpu = 0; cpu < cores; cpu++) {
+    if (max_freq[cpu] == wanted) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+  if (sched_setaffinity(tid, sizeof(set), &set) != 0) {
+    LOG_WARN("ThreadPool: failed to set thread affinity");
+  }
+#endif
+}
+
+}  // namespace gpupixel
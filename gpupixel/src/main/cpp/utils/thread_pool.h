@@ -0,0 +1,72 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gpupixel {
+
+// Library-owned worker pool for CPU pixel kernels. ParallelFor splits a row
+// range into more bands than threads; workers and the calling thread claim
+// bands from a shared counter, so faster cores take over the remaining work
+// of slower ones.
+class ThreadPool {
+ public:
+  enum CoreAffinity { ANY_CORES = 0, BIG_CORES, LITTLE_CORES };
+
+  static ThreadPool* GetInstance();
+
+  // |thread_count| includes the calling thread, 0 picks min(cores, 4).
+  // Workers are pinned to the selected cluster when the platform allows it.
+  void Configure(int thread_count, CoreAffinity affinity = ANY_CORES);
+  int GetThreadCount();
+
+  // Runs |fn(begin, end)| over [0, count) in bands of at least |min_band|
+  // items and returns once all bands are done. Calls nested inside a band,
+  // or made while another thread owns the pool, run inline.
+  void ParallelFor(int count,
+                   int min_band,
+                   const std::function<void(int begin, int end)>& fn);
+
+ private:
+  struct Job {
+    const std::function<void(int, int)>* fn = nullptr;
+    int count = 0;
+    int band = 0;
+    int band_count = 0;
+    std::atomic<int> next_band{0};
+  };
+
+  ThreadPool();
+  ~ThreadPool();
+
+  void StartWorkers();
+  void StopWorkers();
+  void WorkerLoop();
+  static void RunBands(Job* job);
+  static void ApplyAffinity(CoreAffinity affinity);
+
+  std::mutex submit_mutex_;
+  std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::vector<std::thread> workers_;
+  bool stopping_ = false;
+  uint64_t generation_ = 0;
+  Job* job_ = nullptr;
+  int busy_workers_ = 0;
+
+  std::atomic<int> thread_count_{0};
+  CoreAffinity affinity_ = ANY_CORES;
+};
+
+}  // namespace gpupixel
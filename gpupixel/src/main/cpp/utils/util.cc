@@ -155,6 +155,13 @@ int64_t Util::NowTimeMs() {
   return ts;
 }
 
+int64_t Util::NowTimeUs() {
+  auto time_now = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             time_now.time_since_epoch())
+      .count();
+}
+
 bool Util::IsAppleAppActive() {
 #if defined(GPUPIXEL_IOS)
   return [GPXObjcHelper isAppActive];
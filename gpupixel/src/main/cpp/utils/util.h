@@ -22,6 +22,8 @@ class GPUPIXEL_API Util {
  public:
   static std::string StringFormat(const char* fmt, ...);
   static int64_t NowTimeMs();
+  // Monotonic clock, for measuring durations
+  static int64_t NowTimeUs();
 
   static void SetResourcePath(const fs::path& path);
   static fs::path GetResourcePath();
@@ -7,6 +7,10 @@
 
 package com.pixpark.gpupixel;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+
 /**
  * Face detector class for detecting facial landmarks in images
  */
@@ -21,6 +25,35 @@ public class FaceDetector {
     public static final int GPUPIXEL_FRAME_TYPE_YUVI420 = 0;
     public static final int GPUPIXEL_FRAME_TYPE_RGBA = 1;
     public static final int GPUPIXEL_FRAME_TYPE_BGRA = 2;
+    public static final int GPUPIXEL_FRAME_TYPE_NV12 = 3;
+    public static final int GPUPIXEL_FRAME_TYPE_NV21 = 4;
+    public static final int GPUPIXEL_FRAME_TYPE_GRAY = 5;
+
+    /**
+     * A detected face, coordinates are normalized to the upright frame
+     */
+    public static class Face {
+        public final int faceId;
+        public final float score;
+        // left, top, right, bottom
+        public final float[] rect;
+        public final float pitch;
+        public final float yaw;
+        public final float roll;
+        // 111 x,y pairs
+        public final float[] landmarks;
+
+        Face(int faceId, float score, float[] rect, float pitch, float yaw, float roll,
+                float[] landmarks) {
+            this.faceId = faceId;
+            this.score = score;
+            this.rect = rect;
+            this.pitch = pitch;
+            this.yaw = yaw;
+            this.roll = roll;
+            this.landmarks = landmarks;
+        }
+    }
 
     /**
      * Create a face detector instance
@@ -49,11 +82,175 @@ public class FaceDetector {
      */
     public float[] detect(final byte[] data, final int width, final int height, final int stide,
             final int format, final int frameType) {
+        return detect(data, width, height, stide, format, frameType, 0);
+    }
+
+    /**
+     * Detect facial landmarks on a frame that is not upright yet. YUV and GRAY frames are
+     * detected on their luma plane, so no RGBA conversion is needed.
+     * @param stride Row pitch of the first plane in bytes
+     * @param frameType Any of the GPUPIXEL_FRAME_TYPE constants
+     * @param rotation Clockwise rotation in degrees (0, 90, 180, 270) that makes the frame
+     *         upright
+     * @return Normalized landmark coordinates of the upright frame
+     */
+    public float[] detect(final byte[] data, final int width, final int height, final int stride,
+            final int format, final int frameType, final int rotation) {
         if (mNativeClassID == 0) {
             return new float[0];
         }
         return nativeFaceDetectorDetect(
-                mNativeClassID, data, width, height, stide, format, frameType);
+                mNativeClassID, data, width, height, stride, format, frameType, rotation);
+    }
+
+    /**
+     * Detect faces with their ids, boxes, scores and head poses
+     * @return Up to the maximum number of faces set with setMaxFaces
+     */
+    public Face[] detectFaces(final byte[] data, final int width, final int height,
+            final int stride, final int format, final int frameType, final int rotation) {
+        if (mNativeClassID == 0) {
+            return new Face[0];
+        }
+        return nativeFaceDetectorDetectFaces(
+                mNativeClassID, data, width, height, stride, format, frameType, rotation);
+    }
+
+    /**
+     * Set how many faces are returned per frame. Landmark arrays hold 111 x,y pairs per face,
+     * face after face, and can be passed to the reshape and makeup filters as they are.
+     * @param count Maximum number of faces, 1 by default
+     */
+    public void setMaxFaces(final int count) {
+        if (mNativeClassID != 0) {
+            nativeFaceDetectorSetMaxFaces(mNativeClassID, count);
+        }
+    }
+
+    /**
+     * Downscale frames whose longer side exceeds the given size before detection
+     * @param size Longer side of the detection image, 0 detects at full resolution
+     */
+    public void setDetectSize(final int size) {
+        if (mNativeClassID != 0) {
+            nativeFaceDetectorSetDetectSize(mNativeClassID, size);
+        }
+    }
+
+    /**
+     * Queue a frame for detection on a background thread and return immediately. A frame
+     * still waiting to be processed is replaced, so the newest frame is always detected next.
+     * @param data Image data, copied before returning
+     * @param timestamp Frame time, attached to the result of this frame
+     */
+    public void detectAsync(final byte[] data, final int width, final int height,
+            final int stride, final int format, final int frameType, final int rotation,
+            final long timestamp) {
+        if (mNativeClassID != 0) {
+            nativeFaceDetectorDetectAsync(mNativeClassID, data, width, height, stride, format,
+                    frameType, rotation, timestamp);
+        }
+    }
+
+    /**
+     * Queue a frame held in a direct buffer, such as the Y plane of a camera image passed
+     * with GPUPIXEL_FRAME_TYPE_GRAY
+     */
+    public void detectAsync(final ByteBuffer data, final int width, final int height,
+            final int stride, final int format, final int frameType, final int rotation,
+            final long timestamp) {
+        if (mNativeClassID != 0 && data.isDirect()) {
+            nativeFaceDetectorDetectAsyncBuffer(mNativeClassID, data, width, height, stride,
+                    format, frameType, rotation, timestamp);
+        }
+    }
+
+    /**
+     * Newest asynchronous landmarks, moved to the given frame time along the motion between
+     * the last two results
+     * @param timestamp Time of the frame about to be rendered, in the units given to
+     *         detectAsync
+     * @return Array of facial landmark coordinates, empty if no face was found
+     */
+    public float[] getLandmarksAt(final long timestamp) {
+        if (mNativeClassID == 0) {
+            return new float[0];
+        }
+        return nativeFaceDetectorGetLandmarksAt(mNativeClassID, timestamp);
+    }
+
+    /**
+     * Like getLandmarksAt, but copies into a caller-owned direct buffer so nothing is
+     * allocated per frame. The floats are written from out.position(), at most
+     * out.remaining() of them, and the position is left unchanged.
+     * @param out Direct FloatBuffer in native byte order, e.g.
+     *         ByteBuffer.allocateDirect(n * 4).order(ByteOrder.nativeOrder()).asFloatBuffer(),
+     *         222 floats per face
+     * @return Number of faces written, 0 for a heap or non-native-order buffer
+     */
+    public int getLandmarksAt(final long timestamp, final FloatBuffer out) {
+        if (mNativeClassID == 0 || !out.isDirect() || out.order() != ByteOrder.nativeOrder()) {
+            return 0;
+        }
+        return nativeFaceDetectorGetLandmarksInto(
+                mNativeClassID, timestamp, out, out.position(), out.remaining());
+    }
+
+    /**
+     * Hand the newest asynchronous landmarks, moved to the given frame time, to face reshape
+     * and makeup filters. The result is shared natively without going through Java.
+     */
+    public void applyLandmarksAt(final long timestamp, final GPUPixelFilter... filters) {
+        if (mNativeClassID == 0) {
+            return;
+        }
+        long[] filterIds = new long[filters.length];
+        for (int i = 0; i < filters.length; i++) {
+            filterIds[i] = filters[i] != null ? filters[i].mNativeClassID : 0;
+        }
+        nativeFaceDetectorApplyLandmarksAt(mNativeClassID, timestamp, filterIds);
+    }
+
+    /**
+     * Timestamp of the frame the newest asynchronous result was detected on
+     * @return The timestamp, or -1 if no result is available yet
+     */
+    public long getLatestTimestamp() {
+        if (mNativeClassID == 0) {
+            return -1;
+        }
+        return nativeFaceDetectorGetLatestTimestamp(mNativeClassID);
+    }
+
+    /**
+     * Set how often the whole frame is searched in GPUPIXEL_MODE_FMT_VIDEO. Frames in
+     * between only search around the last face and fall back to a full search when it
+     * is lost.
+     * @param interval Frames per full search, 1 searches every frame
+     */
+    public void setDetectInterval(final int interval) {
+        if (mNativeClassID != 0) {
+            nativeFaceDetectorSetDetectInterval(mNativeClassID, interval);
+        }
+    }
+
+    /**
+     * Set the face score below which tracking falls back to a full search
+     * @param score Minimum score of a tracked face
+     */
+    public void setTrackingThreshold(final float score) {
+        if (mNativeClassID != 0) {
+            nativeFaceDetectorSetTrackingThreshold(mNativeClassID, score);
+        }
+    }
+
+    /**
+     * Forget the tracked face so the next frame is searched in full
+     */
+    public void resetTracking() {
+        if (mNativeClassID != 0) {
+            nativeFaceDetectorResetTracking(mNativeClassID);
+        }
     }
 
     /**
@@ -82,5 +279,24 @@ public class FaceDetector {
     private static native long nativeFaceDetectorCreate();
     private static native void nativeFaceDetectorDestroy(long classId);
     private static native float[] nativeFaceDetectorDetect(long classId, byte[] data, int width,
-            int height, int stride, int format, int frameType);
+            int height, int stride, int format, int frameType, int rotation);
+    private static native void nativeFaceDetectorSetDetectSize(long classId, int size);
+    private static native Face[] nativeFaceDetectorDetectFaces(long classId, byte[] data,
+            int width, int height, int stride, int format, int frameType, int rotation);
+    private static native void nativeFaceDetectorSetMaxFaces(long classId, int count);
+    private static native void nativeFaceDetectorSetDetectInterval(long classId, int interval);
+    private static native void nativeFaceDetectorSetTrackingThreshold(long classId, float score);
+    private static native void nativeFaceDetectorResetTracking(long classId);
+    private static native void nativeFaceDetectorDetectAsync(long classId, byte[] data,
+            int width, int height, int stride, int format, int frameType, int rotation,
+            long timestamp);
+    private static native void nativeFaceDetectorDetectAsyncBuffer(long classId,
+            ByteBuffer data, int width, int height, int stride, int format, int frameType,
+            int rotation, long timestamp);
+    private static native float[] nativeFaceDetectorGetLandmarksAt(long classId, long timestamp);
+    private static native long nativeFaceDetectorGetLatestTimestamp(long classId);
+    private static native int nativeFaceDetectorGetLandmarksInto(
+            long classId, long timestamp, FloatBuffer out, int position, int remaining);
+    private static native void nativeFaceDetectorApplyLandmarksAt(
+            long classId, long timestamp, long[] filterIds);
 }
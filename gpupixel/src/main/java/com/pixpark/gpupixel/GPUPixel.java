@@ -141,6 +141,22 @@ public class GPUPixel {
         }
     }
 
+    // Core selection for SetCpuThreads
+    public static final int CPU_AFFINITY_ANY = 0;
+    public static final int CPU_AFFINITY_BIG = 1;
+    public static final int CPU_AFFINITY_LITTLE = 2;
+
+    /**
+     * Configures the worker pool used for CPU pixel work such as YUV
+     * conversion and rotation
+     *
+     * @param threadCount Threads including the caller, 0 picks min(cores, 4)
+     * @param affinity CPU_AFFINITY_ANY, CPU_AFFINITY_BIG or CPU_AFFINITY_LITTLE
+     */
+    public static void SetCpuThreads(int threadCount, int affinity) {
+        nativeSetCpuThreads(threadCount, affinity);
+    }
+
     /**
      * Converts YUV_420_888 format image to RGBA format
      *
@@ -148,6 +164,17 @@ public class GPUPixel {
      * @return RGBA format byte array
      */
     public static byte[] YUV_420_888toRGBA(Image image) {
+        return YUV_420_888toRGBA(image, null);
+    }
+
+    /**
+     * Converts YUV_420_888 format image to RGBA format, reusing the output array
+     *
+     * @param image YUV_420_888 format image
+     * @param rgbaOut Array from a previous call, reallocated only if the size changed
+     * @return RGBA format byte array
+     */
+    public static byte[] YUV_420_888toRGBA(Image image, byte[] rgbaOut) {
         if (image == null) return null;
 
         int width = image.getWidth();
@@ -166,7 +193,10 @@ public class GPUPixel {
         int uPixelStride = planes[1].getPixelStride();
         int vPixelStride = planes[2].getPixelStride();
 
-        byte[] rgba = new byte[width * height * 4];
+        byte[] rgba = rgbaOut;
+        if (rgba == null || rgba.length != width * height * 4) {
+            rgba = new byte[width * height * 4];
+        }
 
         nativeYUV420ToRGBA(yBuffer, uBuffer, vBuffer, width, height, yRowStride, uRowStride,
                 vRowStride, yPixelStride, uPixelStride, vPixelStride, rgba);
@@ -184,12 +214,28 @@ public class GPUPixel {
      * @return Rotated RGBA image data
      */
     public static byte[] rotateRgbaImage(byte[] rgba, int width, int height, int rotation) {
+        return rotateRgbaImage(rgba, width, height, rotation, false);
+    }
+
+    /**
+     * Rotates RGBA format image and optionally mirrors the result, in one pass
+     *
+     * @param rgba Original RGBA format image data
+     * @param width Image width
+     * @param height Image height
+     * @param rotation Clockwise rotation angle (0, 90, 180, 270)
+     * @param mirror Flip the rotated image horizontally
+     * @return Rotated RGBA image data
+     */
+    public static byte[] rotateRgbaImage(
+            byte[] rgba, int width, int height, int rotation, boolean mirror) {
         if (rgba == null || rgba.length != width * height * 4) {
             Log.e(TAG, "Invalid RGBA data or dimensions mismatch");
             return rgba;
         }
 
-        if (rotation == 0 || rotation == 360) {
+        rotation = rotation % 360;
+        if (rotation == 0 && !mirror) {
             return rgba;
         }
 
@@ -198,7 +244,7 @@ public class GPUPixel {
 
         byte[] rotatedData = new byte[outWidth * outHeight * 4];
 
-        nativeRotateRGBA(rgba, width, height, rotatedData, outWidth, outHeight, rotation);
+        nativeRotateRGBA(rgba, width, height, rotatedData, outWidth, outHeight, rotation, mirror);
 
         return rotatedData;
     }
@@ -256,7 +302,9 @@ public class GPUPixel {
             int vRowStride, int yPixelStride, int uPixelStride, int vPixelStride, byte[] rgbaOut);
 
     private static native void nativeRotateRGBA(byte[] rgbaIn, int width, int height,
-            byte[] rgbaOut, int outWidth, int outHeight, int rotationDegrees);
+            byte[] rgbaOut, int outWidth, int outHeight, int rotationDegrees, boolean mirror);
 
     private static native void nativeSetResourcePath(String path);
+
+    private static native void nativeSetCpuThreads(int threadCount, int affinity);
 }
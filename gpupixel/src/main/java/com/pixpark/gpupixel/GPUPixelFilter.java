@@ -14,6 +14,7 @@ public class GPUPixelFilter extends GPUPixelSource implements GPUPixelSink {
     public static final String FACE_RESHAPE_FILTER = "FaceReshapeFilter";
     public static final String LIPSTICK_FILTER = "LipstickFilter";
     public static final String BLUSHER_FILTER = "BlusherFilter";
+    public static final String FACE_MAKEUP_LAYERS_FILTER = "FaceMakeupLayersFilter";
     public static final String FACE_MAKEUP_FILTER = "FaceMakeupFilter";
 
     // Basic adjustment filters
@@ -6,9 +6,36 @@
 
 package com.pixpark.gpupixel;
 
+import java.nio.ByteBuffer;
+
 public class GPUPixelSinkRawData implements GPUPixelSink {
     protected long mNativeClassID = 0;
 
+    // Output pixel formats, same values as GPUPixelSourceRawData frame types
+    public static final int FRAME_TYPE_RGBA = 1;
+    public static final int FRAME_TYPE_BGRA = 2;
+
+    // YUV layouts for GetYuvBuffer
+    public static final int YUV_FORMAT_I420 = 0;
+    public static final int YUV_FORMAT_NV12 = 1;
+    public static final int YUV_FORMAT_NV21 = 2;
+
+    // YUV conversion matrices
+    public static final int YUV_MATRIX_BT601 = 0;
+    public static final int YUV_MATRIX_BT709 = 1;
+
+    // YUV output ranges
+    public static final int YUV_RANGE_LIMITED = 0;
+    public static final int YUV_RANGE_FULL = 1;
+
+    /**
+     * Receives asynchronously read back RGBA frames on the GL thread.
+     * The buffer is only valid until onFrame returns, copy it if needed.
+     */
+    public interface RgbaFrameCallback {
+        void onFrame(ByteBuffer rgba, int width, int height, long timestampUs);
+    }
+
     protected GPUPixelSinkRawData() {
         if (mNativeClassID != 0) return;
         mNativeClassID = nativeCreate();
@@ -42,6 +69,125 @@ public class GPUPixelSinkRawData implements GPUPixelSink {
         return nativeGetI420Buffer(mNativeClassID);
     }
 
+    /**
+     * Scale the output on the GPU before readback. Several sinks attached to
+     * the same filter can each use a different size.
+     * @param width Output width, 0 keeps the cropped input width
+     * @param height Output height, 0 keeps the cropped input height
+     */
+    public void SetOutputSize(int width, int height) {
+        nativeSetOutputSize(mNativeClassID, width, height);
+    }
+
+    /**
+     * Crop the input before scaling, in normalized coordinates
+     */
+    public void SetCropRect(float x, float y, float width, float height) {
+        nativeSetCropRect(mNativeClassID, x, y, width, height);
+    }
+
+    /**
+     * Select the RGB readback byte order
+     * @param format FRAME_TYPE_RGBA or FRAME_TYPE_BGRA
+     */
+    public void SetOutputFormat(int format) {
+        nativeSetOutputFormat(mNativeClassID, format);
+    }
+
+    /**
+     * Get the frame converted on the GPU in the layout chosen by SetYuvFormat
+     * @return width * height * 3 / 2 bytes
+     */
+    public byte[] GetYuvBuffer() {
+        return nativeGetYuvBuffer(mNativeClassID);
+    }
+
+    /**
+     * Select the layout, matrix and range used by GetYuvBuffer
+     * @param format YUV_FORMAT_I420, YUV_FORMAT_NV12 or YUV_FORMAT_NV21
+     * @param matrix YUV_MATRIX_BT601 or YUV_MATRIX_BT709
+     * @param range YUV_RANGE_LIMITED or YUV_RANGE_FULL
+     */
+    public void SetYuvFormat(int format, int matrix, int range) {
+        nativeSetYuvFormat(mNativeClassID, format, matrix, range);
+    }
+
+    /**
+     * Read the current frame into a caller-owned direct ByteBuffer without
+     * any per-frame allocation. Reuse the same buffer across frames.
+     * @param buffer Direct buffer of at least rowStride * (height - 1) + width * 4 bytes
+     * @param rowStride Row pitch in bytes, 0 for tightly packed rows
+     * @return false if no frame is available or the buffer is too small
+     */
+    public boolean ReadRgbaInto(ByteBuffer buffer, int rowStride) {
+        return nativeReadRgbaInto(mNativeClassID, buffer, rowStride);
+    }
+
+    /**
+     * Read the current frame as YUV, in the layout chosen by SetYuvFormat,
+     * into a caller-owned direct ByteBuffer.
+     * @param buffer Direct buffer of at least rowStride * height * 3 / 2 bytes
+     * @param rowStride Luma row pitch in bytes, 0 for tightly packed rows
+     * @return false if no frame is available or the buffer is too small
+     */
+    public boolean ReadYuvInto(ByteBuffer buffer, int rowStride) {
+        return nativeReadYuvInto(mNativeClassID, buffer, rowStride);
+    }
+
+    /**
+     * Lease the current frame as RGBA from the sink's frame pool. The frame
+     * is not overwritten by later renders and may be passed to other threads;
+     * call Release on it (and on any retained copies) when done.
+     * @return The frame, or null if nothing was rendered or the pool is exhausted
+     */
+    public GPUPixelVideoFrame AcquireRgbaFrame() {
+        long frame = nativeAcquireRgbaFrame(mNativeClassID);
+        return frame != 0 ? new GPUPixelVideoFrame(frame) : null;
+    }
+
+    /**
+     * Lease the current frame as YUV, in the layout chosen by SetYuvFormat
+     */
+    public GPUPixelVideoFrame AcquireYuvFrame() {
+        long frame = nativeAcquireYuvFrame(mNativeClassID);
+        return frame != 0 ? new GPUPixelVideoFrame(frame) : null;
+    }
+
+    // Maximum number of frames leased at once
+    public void SetFramePoolDepth(int depth) {
+        nativeSetFramePoolDepth(mNativeClassID, depth);
+    }
+
+    /**
+     * Read rendered frames back through a ring of pixel buffers instead of
+     * stalling the pipeline. Frames arrive a few frames late, tagged with the
+     * timestamp passed to the source.
+     * @param callback Frame receiver
+     * @param ringSize Number of frames that may be in flight
+     */
+    public void EnableAsyncReadback(RgbaFrameCallback callback, int ringSize) {
+        nativeEnableAsyncReadback(mNativeClassID, callback, ringSize);
+    }
+
+    public void EnableAsyncReadback(RgbaFrameCallback callback) {
+        EnableAsyncReadback(callback, 3);
+    }
+
+    // Disable asynchronous readback, pending frames are delivered first
+    public void DisableAsyncReadback() {
+        nativeDisableAsyncReadback(mNativeClassID);
+    }
+
+    // Deliver completed readbacks without waiting
+    public void PollAsyncReadback() {
+        nativePollAsyncReadback(mNativeClassID);
+    }
+
+    // Wait for and deliver all pending readbacks
+    public void FlushAsyncReadback() {
+        nativeFlushAsyncReadback(mNativeClassID);
+    }
+
     public void Destroy() {
         if (mNativeClassID != 0) {
             nativeDestroy(mNativeClassID);
@@ -75,4 +221,23 @@ public class GPUPixelSinkRawData implements GPUPixelSink {
     private static native int nativeGetHeight(long nativeObj);
     private static native byte[] nativeGetRgbaBuffer(long nativeObj);
     private static native byte[] nativeGetI420Buffer(long nativeObj);
+    private static native void nativeSetOutputSize(long nativeObj, int width, int height);
+    private static native void nativeSetCropRect(
+            long nativeObj, float x, float y, float width, float height);
+    private static native void nativeSetOutputFormat(long nativeObj, int format);
+    private static native byte[] nativeGetYuvBuffer(long nativeObj);
+    private static native void nativeSetYuvFormat(
+            long nativeObj, int format, int matrix, int range);
+    private static native boolean nativeReadRgbaInto(
+            long nativeObj, ByteBuffer buffer, int rowStride);
+    private static native boolean nativeReadYuvInto(
+            long nativeObj, ByteBuffer buffer, int rowStride);
+    private static native long nativeAcquireRgbaFrame(long nativeObj);
+    private static native long nativeAcquireYuvFrame(long nativeObj);
+    private static native void nativeSetFramePoolDepth(long nativeObj, int depth);
+    private static native void nativeEnableAsyncReadback(
+            long nativeObj, RgbaFrameCallback callback, int ringSize);
+    private static native void nativeDisableAsyncReadback(long nativeObj);
+    private static native void nativePollAsyncReadback(long nativeObj);
+    private static native void nativeFlushAsyncReadback(long nativeObj);
 }
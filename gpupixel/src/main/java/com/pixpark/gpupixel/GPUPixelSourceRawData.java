@@ -32,6 +32,36 @@ public class GPUPixelSourceRawData extends GPUPixelSource {
         nativeProcessData(mNativeClassID, data, width, height, stride, frameType);
     }
 
+    /**
+     * Process a frame and orient it on the GPU during upload
+     * @param rotation Clockwise rotation in degrees (0, 90, 180, 270)
+     * @param mirror Whether to flip the rotated frame horizontally
+     */
+    public void ProcessData(byte[] data, int width, int height, int stride, int frameType,
+            int rotation, boolean mirror) {
+        ProcessData(data, width, height, stride, frameType, rotation, mirror, -1);
+    }
+
+    /**
+     * Process an oriented frame tagged with its capture time
+     * @param timestampUs Timestamp handed to sinks, negative to use the upload time
+     */
+    public void ProcessData(byte[] data, int width, int height, int stride, int frameType,
+            int rotation, boolean mirror, long timestampUs) {
+        nativeProcessDataWithRotation(mNativeClassID, data, width, height, stride, frameType,
+                rotation, mirror, timestampUs);
+    }
+
+    // CPU time spent uploading the last frame, in microseconds
+    public long GetLastUploadTimeUs() {
+        return nativeGetLastUploadTimeUs(mNativeClassID);
+    }
+
+    // Average CPU time spent uploading a frame, in microseconds
+    public long GetAverageUploadTimeUs() {
+        return nativeGetAverageUploadTimeUs(mNativeClassID);
+    }
+
     @Override
     public void Destroy() {
         if (mNativeClassID != 0) {
@@ -59,5 +89,10 @@ public class GPUPixelSourceRawData extends GPUPixelSource {
     private static native void nativeFinalize(long nativeObj);
     private static native void nativeProcessData(
             long nativeObj, byte[] data, int width, int height, int stride, int frameType);
+    private static native void nativeProcessDataWithRotation(long nativeObj, byte[] data,
+            int width, int height, int stride, int frameType, int rotation, boolean mirror,
+            long timestampUs);
     private static native void nativeSetRotation(long nativeObj, int rotation);
+    private static native long nativeGetLastUploadTimeUs(long nativeObj);
+    private static native long nativeGetAverageUploadTimeUs(long nativeObj);
 }
@@ -0,0 +1,99 @@
+/*
+ * GPUPixel
+ *
+
+ */
+
+package com.pixpark.gpupixel;
+
+import java.nio.ByteBuffer;
+
+/**
+ * A frame leased from a GPUPixelSinkRawData frame pool. The pixel memory is
+ * shared, not copied, and goes back to the pool once every reference has been
+ * released.
+ */
+public class GPUPixelVideoFrame {
+    // Pixel formats
+    public static final int FORMAT_RGBA = 0;
+    public static final int FORMAT_BGRA = 1;
+    public static final int FORMAT_I420 = 2;
+    public static final int FORMAT_NV12 = 3;
+    public static final int FORMAT_NV21 = 4;
+
+    protected long mNativeClassID = 0;
+    private ByteBuffer mBuffer;
+
+    GPUPixelVideoFrame(long nativeObj) {
+        mNativeClassID = nativeObj;
+    }
+
+    /**
+     * Pixel data, only valid until Release is called on this reference
+     */
+    public ByteBuffer GetBuffer() {
+        if (mBuffer == null && mNativeClassID != 0) {
+            mBuffer = nativeGetBuffer(mNativeClassID);
+        }
+        return mBuffer;
+    }
+
+    public int GetWidth() {
+        return nativeGetWidth(mNativeClassID);
+    }
+
+    public int GetHeight() {
+        return nativeGetHeight(mNativeClassID);
+    }
+
+    // Row pitch of the first plane in bytes
+    public int GetStride() {
+        return nativeGetStride(mNativeClassID);
+    }
+
+    public int GetFormat() {
+        return nativeGetFormat(mNativeClassID);
+    }
+
+    public long GetTimestampUs() {
+        return nativeGetTimestamp(mNativeClassID);
+    }
+
+    /**
+     * Take another reference for a different consumer, e.g. another thread.
+     * Each reference is released separately.
+     */
+    public synchronized GPUPixelVideoFrame Retain() {
+        long frame = nativeRetain(mNativeClassID);
+        return frame != 0 ? new GPUPixelVideoFrame(frame) : null;
+    }
+
+    public synchronized void Release() {
+        if (mNativeClassID != 0) {
+            mBuffer = null;
+            nativeRelease(mNativeClassID);
+            mNativeClassID = 0;
+        }
+    }
+
+    @Override
+    protected void finalize() throws Throwable {
+        try {
+            Release();
+        } catch (Exception e) {
+            e.printStackTrace();
+        } finally {
+            super.finalize();
+        }
+    }
+
+    // JNI Native methods
+    private static native void nativeRelease(long nativeObj);
+    private static native long nativeRetain(long nativeObj);
+    private static native ByteBuffer nativeGetBuffer(long nativeObj);
+    private static native int nativeGetWidth(long nativeObj);
+    private static native int nativeGetHeight(long nativeObj);
+    private static native int nativeGetStride(long nativeObj);
+    private static native int nativeGetFormat(long nativeObj);
+    private static native long nativeGetTimestamp(long nativeObj);
+}